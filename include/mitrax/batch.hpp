@@ -0,0 +1,347 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__batch__hpp_INCLUDED_
+#define _mitrax__batch__hpp_INCLUDED_
+
+#include "make_matrix.hpp"
+#include "detail/closed_form.hpp"
+#include "detail/jacobi.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+namespace mitrax{
+
+
+	/// \brief Many matrices with equal compile time dimensions in
+	///        structure of arrays layout
+	///
+	/// Element (c, r) of all matrices is stored contiguously, so batched
+	/// operations process one matrix per SIMD lane.
+	template < typename T, col_t C, row_t R >
+	class matrix_batch{
+	public:
+		static_assert(C != 0_C && R != 0_R,
+			"matrix_batch needs compile time dimensions");
+
+		/// \brief Type of the matrix elements
+		using value_type = T;
+
+		/// \brief Count of elements of one matrix
+		static constexpr size_t components = size_t(C) * size_t(R);
+
+
+		/// \brief count matrices with value initialized elements
+		explicit matrix_batch(size_t count = 0):
+			count_(count),
+			values_(count * components) {}
+
+
+		/// \brief Count of matrices
+		size_t size()const noexcept{
+			return count_;
+		}
+
+		static constexpr auto cols()noexcept{
+			return mitrax::cols< C >();
+		}
+
+		static constexpr auto rows()noexcept{
+			return mitrax::rows< R >();
+		}
+
+
+		/// \brief Element (c, r) of all matrices
+		T* component(c_t c, r_t r)noexcept{
+			return values_.data() + index(c, r) * count_;
+		}
+
+		/// \brief Element (c, r) of all matrices
+		T const* component(c_t c, r_t r)const noexcept{
+			return values_.data() + index(c, r) * count_;
+		}
+
+		/// \brief Element k of all matrices in row-major order
+		T* component(size_t k)noexcept{
+			return values_.data() + k * count_;
+		}
+
+		/// \brief Element k of all matrices in row-major order
+		T const* component(size_t k)const noexcept{
+			return values_.data() + k * count_;
+		}
+
+
+		/// \brief Copy of matrix i
+		std_matrix< T, C, R > operator[](size_t i)const{
+			return make_matrix_fn(cols(), rows(), [this, i](c_t c, r_t r){
+				return component(c, r)[i];
+			});
+		}
+
+		/// \brief Overwrite matrix i
+		template < typename M >
+		void set(size_t i, matrix< M, C, R > const& m){
+			for(size_t r = 0; r < size_t(R); ++r){
+				for(size_t c = 0; c < size_t(C); ++c){
+					component(c_t(c), r_t(r))[i] = m(c_t(c), r_t(r));
+				}
+			}
+		}
+
+
+	private:
+		static constexpr size_t index(c_t c, r_t r)noexcept{
+			return size_t(r) * size_t(C) + size_t(c);
+		}
+
+
+		size_t count_;
+		std::vector< T > values_;
+	};
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Count of matrices which are processed together in local
+	///        arrays, at least the SIMD width
+	constexpr size_t batch_lanes = 16;
+
+
+	template < typename M, col_t C, row_t R >
+	matrix_batch< value_type_t< M >, C, R > batch_type(
+		matrix< M, C, R > const&);
+
+
+	template < typename B >
+	auto component_pointers(B& batch){
+		using pointer = decltype(batch.component(size_t(0)));
+		std::array< pointer, B::components > result{};
+		for(size_t k = 0; k < B::components; ++k){
+			result[k] = batch.component(k);
+		}
+		return result;
+	}
+
+
+	/// \brief Element k of an N x N identity matrix for k < N * N, zero
+	///        for the following elements
+	template < typename T, size_t N, size_t NI >
+	constexpr std::array< T, NI > identity_lanes()noexcept{
+		std::array< T, NI > result{};
+		for(size_t k = 0; k < N; ++k) result[k * N + k] = T(1);
+		return result;
+	}
+
+
+	/// \brief Call f(in, out) for blocks of batch_lanes matrices
+	///
+	/// in[k][l] and out[k][l] are element k of matrix l of the block, f
+	/// may overwrite in. The local arrays are free of aliasing, so an
+	/// innermost loop over l in f without branches is vectorised. Element
+	/// k of the lanes behind the last matrix is pad[k].
+	template < typename T, size_t NI, size_t NO, typename F >
+	void for_each_lane_block(
+		size_t count,
+		std::array< T const*, NI > const& in,
+		std::array< T, NI > const& pad,
+		std::array< T*, NO > const& out,
+		F const& f
+	){
+		for(size_t i = 0; i < count; i += batch_lanes){
+			auto const n = std::min(batch_lanes, count - i);
+
+			T a[NI][batch_lanes];
+			T b[NO][batch_lanes];
+			for(size_t k = 0; k < NI; ++k){
+				std::copy(in[k] + i, in[k] + i + n, a[k]);
+				std::fill(a[k] + n, a[k] + batch_lanes, pad[k]);
+			}
+
+			f(a, b);
+
+			for(size_t k = 0; k < NO; ++k){
+				std::copy(b[k], b[k] + n, out[k] + i);
+			}
+		}
+	}
+
+
+	template < typename ... B >
+	void check_batch_sizes(size_t count, B const& ... batches){
+		if(((batches.size() != count) || ...)){
+			throw std::logic_error("matrix_batch: incompatible sizes");
+		}
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Batch of the matrices of a range
+	template < typename Range >
+	auto make_matrix_batch(Range const& range){
+		using batch = decltype(detail::batch_type(*std::begin(range)));
+
+		batch result(size_t(
+			std::distance(std::begin(range), std::end(range))));
+		size_t i = 0;
+		for(auto const& m: range) result.set(i++, m);
+		return result;
+	}
+
+
+	/// \brief Products a[i] * b[i]
+	template < typename T, col_t C, col_t K, row_t R >
+	matrix_batch< T, C, R > operator*(
+		matrix_batch< T, K, R > const& a,
+		matrix_batch< T, C, row_t(K) > const& b
+	){
+		auto const n = a.size();
+		detail::check_batch_sizes(n, b);
+
+		matrix_batch< T, C, R > result(n);
+		for(size_t r = 0; r < size_t(R); ++r){
+			for(size_t c = 0; c < size_t(C); ++c){
+				auto const o = result.component(c_t(c), r_t(r));
+				for(size_t k = 0; k < size_t(K); ++k){
+					auto const x = a.component(c_t(k), r_t(r));
+					auto const y = b.component(c_t(c), r_t(k));
+					for(size_t i = 0; i < n; ++i) o[i] += x[i] * y[i];
+				}
+			}
+		}
+		return result;
+	}
+
+
+	/// \brief Inverses of all matrices
+	///
+	/// Adjugate formulas without branches, a singular matrix gives
+	/// non-finite values instead of an exception. The lanes behind the
+	/// last matrix are identity matrices.
+	template < typename T, col_t C, row_t R >
+	matrix_batch< T, C, R > inverse(matrix_batch< T, C, R > const& m){
+		constexpr auto n = detail::closed_form_size< C, R >;
+		static_assert(n > 0, "batched inverse is implemented up to 4x4");
+
+		matrix_batch< T, C, R > result(m.size());
+		detail::for_each_lane_block(m.size(),
+			detail::component_pointers(m),
+			detail::identity_lanes< T, n, n * n >(),
+			detail::component_pointers(result),
+			[](auto const& in, auto& out){
+				for(size_t l = 0; l < detail::batch_lanes; ++l){
+					T a[n * n];
+					T adj[n * n];
+					for(size_t k = 0; k < n * n; ++k) a[k] = in[k][l];
+					auto const det =
+						detail::closed_form_adjugate_scalar< n >(a, adj);
+					for(size_t k = 0; k < n * n; ++k){
+						out[k][l] = adj[k] / det;
+					}
+				}
+			});
+		return result;
+	}
+
+
+	/// \brief Solutions x[i] of m[i] * x[i] = v[i]
+	///
+	/// Cramer's rule without branches, a singular matrix gives
+	/// non-finite values instead of an exception. The lanes behind the
+	/// last matrix are identity matrices with a zero right-hand side.
+	template < typename T, col_t C, row_t R >
+	matrix_batch< T, 1_C, R > gaussian_elimination(
+		matrix_batch< T, C, R > const& m,
+		matrix_batch< T, 1_C, R > const& v
+	){
+		constexpr auto n = detail::closed_form_size< C, R >;
+		static_assert(n > 0, "batched solve is implemented up to 4x4");
+		detail::check_batch_sizes(m.size(), v);
+
+		auto in = std::array< T const*, n * n + n >{};
+		auto const mp = detail::component_pointers(m);
+		auto const vp = detail::component_pointers(v);
+		std::copy(mp.begin(), mp.end(), in.begin());
+		std::copy(vp.begin(), vp.end(), in.begin() + n * n);
+
+		matrix_batch< T, 1_C, R > result(m.size());
+		detail::for_each_lane_block(m.size(), in,
+			detail::identity_lanes< T, n, n * n + n >(),
+			detail::component_pointers(result),
+			[](auto const& a, auto& x){
+				for(size_t l = 0; l < detail::batch_lanes; ++l){
+					T lane[n * n];
+					T adj[n * n];
+					for(size_t k = 0; k < n * n; ++k) lane[k] = a[k][l];
+					auto const det =
+						detail::closed_form_adjugate_scalar< n >(lane, adj);
+					for(size_t r = 0; r < n; ++r){
+						T sum = 0;
+						for(size_t c = 0; c < n; ++c){
+							sum += adj[r * n + c] * a[n * n + c][l];
+						}
+						x[r][l] = sum / det;
+					}
+				}
+			});
+		return result;
+	}
+
+
+	/// \brief Eigenvalues (ascending) and eigenvectors (columns) of all
+	///        symmetric matrices
+	///
+	/// The matrices must be symmetric. Unrolled cyclic Jacobi method with
+	/// a fixed count of sweeps, every rotation is applied to all lanes of
+	/// a block at once.
+	template < typename T, col_t C, row_t R >
+	std::pair< matrix_batch< T, 1_C, R >, matrix_batch< T, C, R > >
+	symmetric_eigen(matrix_batch< T, C, R > const& m){
+		constexpr auto n = detail::closed_form_size< C, R >;
+		static_assert(n > 0, "batched eigen is implemented up to 4x4");
+
+		matrix_batch< T, 1_C, R > values(m.size());
+		matrix_batch< T, C, R > vectors(m.size());
+
+		auto out = std::array< T*, n + n * n >{};
+		auto const wp = detail::component_pointers(values);
+		auto const vp = detail::component_pointers(vectors);
+		std::copy(wp.begin(), wp.end(), out.begin());
+		std::copy(vp.begin(), vp.end(), out.begin() + n);
+
+		detail::for_each_lane_block(m.size(),
+			detail::component_pointers(m),
+			detail::identity_lanes< T, n, n * n >(), out,
+			[](auto& a, auto& wv){
+				detail::jacobi_eigen_lanes< n, detail::batch_lanes >(
+					a, wv, wv + n);
+			});
+
+		return {std::move(values), std::move(vectors)};
+	}
+
+
+}
+
+
+#endif
@@ -0,0 +1,380 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__batch_levenberg_marquardt__hpp_INCLUDED_
+#define _mitrax__batch_levenberg_marquardt__hpp_INCLUDED_
+
+#include "batch.hpp"
+#include "gauss_newton_algorithm.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <cmath>
+
+
+namespace mitrax{
+
+
+	struct batch_levenberg_marquardt_options{
+		/// \brief A problem converged if its squared step norm is below
+		double threshold = 1e-10;
+
+		/// \brief Initial damping of all problems
+		double mu = 1;
+
+		/// \brief Steps with a gain ratio up to beta0 are rejected
+		double beta0 = 0.3;
+
+		/// \brief Gain ratios from beta1 halve the damping
+		double beta1 = 0.9;
+
+		/// \brief Maximal count of iterations of a problem
+		size_t max_iterations = 100;
+	};
+
+
+	/// \brief Final state of one problem of a batch
+	enum class fit_status: unsigned char{
+		/// \brief The squared step norm fell below the threshold
+		converged,
+
+		/// \brief The maximal count of iterations was reached
+		max_iterations,
+
+		/// \brief No step reduced the cost, even with maximal damping
+		failed
+	};
+
+
+	template < typename T, row_t P >
+	struct batch_levenberg_marquardt_result{
+		/// \brief Final parameters of all problems
+		matrix_batch< T, 1_C, P > parameters;
+
+		/// \brief Count of iterations of every problem
+		std::vector< size_t > iterations;
+
+		/// \brief Final state of every problem
+		std::vector< fit_status > status;
+	};
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Solve (A + mu^2 * I) * s = -g in all lanes
+	///
+	/// Cholesky factorisation without branches between the lanes, ok[l]
+	/// is false if the matrix of lane l is not positive definite.
+	template < size_t P, typename T >
+	void lane_damped_solve(
+		T const (&a)[P * P][batch_lanes],
+		T const (&g)[P][batch_lanes],
+		T const (&mu)[batch_lanes],
+		T (&s)[P][batch_lanes],
+		bool (&ok)[batch_lanes]
+	){
+		using std::sqrt;
+
+		T l[P * P][batch_lanes];
+		for(size_t i = 0; i < batch_lanes; ++i) ok[i] = true;
+
+		for(size_t j = 0; j < P; ++j){
+			for(size_t i = j; i < P; ++i){
+				T sum[batch_lanes];
+				for(size_t x = 0; x < batch_lanes; ++x){
+					sum[x] = a[i * P + j][x] + (i == j ? mu[x] * mu[x] : T(0));
+				}
+				for(size_t k = 0; k < j; ++k){
+					for(size_t x = 0; x < batch_lanes; ++x){
+						sum[x] -= l[i * P + k][x] * l[j * P + k][x];
+					}
+				}
+
+				if(i == j){
+					for(size_t x = 0; x < batch_lanes; ++x){
+						ok[x] = ok[x] && sum[x] > T(0);
+						l[j * P + j][x] = sqrt(ok[x] ? sum[x] : T(1));
+					}
+				}else{
+					for(size_t x = 0; x < batch_lanes; ++x){
+						l[i * P + j][x] = sum[x] / l[j * P + j][x];
+					}
+				}
+			}
+		}
+
+		// L * y = -g
+		for(size_t i = 0; i < P; ++i){
+			for(size_t x = 0; x < batch_lanes; ++x) s[i][x] = -g[i][x];
+			for(size_t k = 0; k < i; ++k){
+				for(size_t x = 0; x < batch_lanes; ++x){
+					s[i][x] -= l[i * P + k][x] * s[k][x];
+				}
+			}
+			for(size_t x = 0; x < batch_lanes; ++x){
+				s[i][x] /= l[i * P + i][x];
+			}
+		}
+
+		// L^T * s = y
+		for(size_t i = P; i-- > 0;){
+			for(size_t k = i + 1; k < P; ++k){
+				for(size_t x = 0; x < batch_lanes; ++x){
+					s[i][x] -= l[k * P + i][x] * s[k][x];
+				}
+			}
+			for(size_t x = 0; x < batch_lanes; ++x){
+				s[i][x] /= l[i * P + i][x];
+			}
+		}
+	}
+
+
+	/// \brief Parameters of lane l as column vector
+	template < size_t P, typename T >
+	auto lane_vector(T const (&x)[P][batch_lanes], size_t l){
+		return make_vector_fn(rows< row_t(P) >(), [&x, l](size_t i){
+			return x[i][l];
+		});
+	}
+
+
+	/// \brief Levenberg-Marquardt algorithm for the problems of one block
+	///        of lanes in lockstep
+	///
+	/// Lanes from count on are inactive from the start.
+	template < size_t P, typename F, typename T, typename Data >
+	void batch_lm_block(
+		F const& f,
+		Data const& data,
+		size_t first,
+		size_t count,
+		T (&x)[P][batch_lanes],
+		batch_levenberg_marquardt_options const& options,
+		size_t* iterations,
+		fit_status* status
+	){
+		auto const step = T(options.threshold) / 128;
+
+		bool active[batch_lanes];
+		T mu[batch_lanes];
+		for(size_t l = 0; l < batch_lanes; ++l){
+			active[l] = l < count;
+			mu[l] = T(options.mu);
+			if(l < count){
+				iterations[l] = 0;
+				status[l] = fit_status::max_iterations;
+			}
+		}
+
+		auto const points = [&data, first](size_t l)->auto const&{
+			return data[first + l];
+		};
+
+		while(std::any_of(active, active + batch_lanes, [](bool a){
+			return a;
+		})){
+			// Normal equations of the active lanes, SoA
+			T jtj[P * P][batch_lanes] = {};
+			T jtr[P][batch_lanes] = {};
+			T cost[batch_lanes] = {};
+			for(size_t l = 0; l < batch_lanes; ++l){
+				if(!active[l]) continue;
+
+				auto const& lane_data = points(l);
+				T sum[P * P + P + 1] = {};
+				accumulate_normal_rows(f, lane_vector(x, l), lane_data, 0,
+					data_size(lane_data), step, sum);
+
+				for(size_t a = 0; a < P; ++a){
+					for(size_t b = 0; b < P; ++b){
+						jtj[a * P + b][l] =
+							sum[std::min(a, b) * P + std::max(a, b)];
+					}
+					jtr[a][l] = sum[P * P + a];
+				}
+				cost[l] = sum[P * P + P];
+			}
+
+			T trace[batch_lanes] = {};
+			for(size_t a = 0; a < P; ++a){
+				for(size_t l = 0; l < batch_lanes; ++l){
+					trace[l] += jtj[a * P + a][l];
+				}
+			}
+
+			// Damping loop, all pending lanes are solved together
+			bool pending[batch_lanes];
+			bool failed[batch_lanes] = {};
+			size_t increases[batch_lanes] = {};
+			std::copy(active, active + batch_lanes, pending);
+			T s[P][batch_lanes];
+			T accepted[P][batch_lanes] = {};
+
+			// Like increase_damping, a lane fails instead of throwing
+			auto const increase = [&](size_t l){
+				if(increases[l] == max_damping_increases){
+					failed[l] = true;
+					pending[l] = false;
+					return;
+				}
+				mu[l] = increase_damping(mu[l], trace[l], increases[l]);
+			};
+
+			while(std::any_of(pending, pending + batch_lanes, [](bool p){
+				return p;
+			})){
+				bool ok[batch_lanes];
+				lane_damped_solve< P >(jtj, jtr, mu, s, ok);
+
+				for(size_t l = 0; l < batch_lanes; ++l){
+					if(!pending[l]) continue;
+
+					if(!ok[l]){
+						increase(l);
+						continue;
+					}
+
+					// Predicted reduction -s^T * (2 * J^T * r + J^T * J * s)
+					T predicted = 0;
+					for(size_t a = 0; a < P; ++a){
+						T sum = 2 * jtr[a][l];
+						for(size_t b = 0; b < P; ++b){
+							sum += jtj[a * P + b][l] * s[b][l];
+						}
+						predicted -= s[a][l] * sum;
+					}
+
+					auto const trial = make_vector_fn(rows< row_t(P) >(),
+						[&x, &s, l](size_t i){ return x[i][l] + s[i][l]; });
+					auto const& lane_data = points(l);
+					auto const gain = (cost[l] - residual_sum(f, trial,
+						lane_data, 0, data_size(lane_data))) / predicted;
+
+					if(!(predicted > T(0)) || gain <= T(options.beta0)){
+						increase(l);
+						continue;
+					}
+
+					if(gain >= T(options.beta1)) mu[l] /= 2;
+					for(size_t a = 0; a < P; ++a) accepted[a][l] = s[a][l];
+					pending[l] = false;
+				}
+			}
+
+			for(size_t l = 0; l < batch_lanes; ++l){
+				if(!active[l]) continue;
+
+				++iterations[l];
+				if(failed[l]){
+					status[l] = fit_status::failed;
+					active[l] = false;
+					continue;
+				}
+
+				T norm = 0;
+				for(size_t a = 0; a < P; ++a){
+					x[a][l] += accepted[a][l];
+					norm += accepted[a][l] * accepted[a][l];
+				}
+
+				if(norm < T(options.threshold)){
+					status[l] = fit_status::converged;
+					active[l] = false;
+				}else if(iterations[l] >= options.max_iterations){
+					active[l] = false;
+				}
+			}
+		}
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Levenberg-Marquardt algorithm for many independent problems
+	///        of the same model
+	///
+	/// Problem i starts at start[i] and fits f(parameters, point) for all
+	/// points of the random access range data[i]. The problems are
+	/// processed in blocks of detail::batch_lanes which advance in
+	/// lockstep with structure of arrays state, per problem damping and
+	/// per problem masks. The damped normal equations of a block are
+	/// solved together by a Cholesky factorisation without branches
+	/// between the problems. The blocks are distributed by policy. The
+	/// damping of a problem increases like in
+	/// levenberg_marquardt_algorithm, a problem fails after
+	/// detail::max_damping_increases increases in one iteration.
+	///
+	/// Jacobians are forward differences with threshold / 128 or exact if
+	/// f is auto_differentiated, f may be block_evaluated. Nothing is
+	/// thrown for a single problem, its state is reported in the result
+	/// instead.
+	template < typename Policy, typename F, typename T, row_t P,
+		typename Data,
+		std::enable_if_t< execution::is_execution_policy_v< Policy >,
+			int > = 0 >
+	batch_levenberg_marquardt_result< T, P > batch_levenberg_marquardt(
+		Policy const& policy,
+		F const& f,
+		matrix_batch< T, 1_C, P > const& start,
+		Data const& data,
+		batch_levenberg_marquardt_options const& options =
+			batch_levenberg_marquardt_options()
+	){
+		constexpr auto p = size_t(P);
+		constexpr auto lanes = detail::batch_lanes;
+
+		auto const count = start.size();
+		if(detail::data_size(data) != count){
+			throw std::logic_error(
+				"batch_levenberg_marquardt: incompatible sizes");
+		}
+
+		batch_levenberg_marquardt_result< T, P > result{
+			matrix_batch< T, 1_C, P >(count),
+			std::vector< size_t >(count),
+			std::vector< fit_status >(count)};
+
+		auto const in = detail::component_pointers(start);
+		auto const out = detail::component_pointers(result.parameters);
+
+		detail::execution_for_chunks(policy, count, lanes,
+			[&](size_t, size_t begin, size_t end){
+				auto const n = end - begin;
+
+				T x[p][lanes] = {};
+				for(size_t a = 0; a < p; ++a){
+					std::copy(in[a] + begin, in[a] + end, x[a]);
+				}
+
+				detail::batch_lm_block< p >(f, data, begin, n, x, options,
+					result.iterations.data() + begin,
+					result.status.data() + begin);
+
+				for(size_t a = 0; a < p; ++a){
+					std::copy(x[a], x[a] + n, out[a] + begin);
+				}
+			});
+
+		return result;
+	}
+
+
+}
+
+
+#endif
@@ -0,0 +1,412 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__cholesky_decomposition__hpp_INCLUDED_
+#define _mitrax__cholesky_decomposition__hpp_INCLUDED_
+
+#include "convert.hpp"
+#include "triangular.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <optional>
+#include <string>
+#include <utility>
+#include <cmath>
+
+
+namespace mitrax::detail{
+
+
+	template < typename T, dim_t D, typename M, col_t C, row_t R >
+	std_square_matrix< T, D > make_square_factors(
+		matrix< M, C, R > const& m, char const* name
+	){
+		if(size_t(m.cols()) != size_t(m.rows())){
+			throw std::logic_error(std::string(name) +
+				" with non square matrix");
+		}
+
+		auto const f = [&m](c_t c, r_t r){
+			return static_cast< T >(m(c, r));
+		};
+
+		if constexpr(D == 0_D){
+			return make_matrix_fn(dims(dim_t(size_t(m.cols()))), f);
+		}else{
+			if(size_t(m.cols()) != size_t(D)){
+				throw std::logic_error(std::string(name) +
+					": incompatible dimensions");
+			}
+
+			return make_matrix_fn(dims< D >(), f);
+		}
+	}
+
+
+	/// \brief Factorise column J of an N x N matrix, row-major lower
+	///        triangle, loops have compile time bounds
+	template < typename T, size_t N, size_t J >
+	bool cholesky_column(T* a){
+		using std::sqrt;
+
+		auto d = a[J * N + J];
+		for(size_t k = 0; k < J; ++k) d -= a[J * N + k] * a[J * N + k];
+		if(!(d > T(0))) return false;
+
+		auto const l = sqrt(d);
+		a[J * N + J] = l;
+
+		for(size_t i = J + 1; i < N; ++i){
+			auto v = a[i * N + J];
+			for(size_t k = 0; k < J; ++k) v -= a[i * N + k] * a[J * N + k];
+			a[i * N + J] = v / l;
+		}
+
+		return true;
+	}
+
+	template < typename T, size_t N, size_t ... J >
+	bool cholesky_unrolled(T* a, std::index_sequence< J ... >){
+		return (cholesky_column< T, N, J >(a) && ...);
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Cholesky factorisation A = L * L^T of a symmetric positive
+	///        definite matrix
+	///
+	/// Only the lower triangle of A is read. Compile time sizes up to
+	/// unroll_limit are factorised with fixed loop bounds, larger
+	/// matrices in column panels with blocked updates of the trailing
+	/// matrix.
+	template < typename T, dim_t D >
+	class cholesky_decomposition{
+	public:
+		/// \brief Type of the factors
+		using value_type = T;
+
+		/// \brief Count of columns of a panel in the blocked factorisation
+		static constexpr size_t block_size = 32;
+
+		/// \brief Largest compile time dimension with unrolled loops
+		static constexpr size_t unroll_limit = 8;
+
+
+		/// \brief Throws std::logic_error if m is not positive definite
+		template < typename M, col_t C, row_t R >
+		explicit cholesky_decomposition(matrix< M, C, R > const& m):
+			l_(detail::make_square_factors< T, D >(
+				m, "cholesky_decomposition"))
+		{
+			if(!factorise()){
+				throw std::logic_error(
+					"cholesky_decomposition with non positive definite "
+					"matrix");
+			}
+		}
+
+
+		/// \brief Factorisation or an empty optional if m is not positive
+		///        definite
+		template < typename M, col_t C, row_t R >
+		static std::optional< cholesky_decomposition >
+		try_factorise(matrix< M, C, R > const& m){
+			cholesky_decomposition result(m, std::nullopt);
+			if(!result.factorise()) return std::nullopt;
+			return result;
+		}
+
+
+		/// \brief Dimension of the factorised square matrix
+		auto size()const{
+			return l_.cols().as_dim();
+		}
+
+		/// \brief Lower triangular factor
+		std_square_matrix< T, D > lower()const{
+			return make_matrix_fn(size(), [this](c_t c, r_t r){
+				return size_t(c) <= size_t(r) ? l_(c, r) : T(0);
+			});
+		}
+
+
+		/// \brief Solve A * X = B for all columns of B
+		template < typename M, col_t C, row_t R >
+		auto solve(matrix< M, C, R > const& b)const{
+			using result_type = std::common_type_t< T, value_type_t< M > >;
+
+			auto const n = size_t(size());
+			if(size_t(b.rows()) != n){
+				throw std::logic_error(
+					"cholesky_decomposition::solve: incompatible dimensions");
+			}
+
+			auto x = convert< result_type >(b);
+			auto const m = size_t(b.cols());
+			auto const xd = x.data();
+			auto const ld = l_.data();
+
+			// L * Y = B and L^T * X = Y
+			auto const l = detail::row_pointer{ld, n};
+			auto const xr = detail::row_pointer{xd, m};
+			detail::trsm(triangle::lower, operation::none, diag::non_unit,
+				n, m, l, xr);
+			detail::trsm(triangle::lower, operation::transpose,
+				diag::non_unit, n, m, l, xr);
+
+			return x;
+		}
+
+		/// \brief Inverse of the factorised matrix
+		std_square_matrix< T, D > inverse()const{
+			return solve(make_identity_matrix< T >(size()));
+		}
+
+		/// \brief Determinant of the factorised matrix
+		T determinant()const{
+			T result = T(1);
+			for(auto i = 0_d; i < size(); ++i){
+				result *= l_(c_t(i), r_t(i));
+			}
+			return result * result;
+		}
+
+
+	private:
+		template < typename M, col_t C, row_t R >
+		cholesky_decomposition(matrix< M, C, R > const& m, std::nullopt_t):
+			l_(detail::make_square_factors< T, D >(
+				m, "cholesky_decomposition"))
+			{}
+
+
+		bool factorise(){
+			if constexpr(D != 0_D && size_t(D) <= unroll_limit){
+				return detail::cholesky_unrolled< T, size_t(D) >(
+					l_.data(), std::make_index_sequence< size_t(D) >());
+			}else{
+				return factorise_blocked();
+			}
+		}
+
+		bool factorise_blocked(){
+			using std::sqrt;
+
+			auto const n = size_t(size());
+			auto const a = l_.data();
+
+			for(size_t kb = 0; kb < n; kb += block_size){
+				auto const ke = std::min(kb + block_size, n);
+
+				// Columns [kb, ke) of all rows below the diagonal, earlier
+				// panels are already subtracted
+				for(size_t j = kb; j < ke; ++j){
+					auto const lj = a + j * n;
+
+					auto d = lj[j];
+					for(size_t k = kb; k < j; ++k) d -= lj[k] * lj[k];
+					if(!(d > T(0))) return false;
+
+					auto const l = sqrt(d);
+					lj[j] = l;
+
+					for(size_t i = j + 1; i < n; ++i){
+						auto const li = a + i * n;
+						auto v = li[j];
+						for(size_t k = kb; k < j; ++k) v -= li[k] * lj[k];
+						li[j] = v / l;
+					}
+				}
+
+				// A22 -= L21 * L21^T, lower triangle only
+				for(size_t i = ke; i < n; ++i){
+					auto const li = a + i * n;
+					for(size_t j = ke; j <= i; ++j){
+						auto const lj = a + j * n;
+						auto v = T(0);
+						for(size_t k = kb; k < ke; ++k) v += li[k] * lj[k];
+						li[j] -= v;
+					}
+				}
+			}
+
+			return true;
+		}
+
+
+		std_square_matrix< T, D > l_;
+	};
+
+
+	template < typename M, col_t C, row_t R >
+	cholesky_decomposition(matrix< M, C, R > const&) ->
+		cholesky_decomposition<
+			value_type_t< M >, C != 0_C ? dim_t(C) : dim_t(R) >;
+
+
+	/// \brief Cholesky factorisation or an empty optional if m is not
+	///        positive definite
+	template < typename M, col_t C, row_t R >
+	auto try_cholesky_decomposition(matrix< M, C, R > const& m){
+		return cholesky_decomposition< value_type_t< M >,
+			C != 0_C ? dim_t(C) : dim_t(R) >::try_factorise(m);
+	}
+
+	/// \brief true if the symmetric matrix m is positive definite
+	template < typename M, col_t C, row_t R >
+	bool is_positive_definite(matrix< M, C, R > const& m){
+		return try_cholesky_decomposition(m).has_value();
+	}
+
+
+	/// \brief Factorisation A = L * D * L^T of a symmetric matrix without
+	///        square roots
+	///
+	/// L has a unit diagonal. The matrix must not need pivoting, which
+	/// holds for positive and negative definite matrices.
+	template < typename T, dim_t D >
+	class ldlt_decomposition{
+	public:
+		/// \brief Type of the factors
+		using value_type = T;
+
+
+		/// \brief Throws std::logic_error if a pivot is 0
+		template < typename M, col_t C, row_t R >
+		explicit ldlt_decomposition(matrix< M, C, R > const& m):
+			ld_(detail::make_square_factors< T, D >(
+				m, "ldlt_decomposition"))
+		{
+			factorise();
+		}
+
+
+		/// \brief Dimension of the factorised square matrix
+		auto size()const{
+			return ld_.cols().as_dim();
+		}
+
+		/// \brief Unit lower triangular factor
+		std_square_matrix< T, D > lower()const{
+			return make_matrix_fn(size(), [this](c_t c, r_t r){
+				return size_t(c) < size_t(r) ? ld_(c, r)
+					: size_t(c) == size_t(r) ? T(1) : T(0);
+			});
+		}
+
+		/// \brief Diagonal of D
+		auto diagonal()const{
+			return make_vector_fn(size().as_row(), [this](size_t i){
+				return ld_(c_t(i), r_t(i));
+			});
+		}
+
+
+		/// \brief Solve A * X = B for all columns of B
+		template < typename M, col_t C, row_t R >
+		auto solve(matrix< M, C, R > const& b)const{
+			using result_type = std::common_type_t< T, value_type_t< M > >;
+
+			auto const n = size_t(size());
+			if(size_t(b.rows()) != n){
+				throw std::logic_error(
+					"ldlt_decomposition::solve: incompatible dimensions");
+			}
+
+			auto x = convert< result_type >(b);
+			auto const m = size_t(b.cols());
+			auto const xd = x.data();
+			auto const ld = ld_.data();
+
+			auto const l = detail::row_pointer{ld, n};
+			auto const xr = detail::row_pointer{xd, m};
+
+			// L * Z = B
+			detail::trsm(triangle::lower, operation::none, diag::unit,
+				n, m, l, xr);
+
+			// D * Y = Z
+			for(size_t i = 0; i < n; ++i){
+				auto const xi = xd + i * m;
+				auto const d = ld[i * n + i];
+				for(size_t j = 0; j < m; ++j) xi[j] /= d;
+			}
+
+			// L^T * X = Y
+			detail::trsm(triangle::lower, operation::transpose, diag::unit,
+				n, m, l, xr);
+
+			return x;
+		}
+
+		/// \brief Determinant of the factorised matrix
+		T determinant()const{
+			T result = T(1);
+			for(auto i = 0_d; i < size(); ++i){
+				result *= ld_(c_t(i), r_t(i));
+			}
+			return result;
+		}
+
+
+	private:
+		void factorise(){
+			auto const n = size_t(size());
+			auto const a = ld_.data();
+
+			// Row j of L scaled by D
+			auto ldj = make_vector_v< T >(size().as_row());
+			auto const w = ldj.data();
+
+			for(size_t j = 0; j < n; ++j){
+				auto const lj = a + j * n;
+
+				auto d = lj[j];
+				for(size_t k = 0; k < j; ++k){
+					w[k] = lj[k] * a[k * n + k];
+					d -= lj[k] * w[k];
+				}
+
+				if(d == T(0)){
+					throw std::logic_error(
+						"ldlt_decomposition with singular pivot");
+				}
+
+				lj[j] = d;
+
+				// Rows below j, walked by pointer so the index arithmetic
+				// can't hide the bounds from the compiler
+				for(auto li = lj + n; li != a + n * n; li += n){
+					auto v = li[j];
+					for(size_t k = 0; k < j; ++k) v -= li[k] * w[k];
+					li[j] = v / d;
+				}
+			}
+		}
+
+
+		std_square_matrix< T, D > ld_;
+	};
+
+
+	template < typename M, col_t C, row_t R >
+	ldlt_decomposition(matrix< M, C, R > const&) ->
+		ldlt_decomposition<
+			value_type_t< M >, C != 0_C ? dim_t(C) : dim_t(R) >;
+
+
+}
+
+
+#endif
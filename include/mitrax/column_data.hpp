@@ -0,0 +1,132 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__column_data__hpp_INCLUDED_
+#define _mitrax__column_data__hpp_INCLUDED_
+
+#include "layout.hpp"
+#include "matrix_fwd.hpp"
+#include "utility.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+namespace mitrax{
+
+
+	/// \brief Random access view of data points stored as one column per
+	///        field
+	///
+	/// Element i is the std::tuple of the elements i of all columns, so a
+	/// model function for tuples works on columnar data without a copy
+	/// of the data set. The columns are accessed by random access
+	/// iterators, column< I >() is a pointer for contiguous columns like
+	/// mitrax vectors or std::vector. The columns must outlive the
+	/// view.
+	template < typename ... Iters >
+	class column_data{
+	public:
+		/// \brief Type of a data point
+		using value_type = std::tuple<
+			typename std::iterator_traits< Iters >::value_type ... >;
+
+
+		constexpr column_data(std::size_t size, Iters ... columns):
+			size_(size), columns_(columns ...) {}
+
+
+		/// \brief Count of data points
+		constexpr std::size_t size()const noexcept{
+			return size_;
+		}
+
+		/// \brief Data point i
+		constexpr value_type operator[](std::size_t i)const{
+			return std::apply([i](auto const& ... columns){
+					return value_type(columns[i] ...);
+				}, columns_);
+		}
+
+		/// \brief Begin of column I
+		template < std::size_t I >
+		constexpr auto column()const{
+			return std::get< I >(columns_);
+		}
+
+
+	private:
+		std::size_t size_;
+		std::tuple< Iters ... > columns_;
+	};
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief True if data() of Column points to its contiguous values
+	template < typename Column >
+	struct is_contiguous_column: std::bool_constant< has_data_v<
+		std::remove_reference_t<
+			decltype(*std::begin(std::declval< Column const& >())) >*,
+		Column const > >{};
+
+	/// \brief matrix::data()const exists for every impl, ask the impl
+	template < typename M, col_t C, row_t R >
+	struct is_contiguous_column< matrix< M, C, R > >:
+		std::bool_constant< has_row_major_data_v< M > >{};
+
+
+	/// \brief data() if column is contiguous, begin otherwise
+	template < typename Column >
+	constexpr auto column_begin(Column const& column){
+		if constexpr(is_contiguous_column< Column >::value){
+			return column.data();
+		}else{
+			return std::begin(column);
+		}
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Columnar data points, one random access range per field
+	///
+	/// Throws std::logic_error if the columns have different sizes.
+	template < typename Column, typename ... Columns >
+	auto make_column_data(Column const& column, Columns const& ... columns){
+		auto const size = std::size_t(
+			std::distance(std::begin(column), std::end(column)));
+		if(((std::size_t(std::distance(
+			std::begin(columns), std::end(columns))) != size) || ...)){
+			throw std::logic_error(
+				"make_column_data: columns with different sizes");
+		}
+
+		return column_data< decltype(detail::column_begin(column)),
+			decltype(detail::column_begin(columns)) ... >(size,
+				detail::column_begin(column),
+				detail::column_begin(columns) ...);
+	}
+
+
+}
+
+
+#endif
@@ -10,6 +10,7 @@
 #define _mitrax__compare__hpp_INCLUDED_
 
 #include "matrix_interface.hpp"
+#include "layout.hpp"
 
 #include <stdexcept>
 
@@ -26,13 +27,23 @@ namespace mitrax{
 	){
 		auto size = get_dims(m2, m1);
 
-		for(auto r = 0_r; r < size.rows(); ++r){
-			for(auto c = 0_c; c < size.cols(); ++c){
-				if(m1(c, r) != m2(c, r)) return false;
+		using layout_type = layout_t< M1, M2 >;
+		if constexpr(std::is_same_v< layout_type, layout::row_major >){
+			for(auto r = 0_r; r < size.rows(); ++r){
+				for(auto c = 0_c; c < size.cols(); ++c){
+					if(m1(c, r) != m2(c, r)) return false;
+				}
 			}
-		}
 
-		return true;
+			return true;
+		}else{
+			// Both matrices share the layout, compare in storage order
+			return layout_type::traverse(
+				size_t(size.cols()), size_t(size.rows()),
+				[&](size_t c, size_t r){
+					return !(m1(c_t(c), r_t(r)) != m2(c_t(c), r_t(r)));
+				});
+		}
 	}
 
 	template <
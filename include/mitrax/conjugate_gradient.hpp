@@ -0,0 +1,560 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__conjugate_gradient__hpp_INCLUDED_
+#define _mitrax__conjugate_gradient__hpp_INCLUDED_
+
+#include "layout.hpp"
+#include "sparse.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cmath>
+
+
+namespace mitrax{
+
+
+	struct conjugate_gradient_options{
+		/// \brief Maximal count of iterations, 0 for the dimension
+		size_t max_iterations = 0;
+
+		/// \brief Stop if ||b - A * x|| <= tolerance * ||b||
+		double tolerance = 1e-10;
+
+		/// \brief Count of threads, 0 for the hardware concurrency
+		size_t threads = 0;
+	};
+
+
+	/// \brief Progress after an iteration of the conjugate gradient method
+	template < typename T >
+	struct conjugate_gradient_state{
+		/// \brief Count of finished iterations
+		size_t iteration;
+
+		/// \brief Euclidean norm of the residual b - A * x
+		T residual_norm;
+
+		/// \brief residual_norm / ||b||
+		T relative_residual;
+	};
+
+	/// \brief Outcome of the conjugate gradient method
+	template < typename T >
+	struct conjugate_gradient_result{
+		/// \brief Count of iterations
+		size_t iterations;
+
+		/// \brief Euclidean norm of the residual b - A * x
+		T residual_norm;
+
+		/// \brief true if the tolerance was reached
+		bool converged;
+	};
+
+
+	/// \brief No preconditioning, M = I
+	struct identity_preconditioner{};
+
+
+	/// \brief Preconditioning with the diagonal of A
+	template < typename T >
+	class jacobi_preconditioner{
+	public:
+		/// \brief Throws std::logic_error if a diagonal value is zero
+		template < typename M, col_t C, row_t R >
+		explicit jacobi_preconditioner(matrix< M, C, R > const& m):
+			inverse_(size_t(m.rows()))
+		{
+			if(size_t(m.cols()) != size_t(m.rows())){
+				throw std::logic_error(
+					"jacobi_preconditioner with non square matrix");
+			}
+
+			for(size_t i = 0; i < inverse_.size(); ++i){
+				auto const d = static_cast< T >(m(c_t(i), r_t(i)));
+				if(d == T(0)){
+					throw std::logic_error(
+						"jacobi_preconditioner with zero diagonal value");
+				}
+				inverse_[i] = T(1) / d;
+			}
+		}
+
+
+		/// \brief Dimension of the preconditioned system
+		size_t size()const{
+			return inverse_.size();
+		}
+
+		/// \brief z = M^-1 * r
+		void apply(T const* r, T* z)const{
+			for(size_t i = 0; i < inverse_.size(); ++i){
+				z[i] = r[i] * inverse_[i];
+			}
+		}
+
+
+	private:
+		std::vector< T > inverse_;
+	};
+
+	template < typename M, col_t C, row_t R >
+	jacobi_preconditioner(matrix< M, C, R > const&)
+		-> jacobi_preconditioner< value_type_t< M > >;
+
+
+	/// \brief Preconditioning with the incomplete Cholesky factorisation
+	///        IC(0)
+	///
+	/// L has the sparsity pattern of the lower triangle of the symmetric
+	/// matrix, M = L * L^T.
+	template < typename T >
+	class incomplete_cholesky_preconditioner{
+	public:
+		/// \brief Throws std::logic_error if a diagonal value is missing
+		///        or a pivot is not positive
+		template < typename U, typename Layout, col_t C, row_t R >
+		explicit incomplete_cholesky_preconditioner(
+			sparse_matrix< U, Layout, C, R > const& m
+		){
+			if(size_t(m.cols()) != size_t(m.rows())){
+				throw std::logic_error("incomplete_cholesky_preconditioner "
+					"with non square matrix");
+			}
+
+			// m is symmetric, so its compressed rows or columns are the
+			// rows of m in both layouts
+			auto const& impl = m.impl();
+			auto const& offsets = impl.offsets();
+			auto const& indices = impl.indices();
+			auto const& values = impl.values();
+			auto const n = size_t(m.rows());
+
+			offsets_.assign(n + 1, 0);
+			for(size_t i = 0; i < n; ++i){
+				for(auto k = offsets[i]; k < offsets[i + 1]; ++k){
+					if(indices[k] > i) break;
+					indices_.push_back(indices[k]);
+					values_.push_back(static_cast< T >(values[k]));
+				}
+
+				offsets_[i + 1] = indices_.size();
+				if(offsets_[i + 1] == offsets_[i] || indices_.back() != i){
+					throw std::logic_error("incomplete_cholesky_preconditioner "
+						"without diagonal value");
+				}
+			}
+
+			factorise();
+		}
+
+
+		/// \brief Dimension of the preconditioned system
+		size_t size()const{
+			return offsets_.size() - 1;
+		}
+
+		/// \brief z = (L * L^T)^-1 * r
+		void apply(T const* r, T* z)const{
+			auto const n = size();
+
+			// L * y = r
+			for(size_t i = 0; i < n; ++i){
+				auto const d = offsets_[i + 1] - 1;
+				auto sum = r[i];
+				for(auto k = offsets_[i]; k < d; ++k){
+					sum -= values_[k] * z[indices_[k]];
+				}
+				z[i] = sum / values_[d];
+			}
+
+			// L^T * z = y
+			for(size_t i = n; i-- > 0;){
+				auto const d = offsets_[i + 1] - 1;
+				z[i] /= values_[d];
+				for(auto k = offsets_[i]; k < d; ++k){
+					z[indices_[k]] -= values_[k] * z[i];
+				}
+			}
+		}
+
+
+	private:
+		/// \brief Row-wise IC(0), the diagonal is the last value of a row
+		void factorise(){
+			using std::sqrt;
+
+			auto const n = size();
+			for(size_t i = 0; i < n; ++i){
+				auto const d = offsets_[i + 1] - 1;
+				for(auto k = offsets_[i]; k < d; ++k){
+					// Sum of L(i, j) * L(l, j) over the common pattern j < l
+					auto const l = indices_[k];
+					auto const dl = offsets_[l + 1] - 1;
+					auto sum = T(0);
+					auto p = offsets_[i];
+					auto q = offsets_[l];
+					while(p < k && q < dl){
+						if(indices_[p] < indices_[q]){
+							++p;
+						}else if(indices_[q] < indices_[p]){
+							++q;
+						}else{
+							sum += values_[p++] * values_[q++];
+						}
+					}
+					values_[k] = (values_[k] - sum) / values_[dl];
+				}
+
+				auto pivot = values_[d];
+				for(auto k = offsets_[i]; k < d; ++k){
+					pivot -= values_[k] * values_[k];
+				}
+				if(!(pivot > T(0))){
+					throw std::logic_error("incomplete_cholesky_preconditioner "
+						"with non positive pivot");
+				}
+				values_[d] = sqrt(pivot);
+			}
+		}
+
+
+		std::vector< size_t > offsets_;
+		std::vector< size_t > indices_;
+		std::vector< T > values_;
+	};
+
+	template < typename U, typename Layout, col_t C, row_t R >
+	incomplete_cholesky_preconditioner(sparse_matrix< U, Layout, C, R > const&)
+		-> incomplete_cholesky_preconditioner< U >;
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Count of vector elements of a parallel task
+	constexpr size_t cg_chunk_size = 4096;
+
+	/// \brief Smallest count of chunks which is processed in parallel
+	constexpr size_t cg_parallel_chunks = 16;
+
+
+	/// \brief Call f(k, begin, end) for the chunks k of [0, n)
+	///
+	/// An iteration has several of these rounds. They run on the reused
+	/// threads of detail::thread_pool, so no thread is created per round.
+	template < typename F >
+	void cg_for_chunks(size_t n, size_t threads, F const& f){
+		auto const chunks = (n + cg_chunk_size - 1) / cg_chunk_size;
+		if(chunks < cg_parallel_chunks) threads = 1;
+
+		parallel_for(chunks, threads, [n, &f](size_t k){
+			f(k, k * cg_chunk_size, std::min((k + 1) * cg_chunk_size, n));
+		});
+	}
+
+	/// \brief Sum of the chunk sums in chunk order, so the result does not
+	///        depend on the count of threads
+	template < typename T, typename F >
+	T cg_sum(size_t n, size_t threads, std::vector< T >& partial, F const& f){
+		partial.assign((n + cg_chunk_size - 1) / cg_chunk_size, T(0));
+		cg_for_chunks(n, threads, [&partial, &f](size_t k, size_t b, size_t e){
+			partial[k] = f(b, e);
+		});
+
+		auto sum = T(0);
+		for(auto const v: partial) sum += v;
+		return sum;
+	}
+
+
+	/// \brief Default observer, never stops
+	struct cg_continue{
+		template < typename State >
+		constexpr bool operator()(State const&)const noexcept{
+			return true;
+		}
+	};
+
+
+	/// \brief y = A * x for a symmetric sparse matrix
+	template < typename T, typename U, typename Layout, col_t C, row_t R >
+	void cg_apply(
+		sparse_matrix< U, Layout, C, R > const& a,
+		T const* x, T* y, size_t n, size_t threads
+	){
+		if(size_t(a.cols()) != n || size_t(a.rows()) != n){
+			throw std::logic_error(
+				"conjugate_gradient: incompatible dimensions");
+		}
+
+		// Compressed columns of a symmetric matrix are its rows
+		std::fill(y, y + n, T(0));
+		compressed_gather(make_compressed_view(a), 1, x, y,
+			sparse_threads(a.impl().nonzeros(), threads));
+	}
+
+	/// \brief y = A * x for a dense matrix
+	template < typename T, typename M, col_t C, row_t R >
+	void cg_apply(
+		matrix< M, C, R > const& a,
+		T const* x, T* y, size_t n, size_t threads
+	){
+		if(size_t(a.cols()) != n || size_t(a.rows()) != n){
+			throw std::logic_error(
+				"conjugate_gradient: incompatible dimensions");
+		}
+
+		cg_for_chunks(n, threads, [&a, x, y, n](size_t, size_t b, size_t e){
+			for(auto i = b; i < e; ++i){
+				auto sum = T(0);
+				for(size_t j = 0; j < n; ++j){
+					sum += static_cast< T >(a(c_t(j), r_t(i))) * x[j];
+				}
+				y[i] = sum;
+			}
+		});
+	}
+
+	/// \brief y = A * x by the callable f(x, y)
+	template < typename T, typename F >
+	void cg_apply(F const& f, T const* x, T* y, size_t, size_t){
+		f(x, y);
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Conjugate gradient method with reusable workspace
+	///
+	/// A must be symmetric positive definite. It is a sparse matrix, a
+	/// dense matrix or a callable a(x, y) which stores A * x in y, both
+	/// pointers to n values. The vector operations are processed in
+	/// parallel for large n, the results do not depend on the count of
+	/// threads.
+	template < typename T >
+	class conjugate_gradient_solver{
+	public:
+		/// \brief Type of the vector values
+		using value_type = T;
+
+
+		explicit conjugate_gradient_solver(
+			conjugate_gradient_options const& options =
+				conjugate_gradient_options()
+		): options_(options) {}
+
+
+		conjugate_gradient_options const& options()const{
+			return options_;
+		}
+
+
+		/// \brief Solve A * x = b, x holds the start value
+		///
+		/// preconditioner.apply(r, z) stores M^-1 * r in z. observer(state)
+		/// is called with a conjugate_gradient_state< T > after every
+		/// iteration and stops the method by returning false.
+		template < typename A, typename P = identity_preconditioner,
+			typename O = detail::cg_continue >
+		conjugate_gradient_result< T > solve(
+			A const& a, T const* b, T* x, size_t n,
+			P const& preconditioner = P(), O const& observer = O()
+		){
+			using std::sqrt;
+
+			constexpr bool precondition =
+				!std::is_same_v< P, identity_preconditioner >;
+
+			auto const threads = options_.threads;
+			r_.resize(n);
+			p_.resize(n);
+			q_.resize(n);
+			if constexpr(precondition) z_.resize(n);
+
+			auto const r = r_.data();
+			auto const p = p_.data();
+			auto const q = q_.data();
+			auto const z = precondition ? z_.data() : r;
+
+			auto const dot = [this, n, threads](T const* u, T const* v){
+				return detail::cg_sum(n, threads, partial_,
+					[u, v](size_t b, size_t e){
+						auto sum = T(0);
+						for(auto i = b; i < e; ++i) sum += u[i] * v[i];
+						return sum;
+					});
+			};
+
+			auto const b_norm = sqrt(dot(b, b));
+			if(b_norm == T(0)){
+				std::fill(x, x + n, T(0));
+				return {0, T(0), true};
+			}
+
+			// r = b - A * x
+			detail::cg_apply(a, x, q, n, threads);
+			detail::cg_for_chunks(n, threads, [b, q, r](size_t, size_t s,
+				size_t e
+			){
+				for(auto i = s; i < e; ++i) r[i] = b[i] - q[i];
+			});
+
+			if constexpr(precondition) preconditioner.apply(r, z);
+			std::copy(z, z + n, p);
+
+			auto const target = static_cast< T >(options_.tolerance) * b_norm;
+			auto const max_iterations =
+				options_.max_iterations > 0 ? options_.max_iterations : n;
+
+			auto rz = dot(r, z);
+			auto residual = precondition ? sqrt(dot(r, r)) : sqrt(rz);
+			size_t iteration = 0;
+			while(residual > target && iteration < max_iterations){
+				detail::cg_apply(a, p, q, n, threads);
+
+				auto const pq = dot(p, q);
+				if(!(pq > T(0))){
+					throw std::logic_error("conjugate_gradient with non "
+						"positive definite matrix");
+				}
+
+				// x += alpha * p, r -= alpha * q and ||r||^2
+				auto const alpha = rz / pq;
+				auto const rr = detail::cg_sum(n, threads, partial_,
+					[alpha, x, r, p, q](size_t b, size_t e){
+						auto sum = T(0);
+						for(auto i = b; i < e; ++i){
+							x[i] += alpha * p[i];
+							r[i] -= alpha * q[i];
+							sum += r[i] * r[i];
+						}
+						return sum;
+					});
+
+				++iteration;
+				residual = sqrt(rr);
+
+				if(!observer(conjugate_gradient_state< T >{
+					iteration, residual, residual / b_norm})
+				) break;
+
+				if(residual <= target) break;
+
+				T rz_next;
+				if constexpr(precondition){
+					preconditioner.apply(r, z);
+					rz_next = dot(r, z);
+				}else{
+					rz_next = rr;
+				}
+
+				// p = z + beta * p
+				auto const beta = rz_next / rz;
+				rz = rz_next;
+				detail::cg_for_chunks(n, threads, [beta, z, p](size_t,
+					size_t s, size_t e
+				){
+					for(auto i = s; i < e; ++i) p[i] = z[i] + beta * p[i];
+				});
+			}
+
+			return {iteration, residual, residual <= target};
+		}
+
+		/// \brief Solve A * x = b, x holds the start value
+		template < typename A, typename MB, row_t RB, typename MX, row_t RX,
+			typename P = identity_preconditioner,
+			typename O = detail::cg_continue >
+		conjugate_gradient_result< T > solve(
+			A const& a,
+			matrix< MB, 1_C, RB > const& b,
+			matrix< MX, 1_C, RX >& x,
+			P const& preconditioner = P(), O const& observer = O()
+		){
+			static_assert(std::is_same_v< value_type_t< MX >, T >);
+
+			if(size_t(b.rows()) != size_t(x.rows())){
+				throw std::logic_error(
+					"conjugate_gradient: incompatible dimensions");
+			}
+
+			if constexpr(!(
+				has_row_major_data_v< MX > && has_data_v< T*, MX >
+			)){
+				auto xc = convert< T >(x);
+				auto const result = solve(a, b, xc, preconditioner,
+					observer);
+				for(size_t i = 0; i < size_t(x.rows()); ++i){
+					x[d_t(i)] = xc[d_t(i)];
+				}
+				return result;
+			}else if constexpr(
+				has_row_major_data_v< MB > &&
+				std::is_same_v< value_type_t< MB >, T >
+			){
+				return solve(a, b.data(), x.data(), size_t(x.rows()),
+					preconditioner, observer);
+			}else{
+				auto const bc = convert< T >(b);
+				return solve(a, bc.data(), x.data(), size_t(x.rows()),
+					preconditioner, observer);
+			}
+		}
+
+
+	private:
+		conjugate_gradient_options options_;
+
+		std::vector< T > r_;
+		std::vector< T > z_;
+		std::vector< T > p_;
+		std::vector< T > q_;
+		std::vector< T > partial_;
+	};
+
+
+	/// \brief Solution of A * x = b with start value 0 and the outcome of
+	///        the conjugate gradient method
+	template < typename A, typename MB, row_t R,
+		typename P = identity_preconditioner,
+		typename O = detail::cg_continue >
+	auto conjugate_gradient(
+		A const& a,
+		matrix< MB, 1_C, R > const& b,
+		P const& preconditioner = P(),
+		conjugate_gradient_options const& options =
+			conjugate_gradient_options(),
+		O const& observer = O()
+	){
+		using value_type = value_type_t< MB >;
+
+		auto x = make_vector_v< value_type >(b.rows());
+		auto const result = conjugate_gradient_solver< value_type >(options)
+			.solve(a, b, x, preconditioner, observer);
+
+		return std::make_pair(std::move(x), result);
+	}
+
+
+}
+
+
+#endif
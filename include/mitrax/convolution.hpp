@@ -11,6 +11,12 @@
 
 #include "make_matrix.hpp"
 
+#include <array>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
 
 namespace mitrax{
 
@@ -42,6 +48,18 @@ namespace mitrax{
 		};
 
 
+		/// \brief Zero initialized std::array< T, N > or for N == 0
+		///        std::vector< T > with n elements
+		template < typename T, size_t N >
+		constexpr auto convolution_buffer([[maybe_unused]] size_t n){
+			if constexpr(N != 0){
+				return std::array< T, N >{};
+			}else{
+				return std::vector< T >(n);
+			}
+		}
+
+
 	}
 
 
@@ -75,6 +93,14 @@ namespace mitrax{
 	}
 
 
+	/// \brief Separable convolution with the column vector vc and the row
+	///        vector vr
+	///
+	/// Same result as convolution(convolution(image, vr), vc), but the
+	/// horizontally filtered rows are kept in a ring buffer of vc.rows()
+	/// rows only. Every output row needs one new filtered row, so the
+	/// vertical pass reads rows which are still in cache. With compile
+	/// time dimensions the buffer is on the stack.
 	template <
 		typename M1, col_t C1, row_t R1,
 		typename M2, row_t R2,
@@ -88,7 +114,64 @@ namespace mitrax{
 		SumOp const& sum = std::plus<>(),
 		MulOp const& mul = std::multiplies<>()
 	){
-		return convolution(convolution(image, vr, sum, mul), vc, sum, mul);
+		static_assert(
+			(C1 == 0_C || C3 == 0_C || C1 >= C3) &&
+			(R1 == 0_R || R2 == 0_R || R1 >= R2),
+			"convolution matrix is bigger then image"
+		);
+
+		if(image.cols() < vr.cols() || image.rows() < vc.rows()){
+			throw std::logic_error("convolution matrix is bigger then image");
+		}
+
+		using row_type = std::decay_t< decltype(
+			sum(mul(image(0_c, 0_r), vr[0_d]),
+				mul(image(0_c, 0_r), vr[0_d]))) >;
+		using value_type = std::decay_t< decltype(
+			sum(mul(std::declval< row_type >(), vc[0_d]),
+				mul(std::declval< row_type >(), vc[0_d]))) >;
+
+		auto result = make_matrix_v< value_type >(
+			1_CS + image.cols() - vr.cols(),
+			1_RS + image.rows() - vc.rows());
+
+		auto const width = size_t(result.cols());
+		auto const height = size_t(vc.rows());
+		auto const kernel_width = size_t(vr.cols());
+
+		// height horizontally filtered rows, row y in slot y % height
+		constexpr auto size = C1 != 0_C && C3 != 0_C && R2 != 0_R ?
+			size_t(R2) * (size_t(C1) - size_t(C3) + 1) : size_t(0);
+		auto buffer = detail::convolution_buffer< row_type, size >(
+			height * width);
+
+		auto const filter_row = [&](size_t y){
+			auto const line = buffer.data() + (y % height) * width;
+			for(size_t c = 0; c < width; ++c){
+				auto v = row_type();
+				for(size_t x = 0; x < kernel_width; ++x){
+					v = sum(v, mul(image(c_t(c + x), r_t(y)), vr[d_t(x)]));
+				}
+				line[c] = v;
+			}
+		};
+
+		for(size_t y = 0; y + 1 < height; ++y) filter_row(y);
+
+		for(size_t r = 0; r < size_t(result.rows()); ++r){
+			filter_row(r + height - 1);
+
+			for(size_t c = 0; c < width; ++c){
+				auto v = value_type();
+				for(size_t y = 0; y < height; ++y){
+					v = sum(v, mul(buffer[((r + y) % height) * width + c],
+						vc[d_t(y)]));
+				}
+				result(c_t(c), r_t(r)) = v;
+			}
+		}
+
+		return result;
 	}
 
 
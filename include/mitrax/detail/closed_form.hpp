@@ -0,0 +1,230 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__detail__closed_form__hpp_INCLUDED_
+#define _mitrax__detail__closed_form__hpp_INCLUDED_
+
+#include "../dim.hpp"
+
+#include <type_traits>
+#include <cstddef>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#ifdef __has_builtin
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define MITRAX_HAS_IS_CONSTANT_EVALUATED
+#endif
+#endif
+
+
+namespace mitrax::detail{
+
+
+	/// \brief N for compile time N x N matrices with 1 <= N <= 4, else 0
+	template < col_t C, row_t R >
+	constexpr std::size_t closed_form_size =
+		C != col_t(0) && std::size_t(C) == std::size_t(R) &&
+		std::size_t(C) <= 4 ? std::size_t(C) : 0;
+
+
+	/// \brief Determinant of the row-major N x N matrix a
+	template < std::size_t N, typename T >
+	constexpr T closed_form_determinant(T const* a){
+		static_assert(N >= 1 && N <= 4);
+
+		if constexpr(N == 1){
+			return a[0];
+		}else if constexpr(N == 2){
+			return a[0] * a[3] - a[1] * a[2];
+		}else if constexpr(N == 3){
+			return
+				a[0] * (a[4] * a[8] - a[5] * a[7]) -
+				a[1] * (a[3] * a[8] - a[5] * a[6]) +
+				a[2] * (a[3] * a[7] - a[4] * a[6]);
+		}else{
+			// 2 x 2 minors of the upper and the lower two rows
+			auto const s0 = a[0] * a[5] - a[1] * a[4];
+			auto const s1 = a[0] * a[6] - a[2] * a[4];
+			auto const s2 = a[0] * a[7] - a[3] * a[4];
+			auto const s3 = a[1] * a[6] - a[2] * a[5];
+			auto const s4 = a[1] * a[7] - a[3] * a[5];
+			auto const s5 = a[2] * a[7] - a[3] * a[6];
+			auto const c5 = a[10] * a[15] - a[11] * a[14];
+			auto const c4 = a[9] * a[15] - a[11] * a[13];
+			auto const c3 = a[9] * a[14] - a[10] * a[13];
+			auto const c2 = a[8] * a[15] - a[11] * a[12];
+			auto const c1 = a[8] * a[14] - a[10] * a[12];
+			auto const c0 = a[8] * a[13] - a[9] * a[12];
+			return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		}
+	}
+
+
+#if defined(__SSE__) && defined(MITRAX_HAS_IS_CONSTANT_EVALUATED)
+	/// \brief Adjugate of a row-major 4 x 4 float matrix, returns the
+	///        determinant
+	///
+	/// Row r of the adjugate is a signed combination of three columns of
+	/// a (with swapped element pairs) scaled by the 2 x 2 minors.
+	inline float adjugate4_sse(float const* a, float* b){
+		auto const r0 = _mm_loadu_ps(a);
+		auto const r1 = _mm_loadu_ps(a + 4);
+		auto const r2 = _mm_loadu_ps(a + 8);
+		auto const r3 = _mm_loadu_ps(a + 12);
+
+		// (s0, s1, s2, s3) and (s4, s5, _, _) of rows 0 and 1, (c0, c1,
+		// c2, c3) and (c4, c5, _, _) of rows 2 and 3
+		auto const minors = [](__m128 u, __m128 v, __m128& low, __m128& high){
+			low = _mm_sub_ps(
+				_mm_mul_ps(
+					_mm_shuffle_ps(u, u, _MM_SHUFFLE(1, 0, 0, 0)),
+					_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 2, 1))),
+				_mm_mul_ps(
+					_mm_shuffle_ps(u, u, _MM_SHUFFLE(2, 3, 2, 1)),
+					_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 0, 0))));
+			high = _mm_sub_ps(
+				_mm_mul_ps(
+					_mm_shuffle_ps(u, u, _MM_SHUFFLE(3, 3, 2, 1)),
+					_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))),
+				_mm_mul_ps(
+					_mm_shuffle_ps(u, u, _MM_SHUFFLE(3, 3, 3, 3)),
+					_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 2, 1))));
+		};
+
+		__m128 s03, s45, c03, c45;
+		minors(r0, r1, s03, s45);
+		minors(r2, r3, c03, c45);
+
+		// x_i = (c_i, c_i, s_i, s_i)
+		auto const x0 = _mm_shuffle_ps(c03, s03, _MM_SHUFFLE(0, 0, 0, 0));
+		auto const x1 = _mm_shuffle_ps(c03, s03, _MM_SHUFFLE(1, 1, 1, 1));
+		auto const x2 = _mm_shuffle_ps(c03, s03, _MM_SHUFFLE(2, 2, 2, 2));
+		auto const x3 = _mm_shuffle_ps(c03, s03, _MM_SHUFFLE(3, 3, 3, 3));
+		auto const x4 = _mm_shuffle_ps(c45, s45, _MM_SHUFFLE(0, 0, 0, 0));
+		auto const x5 = _mm_shuffle_ps(c45, s45, _MM_SHUFFLE(1, 1, 1, 1));
+
+		// k_j = (a(j, 1), a(j, 0), a(j, 3), a(j, 2)), column j of a with
+		// swapped pairs
+		auto t0 = r0, t1 = r1, t2 = r2, t3 = r3;
+		_MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+		auto const k0 = _mm_shuffle_ps(t0, t0, _MM_SHUFFLE(2, 3, 0, 1));
+		auto const k1 = _mm_shuffle_ps(t1, t1, _MM_SHUFFLE(2, 3, 0, 1));
+		auto const k2 = _mm_shuffle_ps(t2, t2, _MM_SHUFFLE(2, 3, 0, 1));
+		auto const k3 = _mm_shuffle_ps(t3, t3, _MM_SHUFFLE(2, 3, 0, 1));
+
+		auto const combine = [](
+			__m128 u, __m128 xu, __m128 v, __m128 xv, __m128 w, __m128 xw
+		){
+			return _mm_add_ps(_mm_sub_ps(
+				_mm_mul_ps(u, xu), _mm_mul_ps(v, xv)), _mm_mul_ps(w, xw));
+		};
+
+		auto const even = _mm_setr_ps(1, -1, 1, -1);
+		auto const odd = _mm_setr_ps(-1, 1, -1, 1);
+
+		_mm_storeu_ps(b, _mm_mul_ps(even, combine(k1, x5, k2, x4, k3, x3)));
+		_mm_storeu_ps(b + 4, _mm_mul_ps(odd, combine(k0, x5, k2, x2, k3, x1)));
+		_mm_storeu_ps(b + 8, _mm_mul_ps(even, combine(k0, x4, k1, x2, k3, x0)));
+		_mm_storeu_ps(b + 12, _mm_mul_ps(odd, combine(k0, x3, k1, x1, k2, x0)));
+
+		// Row 0 of a times column 0 of the adjugate
+		return a[0] * b[0] + a[1] * b[4] + a[2] * b[8] + a[3] * b[12];
+	}
+#endif
+
+
+	/// \brief Adjugate b of the row-major N x N matrix a, returns the
+	///        determinant
+	///
+	/// Plain scalar code without branches, suitable for one matrix per
+	/// SIMD lane.
+	template < std::size_t N, typename T >
+	constexpr T closed_form_adjugate_scalar(T const* a, T* b){
+		static_assert(N >= 1 && N <= 4);
+
+		if constexpr(N == 1){
+			b[0] = T(1);
+			return a[0];
+		}else if constexpr(N == 2){
+			b[0] = a[3];
+			b[1] = -a[1];
+			b[2] = -a[2];
+			b[3] = a[0];
+			return a[0] * a[3] - a[1] * a[2];
+		}else if constexpr(N == 3){
+			b[0] = a[4] * a[8] - a[5] * a[7];
+			b[1] = a[2] * a[7] - a[1] * a[8];
+			b[2] = a[1] * a[5] - a[2] * a[4];
+			b[3] = a[5] * a[6] - a[3] * a[8];
+			b[4] = a[0] * a[8] - a[2] * a[6];
+			b[5] = a[2] * a[3] - a[0] * a[5];
+			b[6] = a[3] * a[7] - a[4] * a[6];
+			b[7] = a[1] * a[6] - a[0] * a[7];
+			b[8] = a[0] * a[4] - a[1] * a[3];
+			return a[0] * b[0] + a[1] * b[3] + a[2] * b[6];
+		}else{
+			auto const s0 = a[0] * a[5] - a[1] * a[4];
+			auto const s1 = a[0] * a[6] - a[2] * a[4];
+			auto const s2 = a[0] * a[7] - a[3] * a[4];
+			auto const s3 = a[1] * a[6] - a[2] * a[5];
+			auto const s4 = a[1] * a[7] - a[3] * a[5];
+			auto const s5 = a[2] * a[7] - a[3] * a[6];
+			auto const c5 = a[10] * a[15] - a[11] * a[14];
+			auto const c4 = a[9] * a[15] - a[11] * a[13];
+			auto const c3 = a[9] * a[14] - a[10] * a[13];
+			auto const c2 = a[8] * a[15] - a[11] * a[12];
+			auto const c1 = a[8] * a[14] - a[10] * a[12];
+			auto const c0 = a[8] * a[13] - a[9] * a[12];
+
+			b[0] = a[5] * c5 - a[6] * c4 + a[7] * c3;
+			b[1] = -a[1] * c5 + a[2] * c4 - a[3] * c3;
+			b[2] = a[13] * s5 - a[14] * s4 + a[15] * s3;
+			b[3] = -a[9] * s5 + a[10] * s4 - a[11] * s3;
+			b[4] = -a[4] * c5 + a[6] * c2 - a[7] * c1;
+			b[5] = a[0] * c5 - a[2] * c2 + a[3] * c1;
+			b[6] = -a[12] * s5 + a[14] * s2 - a[15] * s1;
+			b[7] = a[8] * s5 - a[10] * s2 + a[11] * s1;
+			b[8] = a[4] * c4 - a[5] * c2 + a[7] * c0;
+			b[9] = -a[0] * c4 + a[1] * c2 - a[3] * c0;
+			b[10] = a[12] * s4 - a[13] * s2 + a[15] * s0;
+			b[11] = -a[8] * s4 + a[9] * s2 - a[11] * s0;
+			b[12] = -a[4] * c3 + a[5] * c1 - a[6] * c0;
+			b[13] = a[0] * c3 - a[1] * c1 + a[2] * c0;
+			b[14] = -a[12] * s3 + a[13] * s1 - a[14] * s0;
+			b[15] = a[8] * s3 - a[9] * s1 + a[10] * s0;
+
+			return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		}
+	}
+
+
+	/// \brief Adjugate b of the row-major N x N matrix a, returns the
+	///        determinant
+	///
+	/// One 4 x 4 float matrix is processed with SSE if available.
+	template < std::size_t N, typename T >
+	constexpr T closed_form_adjugate(T const* a, T* b){
+#if defined(__SSE__) && defined(MITRAX_HAS_IS_CONSTANT_EVALUATED)
+		if constexpr(N == 4 && std::is_same_v< T, float >){
+			if(!__builtin_is_constant_evaluated()){
+				return adjugate4_sse(a, b);
+			}
+		}
+#endif
+
+		return closed_form_adjugate_scalar< N >(a, b);
+	}
+
+
+}
+
+
+#endif
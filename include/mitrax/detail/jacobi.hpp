@@ -0,0 +1,203 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__detail__jacobi__hpp_INCLUDED_
+#define _mitrax__detail__jacobi__hpp_INCLUDED_
+
+#include <cstddef>
+#include <cmath>
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Sweeps of the unrolled Jacobi method, enough for double
+	///        precision up to N = 4
+	template < std::size_t N >
+	constexpr std::size_t jacobi_sweeps = N <= 2 ? 1 : 6;
+
+
+	/// \brief Cosine c and sine s of the Jacobi rotation which zeros
+	///        apq
+	///
+	/// Without branches, apq == 0 gives the identity rotation.
+	template < typename T >
+	void jacobi_angle(T app, T aqq, T apq, T& c, T& s){
+		using std::abs;
+		using std::sqrt;
+
+		auto const nonzero = apq != T(0);
+		auto const theta = (aqq - app) / (nonzero ? 2 * apq : T(1));
+		auto const sign = theta < T(0) ? T(-1) : T(1);
+		auto const t0 = sign / (abs(theta) + sqrt(theta * theta + T(1)));
+		auto const t = nonzero ? t0 : T(0);
+		c = T(1) / sqrt(t * t + T(1));
+		s = t * c;
+	}
+
+
+	/// \brief Jacobi rotation which zeros a(p, q) of the symmetric
+	///        row-major N x N matrix a, accumulated in the columns of v
+	template < std::size_t N, typename T >
+	void jacobi_rotate(T* a, T* v, std::size_t p, std::size_t q){
+		T c;
+		T s;
+		jacobi_angle(a[p * N + p], a[q * N + q], a[p * N + q], c, s);
+
+		for(std::size_t k = 0; k < N; ++k){
+			auto const akp = a[k * N + p];
+			auto const akq = a[k * N + q];
+			a[k * N + p] = c * akp - s * akq;
+			a[k * N + q] = s * akp + c * akq;
+		}
+
+		for(std::size_t k = 0; k < N; ++k){
+			auto const apk = a[p * N + k];
+			auto const aqk = a[q * N + k];
+			a[p * N + k] = c * apk - s * aqk;
+			a[q * N + k] = s * apk + c * aqk;
+		}
+
+		for(std::size_t k = 0; k < N; ++k){
+			auto const vkp = v[k * N + p];
+			auto const vkq = v[k * N + q];
+			v[k * N + p] = c * vkp - s * vkq;
+			v[k * N + q] = s * vkp + c * vkq;
+		}
+	}
+
+
+	/// \brief Eigenvalues w (ascending) and eigenvectors (columns of v)
+	///        of the symmetric row-major N x N matrix a
+	///
+	/// Cyclic Jacobi method with a fixed count of sweeps and a sorting
+	/// network, no data dependent branches. a is overwritten.
+	template < std::size_t N, typename T >
+	void jacobi_eigen_unrolled(T* a, T* w, T* v){
+		for(std::size_t i = 0; i < N * N; ++i){
+			v[i] = i % (N + 1) == 0 ? T(1) : T(0);
+		}
+
+		for(std::size_t sweep = 0; sweep < jacobi_sweeps< N >; ++sweep){
+			for(std::size_t p = 0; p < N; ++p){
+				for(std::size_t q = p + 1; q < N; ++q){
+					jacobi_rotate< N >(a, v, p, q);
+				}
+			}
+		}
+
+		for(std::size_t i = 0; i < N; ++i) w[i] = a[i * N + i];
+
+		// Bubble sort network
+		for(std::size_t i = 1; i < N; ++i){
+			for(std::size_t j = 0; j + i < N; ++j){
+				auto const swap = w[j + 1] < w[j];
+				auto const wj = w[j];
+				auto const wk = w[j + 1];
+				w[j] = swap ? wk : wj;
+				w[j + 1] = swap ? wj : wk;
+				for(std::size_t k = 0; k < N; ++k){
+					auto const vj = v[k * N + j];
+					auto const vk = v[k * N + j + 1];
+					v[k * N + j] = swap ? vk : vj;
+					v[k * N + j + 1] = swap ? vj : vk;
+				}
+			}
+		}
+	}
+
+
+	/// \brief jacobi_eigen_unrolled for L matrices at once
+	///
+	/// a[k][l], w[k][l] and v[k][l] are element k of matrix l. The loops
+	/// over the lanes l are innermost and free of branches, so the
+	/// rotations and the sorting network are vectorised. The rotation
+	/// angles call sqrt, which is only vectorised without errno and
+	/// floating point traps (-fno-math-errno -fno-trapping-math).
+	template < std::size_t N, std::size_t L, typename T >
+	void jacobi_eigen_lanes(T (*a)[L], T (*w)[L], T (*v)[L]){
+		for(std::size_t i = 0; i < N * N; ++i){
+			for(std::size_t l = 0; l < L; ++l){
+				v[i][l] = i % (N + 1) == 0 ? T(1) : T(0);
+			}
+		}
+
+		auto const rotate = [](T* x, T* y, T const* c, T const* s){
+			for(std::size_t l = 0; l < L; ++l){
+				auto const xl = x[l];
+				auto const yl = y[l];
+				x[l] = c[l] * xl - s[l] * yl;
+				y[l] = s[l] * xl + c[l] * yl;
+			}
+		};
+
+		for(std::size_t sweep = 0; sweep < jacobi_sweeps< N >; ++sweep){
+			for(std::size_t p = 0; p < N; ++p){
+				for(std::size_t q = p + 1; q < N; ++q){
+					T c[L];
+					T s[L];
+					for(std::size_t l = 0; l < L; ++l){
+						jacobi_angle(a[p * N + p][l], a[q * N + q][l],
+							a[p * N + q][l], c[l], s[l]);
+					}
+
+					for(std::size_t k = 0; k < N; ++k){
+						rotate(a[k * N + p], a[k * N + q], c, s);
+					}
+					for(std::size_t k = 0; k < N; ++k){
+						rotate(a[p * N + k], a[q * N + k], c, s);
+					}
+					for(std::size_t k = 0; k < N; ++k){
+						rotate(v[k * N + p], v[k * N + q], c, s);
+					}
+				}
+			}
+		}
+
+		for(std::size_t i = 0; i < N; ++i){
+			for(std::size_t l = 0; l < L; ++l) w[i][l] = a[i * N + i][l];
+		}
+
+		// Bubble sort network
+		for(std::size_t i = 1; i < N; ++i){
+			for(std::size_t j = 0; j + i < N; ++j){
+				// Selects of T into locals before the stores are
+				// vectorised, stores of bool or inside a select are not
+				T swap[L];
+				for(std::size_t l = 0; l < L; ++l){
+					auto const wj = w[j][l];
+					auto const wk = w[j + 1][l];
+					auto const flag = wk < wj;
+					auto const low = flag ? wk : wj;
+					auto const high = flag ? wj : wk;
+					swap[l] = flag ? T(1) : T(0);
+					w[j][l] = low;
+					w[j + 1][l] = high;
+				}
+				for(std::size_t k = 0; k < N; ++k){
+					auto const x = v[k * N + j];
+					auto const y = v[k * N + j + 1];
+					for(std::size_t l = 0; l < L; ++l){
+						auto const xl = x[l];
+						auto const yl = y[l];
+						auto const flag = swap[l] != T(0);
+						auto const a = flag ? yl : xl;
+						auto const b = flag ? xl : yl;
+						x[l] = a;
+						y[l] = b;
+					}
+				}
+			}
+		}
+	}
+
+
+}
+
+
+#endif
@@ -0,0 +1,185 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__detail__parallel_for__hpp_INCLUDED_
+#define _mitrax__detail__parallel_for__hpp_INCLUDED_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Worker threads which are shared by all calls of parallel_for
+	///
+	/// Threads are started on demand, when a call needs more than exist,
+	/// and joined at program exit.
+	class thread_pool{
+	public:
+		static thread_pool& instance(){
+			static thread_pool pool;
+			return pool;
+		}
+
+
+		thread_pool(thread_pool const&) = delete;
+
+		thread_pool& operator=(thread_pool const&) = delete;
+
+		~thread_pool(){
+			{
+				std::lock_guard< std::mutex > lock(mutex_);
+				stop_ = true;
+			}
+			ready_.notify_all();
+			for(auto& thread: threads_) thread.join();
+		}
+
+
+		/// \brief Count of worker threads
+		std::size_t size(){
+			std::lock_guard< std::mutex > lock(mutex_);
+			return threads_.size();
+		}
+
+		/// \brief Start worker threads until there are at least count
+		void reserve(std::size_t count){
+			std::lock_guard< std::mutex > lock(mutex_);
+			while(threads_.size() < count){
+				threads_.emplace_back([this]{ work(); });
+			}
+		}
+
+		/// \brief Run task on a worker thread
+		void submit(std::function< void() > task){
+			{
+				std::lock_guard< std::mutex > lock(mutex_);
+				tasks_.push_back(std::move(task));
+			}
+			ready_.notify_one();
+		}
+
+
+	private:
+		thread_pool() = default;
+
+		void work(){
+			for(;;){
+				std::function< void() > task;
+				{
+					std::unique_lock< std::mutex > lock(mutex_);
+					ready_.wait(lock, [this]{
+						return stop_ || !tasks_.empty();
+					});
+					if(tasks_.empty()) return;
+					task = std::move(tasks_.front());
+					tasks_.pop_front();
+				}
+				task();
+			}
+		}
+
+
+		std::mutex mutex_;
+		std::condition_variable ready_;
+		std::deque< std::function< void() > > tasks_;
+		std::vector< std::thread > threads_;
+		bool stop_ = false;
+	};
+
+
+	/// \brief State of one parallel_for, shared with its pool tasks
+	struct parallel_for_state{
+		std::atomic< std::size_t > next{0};
+
+		std::mutex mutex;
+		std::condition_variable done;
+
+		/// \brief No task may join after the caller finished its part
+		bool closed = false;
+
+		/// \brief Count of tasks which joined and did not finish yet
+		std::size_t active = 0;
+
+		std::exception_ptr error;
+	};
+
+
+	/// \brief Call f(i) for all i in [0, count) on up to threads threads
+	///
+	/// threads == 0 uses the hardware concurrency. The calling thread
+	/// takes part in the work, the others come from thread_pool, so no
+	/// thread is created per call. Tasks which did not start before the
+	/// calling thread ran out of work are skipped, which also makes
+	/// nested calls safe. The first exception is rethrown after all
+	/// started tasks finished.
+	template < typename F >
+	void parallel_for(std::size_t count, std::size_t threads, F const& f){
+		if(threads == 0){
+			threads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		threads = std::min(threads, count);
+
+		if(threads <= 1){
+			for(std::size_t i = 0; i < count; ++i) f(i);
+			return;
+		}
+
+		auto& pool = thread_pool::instance();
+		pool.reserve(threads - 1);
+
+		auto const state = std::make_shared< parallel_for_state >();
+		auto const worker = [&state = *state, count, &f]{
+			try{
+				for(std::size_t i; (i = state.next++) < count;) f(i);
+			}catch(...){
+				state.next = count;
+				std::lock_guard< std::mutex > lock(state.mutex);
+				if(!state.error) state.error = std::current_exception();
+			}
+		};
+
+		for(std::size_t i = 1; i < threads; ++i){
+			pool.submit([state, &worker]{
+				{
+					std::lock_guard< std::mutex > lock(state->mutex);
+					if(state->closed) return;
+					++state->active;
+				}
+
+				worker();
+
+				std::lock_guard< std::mutex > lock(state->mutex);
+				if(--state->active == 0) state->done.notify_all();
+			});
+		}
+
+		worker();
+
+		std::unique_lock< std::mutex > lock(state->mutex);
+		state->closed = true;
+		state->done.wait(lock, [&state]{ return state->active == 0; });
+
+		if(state->error) std::rethrow_exception(state->error);
+	}
+
+
+}
+
+
+#endif
@@ -0,0 +1,354 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__dual__hpp_INCLUDED_
+#define _mitrax__dual__hpp_INCLUDED_
+
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <cmath>
+
+
+namespace mitrax{
+
+
+	/// \brief Dual number with N derivative directions (jet) for forward
+	///        mode automatic differentiation
+	///
+	/// Holds a value and its partial derivatives with respect to N
+	/// variables. Arithmetic and the math functions of this header apply
+	/// the chain rule, so evaluating a generic function with dual
+	/// arguments yields its value and gradient in one pass. Call the math
+	/// functions unqualified (using std::sqrt; sqrt(x);) to find them.
+	template < typename T, std::size_t N >
+	class dual{
+	public:
+		/// \brief Type of the value and the derivatives
+		using value_type = T;
+
+		/// \brief Type of the derivatives
+		using gradient_type = std::array< T, N >;
+
+
+		/// \brief Constructs a dual with value 0
+		constexpr dual(): value_(), gradient_() {}
+
+		/// \brief Constructs a constant, all derivatives are 0
+		constexpr dual(value_type const& value): value_(value), gradient_() {}
+
+		constexpr dual(value_type const& value, gradient_type const& gradient):
+			value_(value), gradient_(gradient) {}
+
+		constexpr dual(dual const&) = default;
+
+		constexpr dual(dual&&) = default;
+
+
+		constexpr dual& operator=(dual const&) = default;
+
+		constexpr dual& operator=(dual&&) = default;
+
+
+		/// \brief Variable i, its derivative in direction i is 1
+		static constexpr dual variable(value_type const& value, std::size_t i){
+			dual result(value);
+			result.gradient_[i] = value_type(1);
+			return result;
+		}
+
+
+		/// \brief The value
+		constexpr value_type const& value()const{ return value_; }
+
+		/// \brief The partial derivatives
+		constexpr gradient_type const& gradient()const{ return gradient_; }
+
+
+		constexpr dual& operator+=(dual const& v){
+			value_ += v.value_;
+			for(std::size_t i = 0; i < N; ++i) gradient_[i] += v.gradient_[i];
+			return *this;
+		}
+
+		constexpr dual& operator-=(dual const& v){
+			value_ -= v.value_;
+			for(std::size_t i = 0; i < N; ++i) gradient_[i] -= v.gradient_[i];
+			return *this;
+		}
+
+		constexpr dual& operator*=(dual const& v){
+			for(std::size_t i = 0; i < N; ++i){
+				gradient_[i] =
+					gradient_[i] * v.value_ + value_ * v.gradient_[i];
+			}
+			value_ *= v.value_;
+			return *this;
+		}
+
+		constexpr dual& operator/=(dual const& v){
+			value_ /= v.value_;
+			for(std::size_t i = 0; i < N; ++i){
+				gradient_[i] =
+					(gradient_[i] - value_ * v.gradient_[i]) / v.value_;
+			}
+			return *this;
+		}
+
+		constexpr dual& operator+=(value_type const& v){
+			value_ += v;
+			return *this;
+		}
+
+		constexpr dual& operator-=(value_type const& v){
+			value_ -= v;
+			return *this;
+		}
+
+		constexpr dual& operator*=(value_type const& v){
+			value_ *= v;
+			for(auto& d: gradient_) d *= v;
+			return *this;
+		}
+
+		constexpr dual& operator/=(value_type const& v){
+			value_ /= v;
+			for(auto& d: gradient_) d /= v;
+			return *this;
+		}
+
+
+		friend constexpr dual operator+(dual const& v){
+			return v;
+		}
+
+		friend constexpr dual operator-(dual v){
+			v.value_ = -v.value_;
+			for(auto& d: v.gradient_) d = -d;
+			return v;
+		}
+
+
+		friend constexpr dual operator+(dual a, dual const& b){
+			return a += b;
+		}
+
+		friend constexpr dual operator+(dual a, value_type const& b){
+			return a += b;
+		}
+
+		friend constexpr dual operator+(value_type const& a, dual b){
+			return b += a;
+		}
+
+		friend constexpr dual operator-(dual a, dual const& b){
+			return a -= b;
+		}
+
+		friend constexpr dual operator-(dual a, value_type const& b){
+			return a -= b;
+		}
+
+		friend constexpr dual operator-(value_type const& a, dual const& b){
+			return -b += a;
+		}
+
+		friend constexpr dual operator*(dual a, dual const& b){
+			return a *= b;
+		}
+
+		friend constexpr dual operator*(dual a, value_type const& b){
+			return a *= b;
+		}
+
+		friend constexpr dual operator*(value_type const& a, dual b){
+			return b *= a;
+		}
+
+		friend constexpr dual operator/(dual a, dual const& b){
+			return a /= b;
+		}
+
+		friend constexpr dual operator/(dual a, value_type const& b){
+			return a /= b;
+		}
+
+		friend constexpr dual operator/(value_type const& a, dual const& b){
+			return dual(a) /= b;
+		}
+
+
+		/// \brief Comparisons use only the values
+		friend constexpr bool operator==(dual const& a, dual const& b){
+			return a.value_ == b.value_;
+		}
+
+		friend constexpr bool operator!=(dual const& a, dual const& b){
+			return a.value_ != b.value_;
+		}
+
+		friend constexpr bool operator<(dual const& a, dual const& b){
+			return a.value_ < b.value_;
+		}
+
+		friend constexpr bool operator>(dual const& a, dual const& b){
+			return a.value_ > b.value_;
+		}
+
+		friend constexpr bool operator<=(dual const& a, dual const& b){
+			return a.value_ <= b.value_;
+		}
+
+		friend constexpr bool operator>=(dual const& a, dual const& b){
+			return a.value_ >= b.value_;
+		}
+
+
+	private:
+		value_type value_;
+		gradient_type gradient_;
+	};
+
+
+	template < typename T, std::size_t N >
+	std::ostream& operator<<(std::ostream& os, dual< T, N > const& v){
+		os << v.value() << "[";
+		for(std::size_t i = 0; i < N; ++i){
+			os << (i == 0 ? "" : ", ") << v.gradient()[i];
+		}
+		return os << "]";
+	}
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief f(x) with f'(x) = derivative by the chain rule
+	template < typename T, std::size_t N >
+	constexpr dual< T, N > dual_chain(
+		dual< T, N > const& x, T const& value, T const& derivative
+	){
+		auto gradient = x.gradient();
+		for(auto& d: gradient) d *= derivative;
+		return {value, gradient};
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	template < typename T, std::size_t N >
+	dual< T, N > abs(dual< T, N > const& x){
+		return x.value() < T(0) ? -x : x;
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > sqrt(dual< T, N > const& x){
+		using std::sqrt;
+		auto const v = sqrt(x.value());
+		return detail::dual_chain(x, v, T(1) / (T(2) * v));
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > exp(dual< T, N > const& x){
+		using std::exp;
+		auto const v = exp(x.value());
+		return detail::dual_chain(x, v, v);
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > log(dual< T, N > const& x){
+		using std::log;
+		return detail::dual_chain(x, log(x.value()), T(1) / x.value());
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > pow(
+		dual< T, N > const& x,
+		typename dual< T, N >::value_type const& p
+	){
+		using std::pow;
+		return detail::dual_chain(x, pow(x.value(), p),
+			p * pow(x.value(), p - T(1)));
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > pow(dual< T, N > const& x, dual< T, N > const& p){
+		return exp(p * log(x));
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > sin(dual< T, N > const& x){
+		using std::sin;
+		using std::cos;
+		return detail::dual_chain(x, sin(x.value()), cos(x.value()));
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > cos(dual< T, N > const& x){
+		using std::sin;
+		using std::cos;
+		return detail::dual_chain(x, cos(x.value()), -sin(x.value()));
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > tan(dual< T, N > const& x){
+		using std::tan;
+		auto const v = tan(x.value());
+		return detail::dual_chain(x, v, T(1) + v * v);
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > asin(dual< T, N > const& x){
+		using std::asin;
+		using std::sqrt;
+		auto const v = x.value();
+		return detail::dual_chain(x, asin(v), T(1) / sqrt(T(1) - v * v));
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > acos(dual< T, N > const& x){
+		using std::acos;
+		using std::sqrt;
+		auto const v = x.value();
+		return detail::dual_chain(x, acos(v), T(-1) / sqrt(T(1) - v * v));
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > atan(dual< T, N > const& x){
+		using std::atan;
+		auto const v = x.value();
+		return detail::dual_chain(x, atan(v), T(1) / (T(1) + v * v));
+	}
+
+	template < typename T, std::size_t N >
+	dual< T, N > atan2(dual< T, N > const& y, dual< T, N > const& x){
+		using std::atan2;
+		auto const yv = y.value();
+		auto const xv = x.value();
+		auto const square = xv * xv + yv * yv;
+
+		auto gradient = y.gradient();
+		for(std::size_t i = 0; i < N; ++i){
+			gradient[i] = (xv * y.gradient()[i] - yv * x.gradient()[i]) /
+				square;
+		}
+		return {atan2(yv, xv), gradient};
+	}
+
+
+}
+
+
+#endif
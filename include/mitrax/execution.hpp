@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__execution__hpp_INCLUDED_
+#define _mitrax__execution__hpp_INCLUDED_
+
+#include "detail/parallel_for.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+
+namespace mitrax::execution{
+
+
+	/// \brief Evaluate everything in the calling thread
+	struct sequenced_policy{};
+
+	/// \brief Evaluate in parallel chunks
+	struct parallel_policy{
+		/// \brief Count of threads, 0 for the hardware concurrency
+		std::size_t threads = 0;
+	};
+
+
+	inline constexpr sequenced_policy seq{};
+
+	inline constexpr parallel_policy par{};
+
+
+	template < typename T >
+	struct is_execution_policy: std::false_type{};
+
+	template <>
+	struct is_execution_policy< sequenced_policy >: std::true_type{};
+
+	template <>
+	struct is_execution_policy< parallel_policy >: std::true_type{};
+
+	template < typename T >
+	constexpr bool is_execution_policy_v =
+		is_execution_policy< std::decay_t< T > >::value;
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	constexpr std::size_t execution_threads(execution::sequenced_policy){
+		return 1;
+	}
+
+	constexpr std::size_t execution_threads(
+		execution::parallel_policy const& policy
+	){
+		return policy.threads;
+	}
+
+
+	/// \brief Call f(k, begin, end) for the chunks k of [0, count) with
+	///        chunk_size elements each
+	///
+	/// The chunks do not depend on the policy, so results which are
+	/// reduced in chunk order do not depend on the count of threads.
+	template < typename Policy, typename F >
+	void execution_for_chunks(
+		Policy const& policy, std::size_t count, std::size_t chunk_size,
+		F const& f
+	){
+		auto const chunks = (count + chunk_size - 1) / chunk_size;
+		parallel_for(chunks, execution_threads(policy),
+			[count, chunk_size, &f](std::size_t k){
+				f(k, k * chunk_size, std::min((k + 1) * chunk_size, count));
+			});
+	}
+
+
+}
+
+
+#endif
@@ -10,6 +10,7 @@
 #define _mitrax__for_each__hpp_INCLUDED_
 
 #include "sub_matrix.hpp"
+#include "layout.hpp"
 
 // TODO: Unit-Tests!!!
 
@@ -17,13 +18,25 @@
 namespace mitrax{
 
 
+	/// \brief Call f for all points, in storage order if all images share
+	///        the same layout, row-wise otherwise
 	template < typename F, typename ... M, col_t ... C, row_t ... R >
 	constexpr void for_each(F&& f, matrix< M, C, R > const& ... images){
 		auto size = get_dims(images ...);
-		for(auto r = 0_r; r < size.rows(); ++r){
-			for(auto c = 0_c; c < size.cols(); ++c){
-				f(images(c, r) ...);
+
+		using layout_type = layout_t< M ... >;
+		if constexpr(std::is_same_v< layout_type, layout::row_major >){
+			for(auto r = 0_r; r < size.rows(); ++r){
+				for(auto c = 0_c; c < size.cols(); ++c){
+					f(images(c, r) ...);
+				}
 			}
+		}else{
+			layout_type::traverse(size_t(size.cols()), size_t(size.rows()),
+				[&](size_t c, size_t r){
+					f(images(c_t(c), r_t(r)) ...);
+					return true;
+				});
 		}
 	}
 
@@ -10,153 +10,976 @@
 #define _mitrax__gauss_newton_algorithm__hpp_INCLUDED_
 
 #include "make_matrix.hpp"
-#include "gaussian_elimination.hpp"
+#include "cholesky_decomposition.hpp"
+#include "least_squares.hpp"
 #include "operator.hpp"
 #include "norm.hpp"
-
-#include "io/matrix.hpp"
+#include "dual.hpp"
+#include "execution.hpp"
+#include "column_data.hpp"
 
 #include <boost/container/vector.hpp>
 
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace mitrax{
+
+
+	/// \brief Model function whose Jacobians are calculated by forward
+	///        mode automatic differentiation in the solvers
+	///
+	/// The wrapped function must be generic in its parameter vector, see
+	/// forward_jacobian.
+	template < typename F >
+	class auto_differentiated{
+	public:
+		constexpr explicit auto_differentiated(F const& f): f_(f) {}
+
+		constexpr explicit auto_differentiated(F&& f): f_(std::move(f)) {}
+
+
+		template < typename ... Args >
+		constexpr decltype(auto) operator()(Args&& ... args)const{
+			return f_(static_cast< Args&& >(args) ...);
+		}
+
+
+	private:
+		F f_;
+	};
+
+	template < typename F >
+	constexpr auto auto_differentiate(F&& f){
+		return auto_differentiated< std::decay_t< F > >(
+			static_cast< F&& >(f));
+	}
+
+
+	/// \brief Model function which evaluates a block of data points per
+	///        call
+	///
+	/// The wrapped function is called as f(arg, data, begin, end, r) and
+	/// stores the residuals of data[begin] to data[end - 1] at arg in
+	/// r[0] to r[end - begin - 1]. With column_data it can read the
+	/// columns directly and evaluate the block with SIMD instructions. The
+	/// Jacobians are forward differences of whole blocks.
+	template < typename F >
+	class block_evaluated{
+	public:
+		constexpr explicit block_evaluated(F const& f): f_(f) {}
+
+		constexpr explicit block_evaluated(F&& f): f_(std::move(f)) {}
+
+
+		template < typename ... Args >
+		constexpr decltype(auto) operator()(Args&& ... args)const{
+			return f_(static_cast< Args&& >(args) ...);
+		}
+
+
+	private:
+		F f_;
+	};
+
+	template < typename F >
+	constexpr auto block_evaluate(F&& f){
+		return block_evaluated< std::decay_t< F > >(static_cast< F&& >(f));
+	}
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	template < typename F >
+	struct is_auto_differentiated: std::false_type{};
+
+	template < typename F >
+	struct is_auto_differentiated< auto_differentiated< F > >:
+		std::true_type{};
+
+	template < typename F >
+	constexpr bool is_auto_differentiated_v =
+		is_auto_differentiated< std::decay_t< F > >::value;
+
+
+	template < typename F >
+	struct is_block_evaluated: std::false_type{};
+
+	template < typename F >
+	struct is_block_evaluated< block_evaluated< F > >: std::true_type{};
+
+	template < typename F >
+	constexpr bool is_block_evaluated_v =
+		is_block_evaluated< std::decay_t< F > >::value;
+
+
+	/// \brief Count of data points of a block on the stack
+	constexpr size_t nonlinear_block_rows = 64;
+
+
+	/// \brief Count of data points of a random access range
+	template < typename Data >
+	size_t data_size(Data const& data){
+		return size_t(std::size(data));
+	}
+
+
+	/// \brief r[i - begin] = f(arg, data[i]) for all i in [begin, end)
+	template < typename F, typename M, row_t R, typename Data, typename T >
+	void evaluate_residuals(
+		F const& f,
+		col_vector< M, R > const& arg,
+		Data const& data,
+		size_t begin,
+		size_t end,
+		T* r
+	){
+		if constexpr(is_block_evaluated_v< F >){
+			f(arg, data, begin, end, r);
+		}else{
+			for(auto i = begin; i < end; ++i) r[i - begin] = f(arg, data[i]);
+		}
+	}
+
+	/// \brief Vector of the residuals f(arg, data[i])
+	template < typename F, typename M, row_t R, typename Data >
+	auto residuals(
+		F const& f,
+		col_vector< M, R > const& arg,
+		Data const& data
+	){
+		auto const count = data_size(data);
+		auto r = make_vector_v< value_type_t< M > >(rows(row_t(count)));
+		evaluate_residuals(f, arg, data, 0, count, r.data());
+		return r;
+	}
+
+
+}
 
 
 namespace mitrax{
 
 
-	template < typename F, typename M, row_t R, typename T, typename ... V >
+	/// \brief Forward difference Jacobian of f(arg, data[i]) at arg
+	///
+	/// r holds the residuals f(arg, data[i]) and is reused for all
+	/// columns. Every parameter is perturbed by step once and the
+	/// residuals of the perturbation are evaluated in one pass, so f is
+	/// called cols * rows times. A block_evaluated f is called once per
+	/// column.
+	template <
+		typename F, typename M, row_t R, typename MR, row_t RR,
+		typename T, typename Data >
+	auto finite_difference_jacobian(
+		F&& f,
+		col_vector< M, R > const& arg,
+		col_vector< MR, RR > const& r,
+		Data const& data,
+		T const& step
+	){
+		auto const count = detail::data_size(data);
+		if(size_t(r.rows()) != count){
+			throw std::logic_error(
+				"finite_difference_jacobian: incompatible dimensions");
+		}
+
+		auto d = make_matrix_v< value_type_t< MR > >(
+			dim_pair(arg.rows().as_col(), r.rows()));
+
+		auto arg1 = arg;
+		for(auto c = 0_c; c < d.cols(); ++c){
+			auto const i = d_t(c);
+			arg1[i] += step;
+			if constexpr(detail::is_block_evaluated_v< F >){
+				auto const r1 = detail::residuals(f, arg1, data);
+				for(auto y = 0_r; y < d.rows(); ++y){
+					d(c, y) = (r1[d_t(y)] - r[d_t(y)]) / step;
+				}
+			}else{
+				for(auto y = 0_r; y < d.rows(); ++y){
+					d(c, y) = (f(arg1, data[size_t(y)]) - r[d_t(y)]) / step;
+				}
+			}
+			arg1[i] = arg[i];
+		}
+
+		return d;
+	}
+
+	/// \brief Residuals f(arg, data[i]) and their exact Jacobian by
+	///        forward mode automatic differentiation
+	///
+	/// f is called with a column vector of dual< T, N > parameters, N is
+	/// the compile time count of parameters. One call per data point
+	/// yields the residual and its whole Jacobian row.
+	template < typename F, typename M, row_t R, typename Data >
+	auto forward_jacobian(
+		F&& f,
+		col_vector< M, R > const& arg,
+		Data const& data
+	){
+		static_assert(R != 0_R, "forward_jacobian needs a compile time "
+			"count of parameters");
+
+		using value_type = value_type_t< M >;
+		using dual_type = dual< value_type, size_t(R) >;
+
+		auto const x = make_vector_fn(arg.rows(), [&arg](size_t i){
+			return dual_type::variable(arg[d_t(i)], i);
+		});
+
+		auto const rows = mitrax::rows(row_t(detail::data_size(data)));
+		auto r = make_vector_v< value_type >(rows);
+		auto d = make_matrix_v< value_type >(
+			dim_pair(arg.rows().as_col(), rows));
+		for(auto y = 0_r; y < d.rows(); ++y){
+			dual_type const v = f(x, data[size_t(y)]);
+			r[d_t(y)] = v.value();
+			for(auto c = 0_c; c < d.cols(); ++c){
+				d(c, y) = v.gradient()[size_t(c)];
+			}
+		}
+
+		return std::make_pair(std::move(r), std::move(d));
+	}
+
+
+	/// \brief Normal equations J^T * J * s = -J^T * r of a least squares
+	///        problem and its cost r^T * r
+	template < typename T, dim_t D >
+	struct normal_equations{
+		std_square_matrix< T, D > jtj;
+		std_col_vector< T, row_t(D) > jtr;
+		T cost;
+	};
+
+
+	struct nonlinear_options{
+		/// \brief Maximal count of iterations, 0 for no limit
+		size_t max_iterations = 0;
+
+		/// \brief Stop after the iteration which exceeds this time, 0 for
+		///        no limit
+		std::chrono::nanoseconds time_budget{0};
+	};
+
+
+	/// \brief Progress after an iteration of a nonlinear least squares
+	///        solver
+	///
+	/// The times belong to this iteration. Residuals which are evaluated
+	/// together with the Jacobian count to jacobian_time.
+	template < typename T >
+	struct nonlinear_iteration{
+		/// \brief Count of finished iterations
+		size_t iteration;
+
+		/// \brief Euclidean norm of the step
+		T step_norm;
+
+		/// \brief Sum of the squared residuals before the step
+		T cost;
+
+		/// \brief Damping of the Levenberg-Marquardt algorithm after the
+		///        step, 0 for the Gauss-Newton algorithm
+		T mu;
+
+		std::chrono::nanoseconds residual_time;
+		std::chrono::nanoseconds jacobian_time;
+		std::chrono::nanoseconds solve_time;
+
+		/// \brief Time since the start of the solver
+		std::chrono::nanoseconds elapsed;
+	};
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Default observer, never stops
+	struct ignore_iteration{
+		template < typename State >
+		constexpr bool operator()(State const&)const noexcept{
+			return true;
+		}
+	};
+
+
+	/// \brief Count of damping increases in one Levenberg-Marquardt
+	///        iteration before the solver gives up
+	constexpr size_t max_damping_increases = 64;
+
+
+	/// \brief Sum of the diagonal of a square matrix
+	template < typename M, col_t C, row_t R >
+	auto diagonal_sum(matrix< M, C, R > const& m){
+		auto sum = value_type_t< M >(0);
+		for(size_t i = 0; i < size_t(m.rows()); ++i){
+			sum += m(c_t(i), r_t(i));
+		}
+		return sum;
+	}
+
+
+	/// \brief Double the damping mu of a Levenberg-Marquardt iteration
+	///
+	/// mu^2 starts from epsilon * trace, so even mu = 0 makes a positive
+	/// semi-definite J^T * J with trace positive definite. Throws
+	/// std::logic_error after max_damping_increases calls of one
+	/// iteration.
+	template < typename T >
+	T increase_damping(T mu, T trace, size_t& increases){
+		using std::sqrt;
+
+		if(++increases > max_damping_increases){
+			throw std::logic_error(
+				"levenberg_marquardt_algorithm without a step which "
+				"reduces the cost");
+		}
+
+		auto const floor = sqrt(std::numeric_limits< T >::epsilon() *
+			(trace > T(0) ? trace : T(1)));
+		return std::max(mu * 2, floor);
+	}
+
+
+	/// \brief Call f() and add its duration to time
+	template < typename F >
+	auto timed(std::chrono::nanoseconds& time, F&& f){
+		auto const start = std::chrono::steady_clock::now();
+		auto result = f();
+		time += std::chrono::duration_cast< std::chrono::nanoseconds >(
+			std::chrono::steady_clock::now() - start);
+		return result;
+	}
+
+	/// \brief false if observer(state) or the options stop the solver
+	///
+	/// The observer may return void to never stop.
+	template < typename O, typename T >
+	bool continue_iteration(
+		O& observer,
+		nonlinear_iteration< T > const& state,
+		nonlinear_options const& options
+	){
+		if constexpr(std::is_void_v< decltype(observer(state)) >){
+			observer(state);
+		}else{
+			if(!observer(state)) return false;
+		}
+
+		if(
+			options.max_iterations > 0 &&
+			state.iteration >= options.max_iterations
+		) return false;
+
+		return options.time_budget.count() <= 0 ||
+			state.elapsed < options.time_budget;
+	}
+
+
+	/// \brief Residuals and Jacobian at arg, the times are added to
+	///        state
+	template < typename F, typename M, row_t R, typename Data, typename T,
+		typename S >
+	auto residuals_and_jacobian(
+		F&& f,
+		col_vector< M, R > const& arg,
+		Data const& data,
+		T const& step,
+		nonlinear_iteration< S >& state
+	){
+		if constexpr(is_auto_differentiated_v< F >){
+			return timed(state.jacobian_time, [&]{
+				return forward_jacobian(f, arg, data);
+			});
+		}else{
+			auto r = timed(state.residual_time, [&]{
+				return residuals(f, arg, data);
+			});
+			auto d = timed(state.jacobian_time, [&]{
+				return finite_difference_jacobian(f, arg, r, data, step);
+			});
+			return std::make_pair(std::move(r), std::move(d));
+		}
+	}
+
+
+	/// \brief Count of data points of a parallel task
+	constexpr size_t nonlinear_chunk_rows = 1024;
+
+
+	/// \brief Zero initialized std::array< T, N > or for N == 0
+	///        std::vector< T > with n elements
+	template < typename T, size_t N >
+	auto make_nonlinear_buffer([[maybe_unused]] size_t n){
+		if constexpr(N != 0){
+			return std::array< T, N >{};
+		}else{
+			return std::vector< T >(n, T(0));
+		}
+	}
+
+
+	/// \brief Callable row(datum, j) which returns the residual of datum
+	///        at arg and stores its Jacobian row in j
+	///
+	/// Every task needs its own row evaluator.
+	template < typename F, typename M, row_t R, typename T >
+	auto make_row_evaluator(
+		F const& f, col_vector< M, R > const& arg, T const& step
+	){
+		using value_type = value_type_t< M >;
+
+		if constexpr(is_auto_differentiated_v< F >){
+			static_assert(R != 0_R, "automatic differentiation needs a "
+				"compile time count of parameters");
+
+			using dual_type = dual< value_type, size_t(R) >;
+			auto x = make_vector_fn(arg.rows(), [&arg](size_t i){
+				return dual_type::variable(arg[d_t(i)], i);
+			});
+
+			return [&f, x = std::move(x)](
+				auto const& datum, value_type* j
+			){
+				dual_type const v = f(x, datum);
+				std::copy(v.gradient().begin(), v.gradient().end(), j);
+				return v.value();
+			};
+		}else{
+			return [&f, &arg, arg1 = arg, step](
+				auto const& datum, value_type* j
+			)mutable{
+				value_type const r = f(arg, datum);
+				for(auto i = 0_d; i < arg.rows().as_dim(); ++i){
+					arg1[i] += step;
+					j[size_t(i)] = (f(arg1, datum) - r) / step;
+					arg1[i] = arg[i];
+				}
+				return r;
+			};
+		}
+	}
+
+
+	/// \brief Add the upper triangle of J^T * J, J^T * r and r^T * r of
+	///        the data points [begin, end) to sum
+	///
+	/// sum has n * n + n + 1 elements for n parameters. A block_evaluated
+	/// f gets blocks of nonlinear_block_rows data points, the sums are
+	/// the same as for a function of single data points.
+	template < typename F, typename M, row_t R, typename Data, typename T >
+	void accumulate_normal_rows(
+		F const& f,
+		col_vector< M, R > const& arg,
+		Data const& data,
+		size_t begin,
+		size_t end,
+		T const& step,
+		value_type_t< M >* sum
+	){
+		using value_type = value_type_t< M >;
+		constexpr auto p = size_t(R);
+
+		auto const n = size_t(arg.rows());
+		auto const jtj = sum;
+		auto const jtr = jtj + n * n;
+		auto& cost = jtr[n];
+
+		auto const add = [&](value_type const r, auto const& j){
+			for(size_t a = 0; a < n; ++a){
+				for(size_t b = a; b < n; ++b){
+					jtj[a * n + b] += j(a) * j(b);
+				}
+				jtr[a] += j(a) * r;
+			}
+			cost += r * r;
+		};
+
+		if constexpr(is_block_evaluated_v< F >){
+			constexpr auto rows = nonlinear_block_rows;
+
+			// Forward differences of whole blocks, column by column
+			value_type r[rows];
+			value_type r1[rows];
+			auto j = make_nonlinear_buffer< value_type, p * rows >(n * rows);
+			auto arg1 = arg;
+			for(auto i = begin; i < end; i += rows){
+				auto const m = std::min(rows, end - i);
+				f(arg, data, i, i + m, r);
+				for(auto a = 0_d; a < arg.rows().as_dim(); ++a){
+					arg1[a] += step;
+					f(arg1, data, i, i + m, r1);
+					arg1[a] = arg[a];
+
+					auto const ja = j.data() + size_t(a) * rows;
+					for(size_t k = 0; k < m; ++k){
+						ja[k] = (r1[k] - r[k]) / step;
+					}
+				}
+
+				for(size_t k = 0; k < m; ++k){
+					add(r[k], [&j, k](size_t a){ return j[a * rows + k]; });
+				}
+			}
+		}else{
+			auto row = make_row_evaluator(f, arg, step);
+			auto j = make_nonlinear_buffer< value_type, p >(n);
+			for(auto i = begin; i < end; ++i){
+				auto const r = row(data[i], j.data());
+				add(r, [&j](size_t a){ return j[a]; });
+			}
+		}
+	}
+
+	/// \brief Sum of the squared residuals of the data points
+	///        [begin, end) in order
+	template < typename F, typename M, row_t R, typename Data >
+	auto residual_sum(
+		F const& f,
+		col_vector< M, R > const& arg,
+		Data const& data,
+		size_t begin,
+		size_t end
+	){
+		using value_type = value_type_t< M >;
+
+		auto sum = value_type(0);
+		if constexpr(is_block_evaluated_v< F >){
+			constexpr auto rows = nonlinear_block_rows;
+
+			value_type r[rows];
+			for(auto i = begin; i < end; i += rows){
+				auto const m = std::min(rows, end - i);
+				f(arg, data, i, i + m, r);
+				for(size_t k = 0; k < m; ++k) sum += r[k] * r[k];
+			}
+		}else{
+			for(auto i = begin; i < end; ++i){
+				value_type const r = f(arg, data[i]);
+				sum += r * r;
+			}
+		}
+		return sum;
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief J^T * J, J^T * r and r^T * r of f(arg, data[i])
+	///
+	/// data is a random access range like std::vector or column_data.
+	/// The data points are processed in chunks by policy. Every chunk
+	/// accumulates its own partial sums row by row, which are reduced in
+	/// chunk order afterwards, so the result does not depend on the
+	/// policy. The Jacobian itself is never stored. Its rows come from
+	/// forward differences with step or from automatic differentiation
+	/// if f is auto_differentiated.
+	///
+	/// With a compile time count of parameters and execution::seq no heap
+	/// memory is used.
+	template < typename Policy, typename F, typename M, row_t R,
+		typename Data, typename T >
+	auto accumulate_normal_equations(
+		Policy const& policy,
+		F const& f,
+		col_vector< M, R > const& arg,
+		Data const& data,
+		T const& step
+	){
+		using value_type = value_type_t< M >;
+		constexpr auto dim = dim_t(R);
+		constexpr auto p = size_t(R);
+
+		auto const n = size_t(arg.rows());
+		auto const count = detail::data_size(data);
+		auto const chunks = (count + detail::nonlinear_chunk_rows - 1) /
+			detail::nonlinear_chunk_rows;
+
+		// Upper triangle of J^T * J, J^T * r and r^T * r
+		auto const stride = n * n + n + 1;
+		auto const accumulate = [&](size_t begin, size_t end, auto sum){
+			detail::accumulate_normal_rows(
+				f, arg, data, begin, end, step, sum);
+		};
+
+		auto sum = detail::make_nonlinear_buffer< value_type,
+			p != 0 ? p * p + p + 1 : 0 >(stride);
+		if constexpr(
+			std::is_same_v< Policy, execution::sequenced_policy >
+		){
+			(void)policy;
+			auto part = sum;
+			for(size_t k = 0; k < chunks; ++k){
+				std::fill(part.begin(), part.end(), value_type(0));
+				auto const begin = k * detail::nonlinear_chunk_rows;
+				accumulate(begin, std::min(
+					begin + detail::nonlinear_chunk_rows, count), part.data());
+				for(size_t i = 0; i < stride; ++i) sum[i] += part[i];
+			}
+		}else{
+			std::vector< value_type > partial(chunks * stride, value_type(0));
+
+			detail::execution_for_chunks(policy, count,
+				detail::nonlinear_chunk_rows,
+				[&](size_t k, size_t begin, size_t end){
+					accumulate(begin, end, partial.data() + k * stride);
+				});
+
+			for(size_t k = 0; k < chunks; ++k){
+				auto const src = partial.data() + k * stride;
+				for(size_t i = 0; i < stride; ++i) sum[i] += src[i];
+			}
+		}
+
+		auto const d = dim_pair(arg.rows().as_col(), arg.rows());
+		auto jtj = make_matrix_fn(d, [&sum, n](c_t c, r_t r){
+			auto const a = std::min(size_t(c), size_t(r));
+			auto const b = std::max(size_t(c), size_t(r));
+			return sum[a * n + b];
+		});
+		auto jtr = make_vector_fn(arg.rows(), [&sum, n](size_t i){
+			return sum[n * n + i];
+		});
+
+		return normal_equations< value_type, dim >{
+			std::move(jtj), std::move(jtr), sum[n * n + n]};
+	}
+
+	/// \brief Sum of the squared residuals f(arg, data[i]), reduced in
+	///        chunk order
+	template < typename Policy, typename F, typename M, row_t R,
+		typename Data >
+	auto residual_cost(
+		Policy const& policy,
+		F const& f,
+		col_vector< M, R > const& arg,
+		Data const& data
+	){
+		using value_type = value_type_t< M >;
+
+		auto const count = detail::data_size(data);
+		auto const chunks = (count + detail::nonlinear_chunk_rows - 1) /
+			detail::nonlinear_chunk_rows;
+
+		auto const accumulate = [&](size_t begin, size_t end){
+			return detail::residual_sum(f, arg, data, begin, end);
+		};
+
+		auto cost = value_type(0);
+		if constexpr(
+			std::is_same_v< Policy, execution::sequenced_policy >
+		){
+			(void)policy;
+			for(size_t k = 0; k < chunks; ++k){
+				auto const begin = k * detail::nonlinear_chunk_rows;
+				cost += accumulate(begin,
+					std::min(begin + detail::nonlinear_chunk_rows, count));
+			}
+		}else{
+			std::vector< value_type > partial(chunks, value_type(0));
+
+			detail::execution_for_chunks(policy, count,
+				detail::nonlinear_chunk_rows,
+				[&](size_t k, size_t begin, size_t end){
+					partial[k] = accumulate(begin, end);
+				});
+
+			for(auto const v: partial) cost += v;
+		}
+
+		return cost;
+	}
+
+
+	/// \brief Gauss-Newton algorithm on the normal equations, the data
+	///        points are evaluated by policy
+	///
+	/// See accumulate_normal_equations, stops like gauss_newton_algorithm.
+	/// The residuals are part of jacobian_time. Throws std::logic_error if
+	/// J^T * J is singular.
+	template < typename Policy, typename F, typename M, row_t R,
+		typename T, typename Data, typename O = detail::ignore_iteration,
+		std::enable_if_t< execution::is_execution_policy_v< Policy >,
+			int > = 0 >
 	auto gauss_newton_algorithm(
+		Policy const& policy,
 		F&& f,
 		col_vector< M, R > const& start_value,
 		T const& threshold,
-		boost::container::vector< std::tuple< V ... > > const& data
+		Data const& data,
+		nonlinear_options const& options = nonlinear_options(),
+		O&& observer = O()
 	){
-		using std::abs;
+		using clock = std::chrono::steady_clock;
 
+		auto const start = clock::now();
 		auto arg = start_value;
 
-		for(;;){
-			std::cout << arg << std::endl;
+		for(size_t i = 1;; ++i){
+			nonlinear_iteration< T > state{i, T(0), T(0), T(0), {}, {}, {},
+				{}};
 
-			auto r = make_vector_fn(rows(data.size()),
-				[&data, &arg, &f](r_t r){
-					return f(arg, data[r]);
-				});
+			auto const n = detail::timed(state.jacobian_time, [&]{
+				return accumulate_normal_equations(
+					policy, f, arg, data, threshold / 128);
+			});
 
-			auto d = make_matrix_fn(dim_pair(arg.rows().as_col(), data.size()),
-				[&data, &arg, &f, &threshold](c_t c, r_t r){
-					auto arg1 = arg;
-					arg1[c] += threshold / 128;
-					return (
-						f(arg1, data[r]) - f(arg, data[r])
-					) / (threshold / 128);
-				}
-			);
+			auto const factors = detail::timed(state.solve_time, [&]{
+				return try_cholesky_decomposition(n.jtj);
+			});
+			if(!factors){
+				throw std::logic_error(
+					"gauss_newton_algorithm with singular J^T * J");
+			}
 
-			auto trans_d = transpose(d);
-// 			std::cout << d << std::endl;
-// 			std::cout << trans_d << std::endl;
-// 			std::cout << trans_d * d << std::endl;
-// 			std::cout << trans_d * r << std::endl;
-			auto s = gaussian_elimination(trans_d * d, -trans_d * r);
-			auto arg_new = arg + s;
+			auto const s = detail::timed(state.solve_time, [&]{
+				return factors->solve(-n.jtr);
+			});
 
-			auto diff = arg_new - arg;
+			arg = arg + s;
 
-			arg = arg_new;
+			auto const step = vector_norm_2sqr(s);
+			state.step_norm = std::sqrt(step);
+			state.cost = n.cost;
+			state.elapsed = std::chrono::duration_cast<
+				std::chrono::nanoseconds >(clock::now() - start);
 
-			if(vector_norm_2sqr(diff) < threshold) break;
+			if(
+				!detail::continue_iteration(observer, state, options) ||
+				step < threshold
+			) break;
 		}
 
 		return arg;
 	}
 
 
-	template < typename F, typename M, row_t R, typename T, typename ... V >
+	/// \brief Levenberg-Marquardt algorithm on the normal equations, the
+	///        data points are evaluated by policy
+	///
+	/// The predicted reduction ||r||^2 - ||r + J * s||^2 is calculated as
+	/// -s^T * (2 * J^T * r + J^T * J * s), so the Jacobian is never stored.
+	/// Stops like gauss_newton_algorithm.
+	template < typename Policy, typename F, typename M, row_t R,
+		typename T, typename Data, typename O = detail::ignore_iteration,
+		std::enable_if_t< execution::is_execution_policy_v< Policy >,
+			int > = 0 >
 	auto levenberg_marquardt_algorithm(
+		Policy const& policy,
 		F&& f,
 		col_vector< M, R > const& start_value,
 		T const& threshold,
 		T mu,
 		T const& beta0,
 		T const& beta1,
-		boost::container::vector< std::tuple< V ... > > const& data
+		Data const& data,
+		nonlinear_options const& options = nonlinear_options(),
+		O&& observer = O()
 	){
-		using std::abs;
+		using clock = std::chrono::steady_clock;
 
+		auto const start = clock::now();
 		auto arg = start_value;
 
-		auto r = make_vector_fn(rows(data.size()),
-			[&data, &arg, &f](r_t r){
-				return f(arg, data[r]);
-			});
+		for(size_t i = 1;; ++i){
+			nonlinear_iteration< T > state{i, T(0), T(0), T(0), {}, {}, {},
+				{}};
 
-		for(;;){
-// 			std::cout << arg << std::endl;
+			auto const n = detail::timed(state.jacobian_time, [&]{
+				return accumulate_normal_equations(
+					policy, f, arg, data, threshold / 128);
+			});
 
-			auto d = make_matrix_fn(dim_pair(arg.rows().as_col(), data.size()),
-				[&data, &arg, &f, &threshold](c_t c, r_t r){
-					auto arg1 = arg;
-					arg1[c] += threshold / 128;
-					return (
-						f(arg1, data[r]) - f(arg, data[r])
-					) / (threshold / 128);
-				}
-			);
+			auto const trace = detail::diagonal_sum(n.jtj);
 
-			auto s = [&data, &arg, &r, &d, &f, &mu, beta0, beta1]{ for(;;){
+			size_t increases = 0;
+			auto s = [&]{ for(;;){
 				auto const mu2_matrix = make_diag_matrix_v< T >(
 					arg.rows().as_dim(), mu * mu
 				);
 
-				auto trans_d = transpose(d);
-				auto s = gaussian_elimination(
-					trans_d * d + mu2_matrix,
-					-trans_d * r
-				);
+				auto const factors = detail::timed(state.solve_time, [&]{
+					return try_cholesky_decomposition(n.jtj + mu2_matrix);
+				});
+
+				// Not positive definite, increase the damping
+				if(!factors){
+					mu = detail::increase_damping(mu, trace, increases);
+					continue;
+				}
 
-				auto r_new = make_vector_fn(rows(data.size()),
-					[&data, &arg, &s, &f](r_t r){
-						return f(arg + s, data[r]);
-					});
+				auto s = detail::timed(state.solve_time, [&]{
+					return factors->solve(-n.jtr);
+				});
 
-				auto r_norm = vector_norm_2sqr(r);
-				auto numerator = (r_norm - vector_norm_2sqr(r_new));
-				auto denominator = (r_norm - vector_norm_2sqr(r + d * s));
-				auto eps = numerator / denominator;
+				auto const cost = detail::timed(state.residual_time, [&]{
+					return residual_cost(policy, f, arg + s, data);
+				});
+				auto const numerator = n.cost - cost;
+				auto const denominator =
+					-dot_product(s, T(2) * n.jtr + n.jtj * s);
 
 				if(denominator == 0){
 					throw std::runtime_error("eps is infinite");
 				}
 
-// 				std::cout << "eps: " << eps << std::endl;
+				auto const eps = numerator / denominator;
 				if(eps <= beta0){
-					mu *= 2;
+					mu = detail::increase_damping(mu, trace, increases);
 					continue;
 				}
 
-				r = r_new;
-
-				if(eps < beta1){
-					return s;
+				if(eps >= beta1){
+					mu /= 2;
 				}
 
-				mu /= 2;
 				return s;
 			} }();
 
-// 			std::cout << "s: " << s << std::endl;
-			auto arg_new = arg + s;
+			arg = arg + s;
 
-			arg = arg_new;
+			auto const step = vector_norm_2sqr(s);
+			state.step_norm = std::sqrt(step);
+			state.cost = n.cost;
+			state.mu = mu;
+			state.elapsed = std::chrono::duration_cast<
+				std::chrono::nanoseconds >(clock::now() - start);
 
-			if(vector_norm_2sqr(s) < threshold) break;
+			if(
+				!detail::continue_iteration(observer, state, options) ||
+				step < threshold
+			) break;
 		}
 
 		return arg;
 	}
 
 
+	/// \brief Gauss-Newton algorithm with forward difference or automatic
+	///        differentiation Jacobians
+	///
+	/// data is a random access range of data points, for example a
+	/// std::vector of tuples or column_data for one vector per field.
+	/// Stops if the squared step norm is below threshold, if observer
+	/// returns false or by options. observer is called with a
+	/// nonlinear_iteration after every iteration.
+	///
+	/// This is the execution::seq overload for every count of parameters,
+	/// which solves the normal equations by Cholesky. Use
+	/// qr_gauss_newton_algorithm for badly conditioned Jacobians.
+	template < typename F, typename M, row_t R, typename T, typename Data,
+		typename O = detail::ignore_iteration,
+		std::enable_if_t< !execution::is_execution_policy_v< F >,
+			int > = 0 >
+	auto gauss_newton_algorithm(
+		F&& f,
+		col_vector< M, R > const& start_value,
+		T const& threshold,
+		Data const& data,
+		nonlinear_options const& options = nonlinear_options(),
+		O&& observer = O()
+	){
+		return gauss_newton_algorithm(execution::seq, f, start_value,
+			threshold, data, options, observer);
+	}
+
+
+	/// \brief Gauss-Newton algorithm which solves every step by
+	///        least_squares on the stored Jacobian
+	///
+	/// Stops like gauss_newton_algorithm. The QR decomposition depends on
+	/// the condition of J instead of J^T * J, at the cost of storing the
+	/// N x P Jacobian.
+	template < typename F, typename M, row_t R, typename T, typename Data,
+		typename O = detail::ignore_iteration >
+	auto qr_gauss_newton_algorithm(
+		F&& f,
+		col_vector< M, R > const& start_value,
+		T const& threshold,
+		Data const& data,
+		nonlinear_options const& options = nonlinear_options(),
+		O&& observer = O()
+	){
+		using clock = std::chrono::steady_clock;
+
+		auto const start = clock::now();
+		auto arg = start_value;
+
+		for(size_t i = 1;; ++i){
+			nonlinear_iteration< T > state{i, T(0), T(0), T(0), {}, {}, {},
+				{}};
+
+			auto const [r, d] = detail::residuals_and_jacobian(
+				f, arg, data, threshold / 128, state);
+
+			auto const s = detail::timed(state.solve_time, [&, &r = r,
+				&d = d]{ return least_squares(d, -r); });
+
+			arg = arg + s;
+
+			auto const step = vector_norm_2sqr(s);
+			state.step_norm = std::sqrt(step);
+			state.cost = vector_norm_2sqr(r);
+			state.elapsed = std::chrono::duration_cast<
+				std::chrono::nanoseconds >(clock::now() - start);
+
+			if(
+				!detail::continue_iteration(observer, state, options) ||
+				step < threshold
+			) break;
+		}
+
+		return arg;
+	}
+
+
+	/// \brief Levenberg-Marquardt algorithm with forward difference or
+	///        automatic differentiation Jacobians
+	///
+	/// Stops like gauss_newton_algorithm. This is the execution::seq
+	/// overload for every count of parameters.
+	template < typename F, typename M, row_t R, typename T, typename Data,
+		typename O = detail::ignore_iteration,
+		std::enable_if_t< !execution::is_execution_policy_v< F >,
+			int > = 0 >
+	auto levenberg_marquardt_algorithm(
+		F&& f,
+		col_vector< M, R > const& start_value,
+		T const& threshold,
+		T mu,
+		T const& beta0,
+		T const& beta1,
+		Data const& data,
+		nonlinear_options const& options = nonlinear_options(),
+		O&& observer = O()
+	){
+		return levenberg_marquardt_algorithm(execution::seq, f, start_value,
+			threshold, mu, beta0, beta1, data, options, observer);
+	}
+
+
 }
 
 
@@ -11,6 +11,32 @@
 
 #include "convert.hpp"
 #include "swap_matrix.hpp"
+#include "triangular.hpp"
+#include "detail/closed_form.hpp"
+
+#include <array>
+#include <cmath>
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Row-major values of a compile time N x N matrix
+	template < std::size_t N, typename T, typename M, col_t C, row_t R >
+	constexpr std::array< T, N * N > closed_form_values(
+		matrix< M, C, R > const& m
+	){
+		std::array< T, N * N > result{};
+		for(std::size_t r = 0; r < N; ++r){
+			for(std::size_t c = 0; c < N; ++c){
+				result[r * N + c] = static_cast< T >(m(c_t(c), r_t(r)));
+			}
+		}
+		return result;
+	}
+
+
+}
 
 
 namespace mitrax{
@@ -82,6 +108,41 @@ namespace mitrax{
 
 		auto b = convert< value_type >(v);
 
+		// Cramer's rule for compile time sizes up to 4. Deliberately, float
+		// systems are evaluated in double and rounded once at the end:
+		// the adjugate cancels more than elimination, in float it misses
+		// results which elimination hits exactly. So this path never takes
+		// the SSE float adjugate, only inverse does.
+		if constexpr(constexpr auto n = detail::closed_form_size< C1, R1 >;
+			n > 0
+		){
+			using work_type = std::conditional_t<
+				std::is_same_v< value_type, float >, double, value_type >;
+
+			auto const a = detail::closed_form_values< n, work_type >(m);
+			std::array< work_type, n * n > adj{};
+			auto const det = detail::closed_form_adjugate< n >(
+				a.data(), adj.data());
+			if(det == 0){
+				throw std::logic_error(
+					"gaussian_elimination with non invertible matrix"
+				);
+			}
+
+			std::array< work_type, n > x{};
+			for(std::size_t r = 0; r < n; ++r) x[r] = b[d_t(r)];
+
+			for(std::size_t r = 0; r < n; ++r){
+				work_type sum = 0;
+				for(std::size_t c = 0; c < n; ++c){
+					sum += adj[r * n + c] * x[c];
+				}
+				b[d_t(r)] = static_cast< value_type >(sum / det);
+			}
+
+			return b;
+		}
+
 		// Compiler may optimize with the compile time dimension
 		auto const size = C1 != 0_C ? m.cols().as_dim() :
 			R1 != 0_R ? m.rows().as_dim() : b.rows().as_dim();
@@ -119,20 +180,7 @@ namespace mitrax{
 			}
 		}
 
-		for(auto i = 1_c; i < size.as_col(); ++i){
-			auto x = c_t(size.as_col()) - i;
-
-			for(auto y = 0_r; y < r_t(x); ++y){
-				auto factor = m(x, y) / m(x, r_t(x));
-				b[d_t(y)] -= factor * b[d_t(x)];
-			}
-		}
-
-		for(auto i = 0_d; i < size; ++i){
-			b[i] /= m(c_t(i), r_t(i));
-		}
-
-		return b;
+		return triangular_solve(m, b, triangle::upper);
 	}
 
 
@@ -242,6 +290,25 @@ namespace mitrax{
 			);
 		}
 
+		// Adjugate for compile time sizes up to 4
+		if constexpr(constexpr auto n = detail::closed_form_size< C, R >;
+			n > 0
+		){
+			auto const a = detail::closed_form_values< n, value_type >(m);
+			std::array< value_type, n * n > adj{};
+			auto const det = detail::closed_form_adjugate< n >(
+				a.data(), adj.data());
+			if(det == 0){
+				throw std::logic_error(
+					"inverse with non invertible matrix"
+				);
+			}
+
+			return make_matrix_fn(m.dims(), [&adj, det](c_t c, r_t r){
+				return adj[size_t(r) * n + size_t(c)] / det;
+			});
+		}
+
 		// Compiler may optimize with the compile time dimension
 		auto const size = C == 0_C ? m.rows().as_dim() : m.cols().as_dim();
 
@@ -290,17 +357,68 @@ namespace mitrax{
 			}
 		}
 
-		for(auto i = 0_d; i < size; ++i){
-			auto j = d_t(size) - i - 1_d;
+		return triangular_solve(m, r, triangle::upper, operation::none,
+			diag::unit);
+	}
 
-			for(auto y = 0_r; y < r_t(j); ++y){
-				for(auto x = 0_c; x < size.as_col(); ++x){
-					r(x, y) -= m(c_t(j), y) * r(x, r_t(j));
+
+	/// \brief Determinant of a square matrix
+	///
+	/// Closed form for compile time sizes up to 4, Gaussian elimination
+	/// with partial pivoting otherwise.
+	template < typename M, col_t C, row_t R >
+	constexpr value_type_t< M > determinant(matrix< M, C, R > const& m){
+		using value_type = value_type_t< M >;
+		using std::abs;
+
+		if(m.cols().as_dim() != m.rows().as_dim()){
+			throw std::logic_error(
+				"determinant with non square matrix"
+			);
+		}
+
+		if constexpr(constexpr auto n = detail::closed_form_size< C, R >;
+			n > 0
+		){
+			auto const a = detail::closed_form_values< n, value_type >(m);
+			return detail::closed_form_determinant< n >(a.data());
+		}else{
+			auto a = convert< value_type >(m);
+			auto const size = size_t(m.cols());
+			auto const row = [&a, size](size_t i){
+				return a.data() + i * size;
+			};
+
+			value_type result = 1;
+			for(size_t k = 0; k < size; ++k){
+				auto pivot = k;
+				for(size_t i = k + 1; i < size; ++i){
+					if(abs(row(pivot)[k]) < abs(row(i)[k])) pivot = i;
+				}
+
+				if(row(pivot)[k] == 0) return value_type(0);
+
+				auto const rk = row(k);
+				if(pivot != k){
+					auto const rp = row(pivot);
+					for(size_t j = k; j < size; ++j){
+						auto const t = rk[j];
+						rk[j] = rp[j];
+						rp[j] = t;
+					}
+					result = -result;
+				}
+
+				result *= rk[k];
+				for(size_t i = k + 1; i < size; ++i){
+					auto const ri = row(i);
+					auto const f = ri[k] / rk[k];
+					for(size_t j = k + 1; j < size; ++j) ri[j] -= f * rk[j];
 				}
 			}
-		}
 
-		return r;
+			return result;
+		}
 	}
 
 
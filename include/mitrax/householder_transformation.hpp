@@ -9,42 +9,47 @@
 #ifndef _mitrax__householder_transformation__hpp_INCLUDED_
 #define _mitrax__householder_transformation__hpp_INCLUDED_
 
-#include "matrix.hpp"
-#include "norm.hpp"
+#include "qr_decomposition.hpp"
+
+#include <utility>
 
 
 namespace mitrax{
 
 
+	/// \brief Q (rows x rows) and R (cols x rows) with m = Q * R
+	///
+	/// Q is formed explicitly, use qr_decomposition to apply it implicitly.
+	/// R is upper trapezoidal for every shape of m. With more columns
+	/// than rows the leading square block is factorised and Q^T is
+	/// applied to the other columns.
 	template < typename M, col_t C, row_t R >
 	auto householder_transformation(matrix< M, C, R > const& m){
-		using namespace literals;
-
 		using value_type = value_type_t< M >;
 
-		auto const identity = make_identity_matrix< value_type >(
-			m.rows().as_dim()
-		);
-
-		auto r = m;
-		auto q = identity;
-
-		for(size_t i = 0; i < m.cols() - 1_CS; ++i){
-			auto v = make_vector_fn(m.rows(),
-				[i, &r](size_t y){
-					if(y < i) return value_type();
-					return r(i, y);
-				});
-			v[i] += vector_norm_2(v);
-			auto tv = transpose(v);
-			value_type d = tv * v;
-			auto h = identity - (2 / d * v * tv);
-
-			r = h * r;
-			q = q * h;
+		if(size_t(m.cols()) <= size_t(m.rows())){
+			auto const qr = qr_decomposition(m);
+			return std::make_pair(qr.q(), qr.r());
 		}
 
-		return std::make_pair(q, r);
+		auto const n = [&m]{
+			if constexpr(R == 0_R){
+				return cols(col_t(size_t(m.rows())));
+			}else{
+				return cols< col_t(R) >();
+			}
+		}();
+
+		auto const qr = qr_decomposition(make_matrix_fn(n, m.rows(),
+			[&m](c_t c, r_t r){ return m(c, r); }));
+		auto const qtm = qr.apply_qt(m);
+		auto const square = qr.r();
+
+		return std::make_pair(qr.q(), make_matrix_fn(m.dims(),
+			[&square, &qtm, &n](c_t c, r_t r){
+				if(size_t(c) < size_t(n)) return square(c, r);
+				return static_cast< value_type >(qtm(c, r));
+			}));
 	}
 
 
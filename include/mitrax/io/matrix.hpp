@@ -10,6 +10,7 @@
 #define _mitrax__io__matrix__hpp_INCLUDED_
 
 #include "../matrix_interface.hpp"
+#include "dim.hpp"
 
 #include <ostream>
 
@@ -0,0 +1,219 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__layout__hpp_INCLUDED_
+#define _mitrax__layout__hpp_INCLUDED_
+
+#include "utility.hpp"
+#include "detail/concepts.hpp"
+
+#include <cstddef>
+
+
+namespace mitrax::layout{
+
+
+	/// \brief Values of a row are contiguous
+	struct row_major{
+		static constexpr size_t size(size_t cols, size_t rows)noexcept{
+			return cols * rows;
+		}
+
+		static constexpr size_t
+		index(size_t c, size_t r, size_t cols, size_t /*rows*/)noexcept{
+			return r * cols + c;
+		}
+
+		/// \brief Call f(c, r) in storage order until it returns false
+		template < typename F >
+		static constexpr bool traverse(size_t cols, size_t rows, F&& f){
+			for(size_t r = 0; r < rows; ++r){
+				for(size_t c = 0; c < cols; ++c){
+					if(!f(c, r)) return false;
+				}
+			}
+			return true;
+		}
+	};
+
+
+	/// \brief Values of a column are contiguous
+	struct col_major{
+		static constexpr size_t size(size_t cols, size_t rows)noexcept{
+			return cols * rows;
+		}
+
+		static constexpr size_t
+		index(size_t c, size_t r, size_t /*cols*/, size_t rows)noexcept{
+			return c * rows + r;
+		}
+
+		/// \brief Call f(c, r) in storage order until it returns false
+		template < typename F >
+		static constexpr bool traverse(size_t cols, size_t rows, F&& f){
+			for(size_t c = 0; c < cols; ++c){
+				for(size_t r = 0; r < rows; ++r){
+					if(!f(c, r)) return false;
+				}
+			}
+			return true;
+		}
+	};
+
+
+	/// \brief Contiguous B x B blocks in row-wise block order, values in
+	///        Z-order (Morton order) within a block
+	///
+	/// Blocks at the right and bottom border are padded. Neighbors in both
+	/// directions are close in memory, which favors column-wise access and
+	/// 2D filters.
+	template < size_t B = 8 >
+	struct morton{
+		static_assert(B > 0 && (B & (B - 1)) == 0,
+			"block size must be a power of two");
+
+		static constexpr size_t block_size = B;
+
+
+		static constexpr size_t size(size_t cols, size_t rows)noexcept{
+			return blocks(cols) * blocks(rows) * B * B;
+		}
+
+		static constexpr size_t
+		index(size_t c, size_t r, size_t cols, size_t /*rows*/)noexcept{
+			auto const block = (r / B) * blocks(cols) + c / B;
+			return block * B * B + interleave(c % B, r % B);
+		}
+
+		/// \brief Call f(c, r) in storage order until it returns false
+		template < typename F >
+		static constexpr bool traverse(size_t cols, size_t rows, F&& f){
+			for(size_t by = 0; by < rows; by += B){
+				for(size_t bx = 0; bx < cols; bx += B){
+					for(size_t i = 0; i < B * B; ++i){
+						auto const c = bx + deinterleave(i);
+						auto const r = by + deinterleave(i >> 1);
+						if(c < cols && r < rows && !f(c, r)) return false;
+					}
+				}
+			}
+			return true;
+		}
+
+
+	private:
+		static constexpr size_t blocks(size_t n)noexcept{
+			return (n + B - 1) / B;
+		}
+
+		/// \brief Bits of x at even and of y at odd positions
+		static constexpr size_t interleave(size_t x, size_t y)noexcept{
+			size_t result = 0;
+			for(size_t bit = 0; (size_t(1) << bit) < B; ++bit){
+				result |= ((x >> bit) & 1) << (2 * bit);
+				result |= ((y >> bit) & 1) << (2 * bit + 1);
+			}
+			return result;
+		}
+
+		/// \brief Even bits of i
+		static constexpr size_t deinterleave(size_t i)noexcept{
+			size_t result = 0;
+			for(size_t bit = 0; (size_t(1) << bit) < B; ++bit){
+				result |= ((i >> (2 * bit)) & 1) << bit;
+			}
+			return result;
+		}
+	};
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	template < typename M >
+	using check_layout_type = typename M::layout_type;
+
+	template < typename M >
+	using check_row_memory_order = decltype(M::row_memory_order);
+
+
+	template < typename M >
+	constexpr auto impl_layout(){
+		if constexpr(compiles< M, check_layout_type >::value){
+			return typename M::layout_type();
+		}else if constexpr(compiles< M, check_row_memory_order >::value){
+			if constexpr(M::row_memory_order){
+				return layout::row_major();
+			}else{
+				return layout::col_major();
+			}
+		}else{
+			return layout::row_major();
+		}
+	}
+
+	template < typename M >
+	using check_object_type = typename M::object_type;
+
+	/// \brief True if impl M stores its values contiguous in row-major
+	///        order and returns them by data()const
+	///
+	/// matrix::data()const and the view impls declare data()const for
+	/// every impl, so has_data_v alone is not enough.
+	template < typename M >
+	constexpr bool has_row_major_data(){
+		using value_type = value_type_t< M >;
+		if constexpr(!std::is_same_v<
+			decltype(impl_layout< M >()), layout::row_major >
+		){
+			return false;
+		}else if constexpr(compiles< M, check_object_type >::value){
+			using object_type = typename M::object_type;
+			return std::is_array_v< object_type > ||
+				has_data_v< value_type const*, object_type const >;
+		}else{
+			return has_data_v< value_type const*, M const >;
+		}
+	}
+
+	/// \brief Common storage layout of all impls or row_major if they differ
+	template < typename M, typename ... Ms >
+	constexpr auto common_layout(){
+		using type = decltype(impl_layout< M >());
+		if constexpr(
+			(std::is_same_v< type, decltype(impl_layout< Ms >()) > && ...)
+		){
+			return type();
+		}else{
+			return layout::row_major();
+		}
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Storage layout of a matrix impl, row_major if unknown
+	template < typename ... M >
+	using layout_t = decltype(detail::common_layout< M ... >());
+
+	/// \brief True if the matrix impl M has contiguous row-major data()
+	template < typename M >
+	constexpr bool has_row_major_data_v = detail::has_row_major_data< M >();
+
+
+}
+
+
+#endif
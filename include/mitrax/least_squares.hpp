@@ -0,0 +1,182 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__least_squares__hpp_INCLUDED_
+#define _mitrax__least_squares__hpp_INCLUDED_
+
+#include "qr_decomposition.hpp"
+#include "detail/parallel_for.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+namespace mitrax{
+
+
+	struct least_squares_options{
+		/// \brief Minimal row count of a block
+		size_t block_rows = 4096;
+
+		/// \brief Count of threads, 0 for the hardware concurrency
+		size_t threads = 0;
+	};
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief R and the first rows of Q^T * B of a part of the system
+	template < typename T >
+	struct tsqr_factor{
+		std_matrix< T, 0_C, 0_R > r;
+		std_matrix< T, 0_C, 0_R > c;
+	};
+
+
+	/// \brief Factorise the rows [0, m) of A | B given by functions
+	template < typename T, typename FA, typename FB >
+	tsqr_factor< T > tsqr_reduce(
+		size_t n, size_t p, size_t m, FA const& fa, FB const& fb
+	){
+		auto const qr = qr_decomposition(make_matrix_fn(
+			cols(col_t(n)), rows(row_t(m)), fa));
+		auto const r = qr.r();
+		auto const c = qr.apply_qt(make_matrix_fn(
+			cols(col_t(p)), rows(row_t(m)), fb));
+
+		return {
+			make_matrix_fn(cols(col_t(n)), rows(row_t(n)),
+				[&r](c_t x, r_t y){ return r(x, y); }),
+			make_matrix_fn(cols(col_t(p)), rows(row_t(n)),
+				[&c](c_t x, r_t y){ return c(x, y); })
+		};
+	}
+
+	/// \brief Factorise the stacked R | Q^T * B of two parts
+	template < typename T >
+	tsqr_factor< T > tsqr_merge(
+		tsqr_factor< T > const& a, tsqr_factor< T > const& b
+	){
+		auto const n = size_t(a.r.cols());
+		auto const stacked = [n](auto const& u, auto const& v){
+			return [n, &u, &v](c_t x, r_t y){
+				return size_t(y) < n ? u(x, y) : v(x, r_t(size_t(y) - n));
+			};
+		};
+
+		return tsqr_reduce< T >(n, size_t(a.c.cols()), 2 * n,
+			stacked(a.r, b.r), stacked(a.c, b.c));
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Least squares solution of A * X = B for all columns of B
+	///
+	/// The rows are split into blocks which are QR factorised in parallel.
+	/// The resulting triangular factors are merged pairwise in a tree
+	/// (TSQR), so A^T * A is never formed and every block of A is read
+	/// once. A must have full column rank and at least as many rows as
+	/// columns.
+	template <
+		typename MA, col_t CA, row_t RA,
+		typename MB, col_t CB, row_t RB >
+	auto least_squares(
+		matrix< MA, CA, RA > const& a,
+		matrix< MB, CB, RB > const& b,
+		least_squares_options const& options = least_squares_options()
+	){
+		using value_type = std::common_type_t<
+			value_type_t< MA >, value_type_t< MB > >;
+
+		auto const n = size_t(a.cols());
+		auto const m = size_t(a.rows());
+		auto const p = size_t(b.cols());
+
+		if(size_t(b.rows()) != m){
+			throw std::logic_error("least_squares: incompatible dimensions");
+		}
+
+		if(n > m){
+			throw std::logic_error(
+				"least_squares with more columns than rows");
+		}
+
+		// Blocks with at least max(block_rows, 2 * n) rows
+		auto const block_rows =
+			std::max({options.block_rows, 2 * n, size_t(1)});
+		auto const count = std::max(m / block_rows, size_t(1));
+
+		std::vector< detail::tsqr_factor< value_type > > factors(count);
+		detail::parallel_for(count, options.threads,
+			[&](size_t i){
+				auto const begin = i * m / count;
+				auto const end = (i + 1) * m / count;
+				factors[i] = detail::tsqr_reduce< value_type >(
+					n, p, end - begin,
+					[&a, begin](c_t x, r_t y){
+						return static_cast< value_type >(
+							a(x, r_t(begin + size_t(y))));
+					},
+					[&b, begin](c_t x, r_t y){
+						return static_cast< value_type >(
+							b(x, r_t(begin + size_t(y))));
+					});
+			});
+
+		while(factors.size() > 1){
+			std::vector< detail::tsqr_factor< value_type > >
+				merged((factors.size() + 1) / 2);
+			detail::parallel_for(factors.size() / 2, options.threads,
+				[&factors, &merged](size_t i){
+					merged[i] = detail::tsqr_merge(
+						factors[2 * i], factors[2 * i + 1]);
+				});
+
+			if(factors.size() % 2 == 1){
+				merged.back() = std::move(factors.back());
+			}
+			factors = std::move(merged);
+		}
+
+		// R * X = C
+		auto const& r = factors.front().r;
+		auto const& c = factors.front().c;
+		auto x = make_matrix_v< value_type >(b.cols(), a.cols().as_row());
+		auto const xd = x.data();
+		auto const rd = r.data();
+		auto const cd = c.data();
+		for(size_t i = 0; i < n; ++i){
+			if(rd[i * n + i] == value_type(0)){
+				throw std::logic_error(
+					"least_squares with rank deficient matrix");
+			}
+		}
+
+		std::copy(cd, cd + n * p, xd);
+		detail::trsm(triangle::upper, operation::none, diag::non_unit,
+			n, p, detail::row_pointer{rd, n}, detail::row_pointer{xd, p});
+
+		return x;
+	}
+
+
+}
+
+
+#endif
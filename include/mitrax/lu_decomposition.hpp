@@ -0,0 +1,244 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__lu_decomposition__hpp_INCLUDED_
+#define _mitrax__lu_decomposition__hpp_INCLUDED_
+
+#include "make_matrix.hpp"
+#include "triangular.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+
+
+namespace mitrax{
+
+
+	/// \brief LU factorisation with partial pivoting: P * A = L * U
+	///
+	/// L has a unit diagonal and is stored together with U in one matrix.
+	/// Row exchanges are only recorded in a permutation, the rows are
+	/// never moved. Large matrices are factorised in column panels with
+	/// blocked right-looking updates of the trailing matrix.
+	///
+	/// All solves reuse the stored factors.
+	template < typename T, dim_t D >
+	class lu_decomposition{
+	public:
+		/// \brief Type of the factors
+		using value_type = T;
+
+		/// \brief Count of columns of a panel in the blocked factorisation
+		static constexpr size_t block_size = 32;
+
+
+		template < typename M, col_t C, row_t R >
+		explicit lu_decomposition(matrix< M, C, R > const& m):
+			lu_(make_factors(m)),
+			perm_(make_vector_fn(lu_.rows(), [](size_t i){ return i; })),
+			sign_(1)
+		{
+			factorise();
+		}
+
+
+		/// \brief Dimension of the factorised square matrix
+		auto size()const{
+			return lu_.cols().as_dim();
+		}
+
+		/// \brief Row i of L * U is row permutation()[i] of the matrix
+		auto const& permutation()const{
+			return perm_;
+		}
+
+		/// \brief Unit lower triangular factor
+		std_square_matrix< T, D > lower()const{
+			return make_matrix_fn(size(), [this](c_t c, r_t r){
+				return size_t(c) < size_t(r) ? at(size_t(r), size_t(c))
+					: size_t(c) == size_t(r) ? T(1) : T(0);
+			});
+		}
+
+		/// \brief Upper triangular factor
+		std_square_matrix< T, D > upper()const{
+			return make_matrix_fn(size(), [this](c_t c, r_t r){
+				return size_t(c) >= size_t(r)
+					? at(size_t(r), size_t(c)) : T(0);
+			});
+		}
+
+
+		/// \brief Solve A * X = B for all columns of B
+		template < typename M, col_t C, row_t R >
+		auto solve(matrix< M, C, R > const& b)const{
+			using result_type = std::common_type_t< T, value_type_t< M > >;
+
+			auto const n = size_t(size());
+			if(size_t(b.rows()) != n){
+				throw std::logic_error(
+					"lu_decomposition::solve: incompatible dimensions");
+			}
+
+			auto x = make_matrix_v< result_type >(b.dims());
+			auto const m = size_t(b.cols());
+			auto const xd = x.data();
+			auto const p = perm_.data();
+
+			// Y = P * B
+			for(size_t i = 0; i < n; ++i){
+				auto const xi = xd + i * m;
+				for(size_t j = 0; j < m; ++j){
+					xi[j] = b(c_t(j), r_t(p[i]));
+				}
+			}
+
+			// L * Z = Y and U * X = Z
+			auto const lu = [this](size_t i){ return row(i); };
+			auto const xr = detail::row_pointer{xd, m};
+			detail::trsm(triangle::lower, operation::none, diag::unit,
+				n, m, lu, xr);
+			detail::trsm(triangle::upper, operation::none, diag::non_unit,
+				n, m, lu, xr);
+
+			return x;
+		}
+
+		/// \brief Inverse of the factorised matrix
+		std_square_matrix< T, D > inverse()const{
+			return solve(make_identity_matrix< T >(size()));
+		}
+
+		/// \brief Determinant of the factorised matrix
+		T determinant()const{
+			T result = T(sign_);
+			for(size_t i = 0; i < size_t(size()); ++i){
+				result *= at(i, i);
+			}
+			return result;
+		}
+
+
+	private:
+		template < typename M, col_t C, row_t R >
+		static std_square_matrix< T, D > make_factors(
+			matrix< M, C, R > const& m
+		){
+			if(size_t(m.cols()) != size_t(m.rows())){
+				throw std::logic_error(
+					"lu_decomposition with non square matrix");
+			}
+
+			auto const f = [&m](c_t c, r_t r){
+				return static_cast< T >(m(c, r));
+			};
+
+			if constexpr(D == 0_D){
+				return make_matrix_fn(dims(dim_t(size_t(m.cols()))), f);
+			}else{
+				if(size_t(m.cols()) != size_t(D)){
+					throw std::logic_error(
+						"lu_decomposition: incompatible dimensions");
+				}
+
+				return make_matrix_fn(dims< D >(), f);
+			}
+		}
+
+
+		T* row(size_t i){
+			return lu_.data() + perm_.data()[i] * size_t(size());
+		}
+
+		T const* row(size_t i)const{
+			return lu_.data() + perm_.data()[i] * size_t(size());
+		}
+
+		T const& at(size_t i, size_t j)const{
+			return row(i)[j];
+		}
+
+
+		void factorise(){
+			using std::abs;
+
+			auto const n = size_t(size());
+			auto const p = perm_.data();
+
+			for(size_t kb = 0; kb < n; kb += block_size){
+				auto const ke = std::min(kb + block_size, n);
+
+				// Factorise the panel columns [kb, ke) of all rows
+				for(size_t k = kb; k < ke; ++k){
+					auto pivot = k;
+					auto max = abs(row(k)[k]);
+					for(size_t i = k + 1; i < n; ++i){
+						auto const v = abs(row(i)[k]);
+						if(max < v){
+							max = v;
+							pivot = i;
+						}
+					}
+
+					if(max == T(0)){
+						throw std::logic_error(
+							"lu_decomposition with non invertible matrix");
+					}
+
+					if(pivot != k){
+						std::swap(p[k], p[pivot]);
+						sign_ = -sign_;
+					}
+
+					auto const rk = row(k);
+					for(size_t i = k + 1; i < n; ++i){
+						auto const ri = row(i);
+						auto const l = ri[k] /= rk[k];
+						for(size_t j = k + 1; j < ke; ++j){
+							ri[j] -= l * rk[j];
+						}
+					}
+				}
+
+				if(ke == n) break;
+
+				// U12 = L11^-1 * A12
+				detail::trsm(triangle::lower, operation::none, diag::unit,
+					ke - kb, n - ke,
+					[this, kb](size_t i){ return row(kb + i) + kb; },
+					[this, kb, ke](size_t i){ return row(kb + i) + ke; });
+
+				// A22 -= L21 * U12
+				for(size_t i = ke; i < n; ++i){
+					auto const ri = row(i);
+					for(size_t k = kb; k < ke; ++k){
+						auto const l = ri[k];
+						auto const rk = row(k);
+						for(size_t j = ke; j < n; ++j) ri[j] -= l * rk[j];
+					}
+				}
+			}
+		}
+
+
+		std_square_matrix< T, D > lu_;
+		std_col_vector< size_t, row_t(D) > perm_;
+		int sign_;
+	};
+
+
+	template < typename M, col_t C, row_t R >
+	lu_decomposition(matrix< M, C, R > const&) -> lu_decomposition<
+		value_type_t< M >, C != 0_C ? dim_t(C) : dim_t(R) >;
+
+
+}
+
+
+#endif
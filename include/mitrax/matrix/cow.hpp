@@ -0,0 +1,143 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__matrix__cow__hpp_INCLUDED_
+#define _mitrax__matrix__cow__hpp_INCLUDED_
+
+#include "cow_fwd.hpp"
+#include "std.hpp"
+
+#include <atomic>
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Heap matrix whose copies share the values until one of them
+	///        is accessed non-const
+	///
+	/// Copies only increment a reference count. Every non-const access
+	/// duplicates the values first if they are shared, so references and
+	/// pointers obtained by non-const access must not be used to write
+	/// after the matrix was copied.
+	///
+	/// Distinct matrix objects that share values may be used concurrently.
+	template < typename T, col_t C, row_t R >
+	class cow_matrix_impl final: auto_dim_pair_t< C, R >{
+	public:
+		static_assert(!std::is_const_v< T >);
+		static_assert(!std::is_reference_v< T >);
+
+
+		/// \brief Type of the data that administrates the matrix
+		using value_type = T;
+
+		/// \brief Type with the make functions
+		using maker_type = maker::cow_t;
+
+
+		cow_matrix_impl(default_constructor_key):
+			values_(std::make_shared< array_d< value_type > >(
+				mitrax::make_value_iterator(value_type()),
+				size_t(C) * size_t(R)))
+			{}
+
+		cow_matrix_impl(cow_matrix_impl&&) = default;
+
+		cow_matrix_impl(cow_matrix_impl const&) = default;
+
+		cow_matrix_impl(
+			col< C != 0_C, C > c, row< R != 0_R, R > r,
+			std::shared_ptr< array_d< value_type > >&& values
+		):
+			auto_dim_pair_t< C, R >(c, r),
+			values_(std::move(values))
+			{}
+
+
+		cow_matrix_impl& operator=(cow_matrix_impl&&) = default;
+
+		cow_matrix_impl& operator=(cow_matrix_impl const&) = default;
+
+
+		using auto_dim_pair_t< C, R >::cols;
+		using auto_dim_pair_t< C, R >::rows;
+
+
+		value_type& operator()(c_t c, r_t r){
+			return data()[size_t(r) * size_t(this->cols()) + size_t(c)];
+		}
+
+		value_type const& operator()(c_t c, r_t r)const{
+			return data()[size_t(r) * size_t(this->cols()) + size_t(c)];
+		}
+
+
+		value_type* data(){
+			detach();
+			return values_->data();
+		}
+
+		value_type const* data()const{
+			return values_->data();
+		}
+
+
+		/// \brief true if other matrices share the values
+		bool shared()const noexcept{
+			return values_.use_count() > 1;
+		}
+
+		/// \brief Duplicate the values if they are shared
+		void detach(){
+			if(values_.use_count() > 1){
+				values_ = std::make_shared< array_d< value_type > >(
+					*values_);
+			}else{
+				// The last other owner released the values, its reads
+				// happen before our writes
+				std::atomic_thread_fence(std::memory_order_acquire);
+			}
+		}
+
+
+		template < typename Iter >
+		void reinit_iter(Iter iter){
+			*this = maker_type().by_sequence
+				(this->cols(), this->rows(), iter).impl();
+		}
+
+
+	private:
+		std::shared_ptr< array_d< value_type > > values_;
+	};
+
+
+}
+
+
+namespace mitrax::maker{
+
+
+	template < typename Iter, bool Cct, col_t C, bool Rct, row_t R >
+	cow_matrix< iter_type_t< Iter >, Cct ? C : 0_C, Rct ? R : 0_R >
+	cow_t::by_sequence(col< Cct, C > c, row< Rct, R > r, Iter iter)const{
+		return {
+			init, c, r,
+			std::make_shared< detail::array_d< iter_type_t< Iter > > >(
+				iter, size_t(c) * size_t(r))
+		};
+	}
+
+	constexpr auto cow = cow_t();
+
+
+}
+
+
+#endif
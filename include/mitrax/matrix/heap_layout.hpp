@@ -0,0 +1,227 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__matrix__heap_layout__hpp_INCLUDED_
+#define _mitrax__matrix__heap_layout__hpp_INCLUDED_
+
+#include "heap_layout_fwd.hpp"
+#include "std.hpp"
+
+#include "../iterator/function.hpp"
+
+
+namespace mitrax::detail{
+
+
+	template < typename Impl >
+	struct layout_value_fn{
+		constexpr decltype(auto) operator()(size_t i)const{
+			auto const cols = size_t(impl->cols());
+			return (*impl)(c_t(i % cols), r_t(i / cols));
+		}
+
+		Impl* impl;
+	};
+
+
+	template < typename T, typename Layout, col_t C, row_t R >
+	class heap_layout_matrix_impl final: auto_dim_pair_t< C, R >{
+	public:
+		static_assert(!std::is_const_v< T >);
+		static_assert(!std::is_reference_v< T >);
+
+
+		/// \brief Type of the data that administrates the matrix
+		using value_type = T;
+
+		/// \brief Type with the make functions
+		using maker_type = maker::heap_layout_t< Layout >;
+
+		/// \brief Order of the values in memory
+		using layout_type = Layout;
+
+
+		heap_layout_matrix_impl(default_constructor_key):
+			values_(mitrax::make_value_iterator(value_type()),
+				Layout::size(size_t(C), size_t(R)))
+			{}
+
+		heap_layout_matrix_impl(heap_layout_matrix_impl&&) = default;
+
+		heap_layout_matrix_impl(heap_layout_matrix_impl const&) = default;
+
+		heap_layout_matrix_impl(
+			col< C != 0_C, C > c, row< R != 0_R, R > r,
+			detail::array_d< value_type >&& values
+		):
+			auto_dim_pair_t< C, R >(c, r),
+			values_(std::move(values))
+			{}
+
+
+		heap_layout_matrix_impl& operator=(heap_layout_matrix_impl&&)
+			= default;
+
+		heap_layout_matrix_impl& operator=(heap_layout_matrix_impl const&)
+			= default;
+
+
+		using auto_dim_pair_t< C, R >::cols;
+		using auto_dim_pair_t< C, R >::rows;
+
+
+		value_type& operator()(c_t c, r_t r){
+			return values_[index(c, r)];
+		}
+
+		value_type const& operator()(c_t c, r_t r)const{
+			return values_[index(c, r)];
+		}
+
+
+		/// \brief Row-wise iteration independent of the layout
+		auto begin(){
+			return make_function_iterator(
+				layout_value_fn< heap_layout_matrix_impl >{this});
+		}
+
+		auto begin()const{
+			return make_function_iterator(
+				layout_value_fn< heap_layout_matrix_impl const >{this});
+		}
+
+		auto end(){
+			return make_function_iterator(
+				layout_value_fn< heap_layout_matrix_impl >{this},
+				size_t(this->cols()) * size_t(this->rows()));
+		}
+
+		auto end()const{
+			return make_function_iterator(
+				layout_value_fn< heap_layout_matrix_impl const >{this},
+				size_t(this->cols()) * size_t(this->rows()));
+		}
+
+
+		/// \brief Values in storage order, including padding
+		value_type* storage(){
+			return values_.data();
+		}
+
+		value_type const* storage()const{
+			return values_.data();
+		}
+
+		size_t storage_size()const{
+			return values_.size();
+		}
+
+
+		template < typename Iter >
+		void reinit_iter(Iter iter){
+			*this = maker_type().by_sequence
+				(this->cols(), this->rows(), iter).impl();
+		}
+
+
+	private:
+		size_t index(c_t c, r_t r)const{
+			return Layout::index(size_t(c), size_t(r),
+				size_t(this->cols()), size_t(this->rows()));
+		}
+
+		array_d< value_type > values_;
+	};
+
+
+}
+
+
+namespace mitrax::maker{
+
+
+	template < typename Layout >
+	template < typename Iter, bool Cct, col_t C, bool Rct, row_t R >
+	heap_layout_matrix< iter_type_t< Iter >, Layout,
+		Cct ? C : 0_C, Rct ? R : 0_R >
+	heap_layout_t< Layout >::by_sequence(
+		col< Cct, C > c, row< Rct, R > r, Iter iter
+	)const{
+		using value_type = iter_type_t< Iter >;
+
+		auto const cols = size_t(c);
+		auto const rows = size_t(r);
+
+		detail::array_d< value_type > values(
+			mitrax::make_value_iterator(value_type()),
+			Layout::size(cols, rows));
+
+		// The sequence is row-wise
+		for(size_t y = 0; y < rows; ++y){
+			for(size_t x = 0; x < cols; ++x, ++iter){
+				values[Layout::index(x, y, cols, rows)] = *iter;
+			}
+		}
+
+		return {init, c, r, std::move(values)};
+	}
+
+	template < typename Layout >
+	template < typename F, bool Cct, col_t C, bool Rct, row_t R >
+	auto heap_layout_t< Layout >::by_function(
+		col< Cct, C > c, row< Rct, R > r, F&& f
+	)const{
+		using value_type = std::decay_t< decltype(f(c_t(), r_t())) >;
+
+		auto const cols = size_t(c);
+		auto const rows = size_t(r);
+
+		detail::array_d< value_type > values(
+			mitrax::make_value_iterator(value_type()),
+			Layout::size(cols, rows));
+
+		Layout::traverse(cols, rows, [&](size_t x, size_t y){
+			values[Layout::index(x, y, cols, rows)] = f(c_t(x), r_t(y));
+			return true;
+		});
+
+		return heap_layout_matrix< value_type, Layout,
+			Cct ? C : 0_C, Rct ? R : 0_R >{init, c, r, std::move(values)};
+	}
+
+	template < typename Layout >
+	constexpr auto heap_layout = heap_layout_t< Layout >();
+
+	constexpr auto col_major = heap_layout_t< layout::col_major >();
+
+	constexpr auto morton = heap_layout_t< layout::morton<> >();
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Matrix of f applied to every value, with the same layout
+	///
+	/// Both matrices are processed in storage order.
+	template < typename F, typename T, typename Layout, col_t C, row_t R >
+	auto transform(
+		F&& f, heap_layout_matrix< T, Layout, C, R > const& image
+	){
+		return maker::heap_layout< Layout >.by_function(
+			image.cols(), image.rows(),
+			[&f, &image](c_t c, r_t r){ return f(image(c, r)); });
+	}
+
+
+}
+
+
+#endif
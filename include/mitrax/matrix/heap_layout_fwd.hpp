@@ -0,0 +1,62 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__matrix__heap_layout_fwd__hpp_INCLUDED_
+#define _mitrax__matrix__heap_layout_fwd__hpp_INCLUDED_
+
+#include "../matrix_interface.hpp"
+#include "../layout.hpp"
+
+
+namespace mitrax::detail{
+
+
+	template < typename T, typename Layout, col_t C, row_t R >
+	class heap_layout_matrix_impl;
+
+
+}
+
+
+namespace mitrax{
+
+
+	template < typename T, typename Layout, col_t C, row_t R >
+	using heap_layout_matrix =
+		matrix< detail::heap_layout_matrix_impl< T, Layout, C, R >, C, R >;
+
+	template < typename T, col_t C, row_t R >
+	using col_major_matrix = heap_layout_matrix< T, layout::col_major, C, R >;
+
+	template < typename T, col_t C, row_t R, size_t B = 8 >
+	using morton_matrix = heap_layout_matrix< T, layout::morton< B >, C, R >;
+
+
+}
+
+
+namespace mitrax::maker{
+
+
+	template < typename Layout >
+	struct heap_layout_t: key{
+		template < typename Iter, bool Cct, col_t C, bool Rct, row_t R >
+		heap_layout_matrix< iter_type_t< Iter >, Layout,
+			Cct ? C : 0_C, Rct ? R : 0_R >
+		by_sequence(col< Cct, C > c, row< Rct, R > r, Iter iter)const;
+
+		/// \brief Values f(c, r), f is called in storage order
+		template < typename F, bool Cct, col_t C, bool Rct, row_t R >
+		auto by_function(col< Cct, C > c, row< Rct, R > r, F&& f)const;
+	};
+
+
+}
+
+
+#endif
@@ -0,0 +1,416 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__matrix__mmap__hpp_INCLUDED_
+#define _mitrax__matrix__mmap__hpp_INCLUDED_
+
+#include "mmap_fwd.hpp"
+
+#include <system_error>
+#include <cerrno>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace mitrax::detail{
+
+
+	/// \brief RAII owner of a shared file mapping
+	class mapped_file final{
+	public:
+		mapped_file(
+			std::string const& filename,
+			bool writable,
+			size_t offset,
+			size_t bytes,
+			mmap_hints hints
+		){
+			auto const fd =
+				::open(filename.c_str(), writable ? O_RDWR : O_RDONLY);
+			if(fd < 0){
+				throw std::system_error(errno, std::generic_category(),
+					"mmap_matrix: can not open '" + filename + "'");
+			}
+
+			struct ::stat info;
+			if(::fstat(fd, &info) != 0){
+				auto const error = errno;
+				::close(fd);
+				throw std::system_error(error, std::generic_category(),
+					"mmap_matrix: can not stat '" + filename + "'");
+			}
+
+			if(size_t(info.st_size) < offset + bytes){
+				::close(fd);
+				throw std::runtime_error("mmap_matrix: file '" + filename +
+					"' has " + std::to_string(info.st_size) +
+					" bytes, but offset and matrix need " +
+					std::to_string(offset + bytes));
+			}
+
+			// mmap fails for 0 bytes, an empty matrix needs no mapping
+			if(bytes == 0){
+				::close(fd);
+				return;
+			}
+
+			// mmap requires a page aligned offset
+			auto const page_size = size_t(::sysconf(_SC_PAGESIZE));
+			auto const map_offset = offset - offset % page_size;
+			size_ = offset - map_offset + bytes;
+
+			int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+			if(hints.populate) flags |= MAP_POPULATE;
+#endif
+
+			auto const base = ::mmap(nullptr, size_,
+				writable ? PROT_READ | PROT_WRITE : PROT_READ,
+				flags, fd, off_t(map_offset));
+			auto const error = errno;
+
+			// The mapping keeps its own reference to the file
+			::close(fd);
+
+			if(base == MAP_FAILED){
+				throw std::system_error(error, std::generic_category(),
+					"mmap_matrix: can not map '" + filename + "'");
+			}
+
+			base_ = base;
+			data_ = static_cast< char* >(base) + (offset - map_offset);
+
+			advise(hints);
+		}
+
+		mapped_file(mapped_file&& other)noexcept:
+			base_(other.base_),
+			data_(other.data_),
+			size_(other.size_)
+		{
+			other.base_ = nullptr;
+			other.data_ = nullptr;
+			other.size_ = 0;
+		}
+
+		mapped_file(mapped_file const&) = delete;
+
+
+		~mapped_file(){
+			if(base_) ::munmap(base_, size_);
+		}
+
+
+		mapped_file& operator=(mapped_file&& other)noexcept{
+			if(this == &other) return *this;
+			if(base_) ::munmap(base_, size_);
+
+			base_ = other.base_;
+			data_ = other.data_;
+			size_ = other.size_;
+
+			other.base_ = nullptr;
+			other.data_ = nullptr;
+			other.size_ = 0;
+
+			return *this;
+		}
+
+		mapped_file& operator=(mapped_file const&) = delete;
+
+
+		void* data()const noexcept{
+			return data_;
+		}
+
+		/// \brief Write dirty pages back to the file
+		void sync()const{
+			if(base_ && ::msync(base_, size_, MS_SYNC) != 0){
+				throw std::system_error(errno, std::generic_category(),
+					"mmap_matrix: msync failed");
+			}
+		}
+
+
+	private:
+		void advise(mmap_hints hints)noexcept{
+			int advice = MADV_NORMAL;
+			switch(hints.advice){
+				case mmap_advice::normal: break;
+				case mmap_advice::sequential: advice = MADV_SEQUENTIAL; break;
+				case mmap_advice::random: advice = MADV_RANDOM; break;
+				case mmap_advice::will_need: advice = MADV_WILLNEED; break;
+			}
+
+#ifndef MAP_POPULATE
+			if(hints.populate) advice = MADV_WILLNEED;
+#endif
+
+			// Advice is only a hint, failure is not an error
+			if(advice != MADV_NORMAL) ::madvise(base_, size_, advice);
+		}
+
+		void* base_ = nullptr;
+		void* data_ = nullptr;
+		size_t size_ = 0;
+	};
+
+
+	template < typename T, col_t C, row_t R >
+	mapped_file map_matrix_file(
+		col< C != 0_C, C > c, row< R != 0_R, R > r,
+		std::string const& filename, bool writable, size_t offset,
+		mmap_hints hints
+	){
+		if(offset % alignof(T) != 0){
+			throw std::logic_error("mmap_matrix: offset " +
+				std::to_string(offset) + " is not aligned for the value type");
+		}
+
+		return mapped_file(filename, writable, offset,
+			size_t(c) * size_t(r) * sizeof(T), hints);
+	}
+
+
+	template < typename T, col_t C, row_t R >
+	class mmap_matrix_impl final: auto_dim_pair_t< C, R >{
+	public:
+		static_assert(!std::is_const_v< T >, "use const_mmap_matrix");
+		static_assert(!std::is_reference_v< T >);
+		static_assert(std::is_trivially_copyable_v< T >,
+			"mmap_matrix value type must be trivially copyable");
+
+
+		/// \brief Type of the data that administrates the matrix
+		using value_type = T;
+
+		/// \brief Type with the make functions
+		using maker_type = maker::mmap_t;
+
+
+		mmap_matrix_impl(
+			col< C != 0_C, C > c, row< R != 0_R, R > r,
+			std::string const& filename, size_t offset, mmap_hints hints
+		):
+			auto_dim_pair_t< C, R >(c, r),
+			file_(map_matrix_file< T, C, R >(
+				c, r, filename, true, offset, hints)),
+			values_(static_cast< value_type* >(file_.data()))
+			{}
+
+		mmap_matrix_impl(mmap_matrix_impl&&) = default;
+
+		mmap_matrix_impl(mmap_matrix_impl const&) = delete;
+
+
+		mmap_matrix_impl& operator=(mmap_matrix_impl&&) = default;
+
+		mmap_matrix_impl& operator=(mmap_matrix_impl const&) = delete;
+
+
+		using auto_dim_pair_t< C, R >::cols;
+		using auto_dim_pair_t< C, R >::rows;
+
+
+		value_type& operator()(c_t c, r_t r){
+			return values_[size_t(r) * size_t(this->cols()) + size_t(c)];
+		}
+
+		value_type const& operator()(c_t c, r_t r)const{
+			return values_[size_t(r) * size_t(this->cols()) + size_t(c)];
+		}
+
+
+		value_type* data(){
+			return values_;
+		}
+
+		value_type const* data()const{
+			return values_;
+		}
+
+
+		/// \brief Write modified values back to the file
+		void sync()const{
+			file_.sync();
+		}
+
+
+	private:
+		mapped_file file_;
+		value_type* values_;
+	};
+
+
+	template < typename T, col_t C, row_t R >
+	class const_mmap_matrix_impl final: auto_dim_pair_t< C, R >{
+	public:
+		static_assert(!std::is_const_v< T >,
+			"Use T without const qualifier");
+		static_assert(!std::is_reference_v< T >);
+		static_assert(std::is_trivially_copyable_v< T >,
+			"mmap_matrix value type must be trivially copyable");
+
+
+		/// \brief Type of the data that administrates the matrix
+		using value_type = T;
+
+		/// \brief Type with the make functions
+		using maker_type = maker::const_mmap_t;
+
+
+		const_mmap_matrix_impl(
+			col< C != 0_C, C > c, row< R != 0_R, R > r,
+			std::string const& filename, size_t offset, mmap_hints hints
+		):
+			auto_dim_pair_t< C, R >(c, r),
+			file_(map_matrix_file< T, C, R >(
+				c, r, filename, false, offset, hints)),
+			values_(static_cast< value_type const* >(file_.data()))
+			{}
+
+		const_mmap_matrix_impl(const_mmap_matrix_impl&&) = default;
+
+		const_mmap_matrix_impl(const_mmap_matrix_impl const&) = delete;
+
+
+		const_mmap_matrix_impl& operator=(const_mmap_matrix_impl&&)
+			= default;
+
+		const_mmap_matrix_impl& operator=(const_mmap_matrix_impl const&)
+			= delete;
+
+
+		using auto_dim_pair_t< C, R >::cols;
+		using auto_dim_pair_t< C, R >::rows;
+
+
+		value_type const& operator()(c_t c, r_t r)const{
+			return values_[size_t(r) * size_t(this->cols()) + size_t(c)];
+		}
+
+
+		value_type const* data()const{
+			return values_;
+		}
+
+
+	private:
+		mapped_file file_;
+		value_type const* values_;
+	};
+
+
+}
+
+
+namespace mitrax::maker{
+
+
+	template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+	auto mmap_t::by_file(
+		col< Cct, C > c, row< Rct, R > r,
+		std::string const& filename, size_t offset, mmap_hints hints
+	)const{
+		return mmap_matrix< T, Cct ? C : 0_C, Rct ? R : 0_R >{
+			init, c, r, filename, offset, hints};
+	}
+
+	constexpr auto mmap = mmap_t();
+
+
+	template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+	auto const_mmap_t::by_file(
+		col< Cct, C > c, row< Rct, R > r,
+		std::string const& filename, size_t offset, mmap_hints hints
+	)const{
+		return const_mmap_matrix< T, Cct ? C : 0_C, Rct ? R : 0_R >{
+			init, c, r, filename, offset, hints};
+	}
+
+	constexpr auto const_mmap = const_mmap_t();
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Map a row-wise raw file read-write as matrix
+	///
+	/// The first value starts \p offset bytes after the beginning of the
+	/// file, this skips a file header. Changes are written to the file.
+	template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+	auto make_mmap_matrix(
+		col< Cct, C > c, row< Rct, R > r,
+		std::string const& filename, size_t offset = 0,
+		mmap_hints hints = mmap_hints()
+	){
+		return maker::mmap.by_file< T >(c, r, filename, offset, hints);
+	}
+
+	template < typename T, bool Dct, dim_t D >
+	auto make_mmap_matrix(
+		dim< Dct, D > d,
+		std::string const& filename, size_t offset = 0,
+		mmap_hints hints = mmap_hints()
+	){
+		return make_mmap_matrix< T >(
+			d.as_col(), d.as_row(), filename, offset, hints);
+	}
+
+	template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+	auto make_mmap_matrix(
+		dim_pair_t< Cct, C, Rct, R > const& d,
+		std::string const& filename, size_t offset = 0,
+		mmap_hints hints = mmap_hints()
+	){
+		return make_mmap_matrix< T >(
+			d.cols(), d.rows(), filename, offset, hints);
+	}
+
+
+	/// \brief Map a row-wise raw file read-only as matrix
+	template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+	auto make_const_mmap_matrix(
+		col< Cct, C > c, row< Rct, R > r,
+		std::string const& filename, size_t offset = 0,
+		mmap_hints hints = mmap_hints()
+	){
+		return maker::const_mmap.by_file< T >(c, r, filename, offset, hints);
+	}
+
+	template < typename T, bool Dct, dim_t D >
+	auto make_const_mmap_matrix(
+		dim< Dct, D > d,
+		std::string const& filename, size_t offset = 0,
+		mmap_hints hints = mmap_hints()
+	){
+		return make_const_mmap_matrix< T >(
+			d.as_col(), d.as_row(), filename, offset, hints);
+	}
+
+	template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+	auto make_const_mmap_matrix(
+		dim_pair_t< Cct, C, Rct, R > const& d,
+		std::string const& filename, size_t offset = 0,
+		mmap_hints hints = mmap_hints()
+	){
+		return make_const_mmap_matrix< T >(
+			d.cols(), d.rows(), filename, offset, hints);
+	}
+
+
+}
+
+
+#endif
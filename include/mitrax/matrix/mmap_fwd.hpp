@@ -0,0 +1,114 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__matrix__mmap_fwd__hpp_INCLUDED_
+#define _mitrax__matrix__mmap_fwd__hpp_INCLUDED_
+
+#include "../matrix_interface.hpp"
+
+#include <string>
+
+
+namespace mitrax::detail{
+
+
+	template < typename T, col_t C, row_t R >
+	class mmap_matrix_impl;
+
+	template < typename T, col_t C, row_t R >
+	class const_mmap_matrix_impl;
+
+
+}
+
+
+namespace mitrax{
+
+
+	template < typename T, col_t C, row_t R >
+	using mmap_matrix =
+		matrix< detail::mmap_matrix_impl< T, C, R >, C, R >;
+
+	template < typename T, dim_t D >
+	using mmap_square_matrix = mmap_matrix< T, col_t(D), row_t(D) >;
+
+	template < typename T, row_t R >
+	using mmap_col_vector = mmap_matrix< T, 1_C, R >;
+
+	template < typename T, col_t C >
+	using mmap_row_vector = mmap_matrix< T, C, 1_R >;
+
+	template < typename T >
+	using mmap_bitmap = mmap_matrix< T, 0_C, 0_R >;
+
+
+	template < typename T, col_t C, row_t R >
+	using const_mmap_matrix =
+		matrix< detail::const_mmap_matrix_impl< T, C, R >, C, R >;
+
+	template < typename T, dim_t D >
+	using const_mmap_square_matrix =
+		const_mmap_matrix< T, col_t(D), row_t(D) >;
+
+	template < typename T, row_t R >
+	using const_mmap_col_vector = const_mmap_matrix< T, 1_C, R >;
+
+	template < typename T, col_t C >
+	using const_mmap_row_vector = const_mmap_matrix< T, C, 1_R >;
+
+	template < typename T >
+	using const_mmap_bitmap = const_mmap_matrix< T, 0_C, 0_R >;
+
+
+	/// \brief Expected access pattern of a mapped file (see madvise)
+	enum class mmap_advice{
+		normal,
+		sequential,
+		random,
+		will_need
+	};
+
+	/// \brief Hints for the kernel how to back a mapped matrix
+	struct mmap_hints{
+		/// \brief Prefault all pages at construction (MAP_POPULATE)
+		bool populate = false;
+
+		/// \brief Access pattern advice for the whole mapping
+		mmap_advice advice = mmap_advice::normal;
+	};
+
+
+}
+
+
+namespace mitrax::maker{
+
+
+	struct mmap_t: key{
+		template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+		auto by_file(
+			col< Cct, C > c, row< Rct, R > r,
+			std::string const& filename, size_t offset = 0,
+			mmap_hints hints = mmap_hints()
+		)const;
+	};
+
+	struct const_mmap_t: key{
+		template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+		auto by_file(
+			col< Cct, C > c, row< Rct, R > r,
+			std::string const& filename, size_t offset = 0,
+			mmap_hints hints = mmap_hints()
+		)const;
+	};
+
+
+}
+
+
+#endif
@@ -0,0 +1,360 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__matrix__sparse__hpp_INCLUDED_
+#define _mitrax__matrix__sparse__hpp_INCLUDED_
+
+#include "sparse_fwd.hpp"
+
+#include "../iterator/function.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+
+namespace mitrax::detail{
+
+
+	template < typename Impl >
+	struct sparse_value_fn{
+		decltype(auto) operator()(size_t i)const{
+			auto const cols = size_t(impl->cols());
+			return (*impl)(c_t(i % cols), r_t(i / cols));
+		}
+
+		Impl* impl;
+	};
+
+
+	template < typename T, typename Layout, col_t C, row_t R >
+	class sparse_matrix_impl final: auto_dim_pair_t< C, R >{
+	public:
+		static_assert(!std::is_const_v< T >);
+		static_assert(!std::is_reference_v< T >);
+		static_assert(
+			std::is_same_v< Layout, layout::row_major > ||
+			std::is_same_v< Layout, layout::col_major >,
+			"sparse matrices are compressed by rows or by columns");
+
+
+		/// \brief Type of the data that administrates the matrix
+		using value_type = T;
+
+		/// \brief Type with the make functions
+		using maker_type = maker::sparse_t< Layout >;
+
+		/// \brief row_major for compressed rows, col_major for compressed
+		///        columns
+		using layout_type = Layout;
+
+		/// \brief true if the values are compressed by rows
+		static constexpr bool compressed_rows =
+			std::is_same_v< Layout, layout::row_major >;
+
+
+		sparse_matrix_impl(default_constructor_key):
+			offsets_((compressed_rows ? size_t(R) : size_t(C)) + 1, 0)
+			{}
+
+		sparse_matrix_impl(
+			col< C != 0_C, C > c, row< R != 0_R, R > r,
+			std::vector< size_t >&& offsets,
+			std::vector< size_t >&& indices,
+			std::vector< value_type >&& values
+		):
+			auto_dim_pair_t< C, R >(c, r),
+			offsets_(std::move(offsets)),
+			indices_(std::move(indices)),
+			values_(std::move(values))
+			{}
+
+		sparse_matrix_impl(sparse_matrix_impl&&) = default;
+
+		sparse_matrix_impl(sparse_matrix_impl const&) = default;
+
+
+		sparse_matrix_impl& operator=(sparse_matrix_impl&&) = default;
+
+		sparse_matrix_impl& operator=(sparse_matrix_impl const&) = default;
+
+
+		using auto_dim_pair_t< C, R >::cols;
+		using auto_dim_pair_t< C, R >::rows;
+
+
+		/// \brief Stored value or value_type(), binary search in the row
+		///        or column
+		value_type operator()(c_t c, r_t r)const{
+			auto const outer = compressed_rows ? size_t(r) : size_t(c);
+			auto const inner = compressed_rows ? size_t(c) : size_t(r);
+
+			auto const first = indices_.begin() + offsets_[outer];
+			auto const last = indices_.begin() + offsets_[outer + 1];
+			auto const pos = std::lower_bound(first, last, inner);
+			if(pos == last || *pos != inner) return value_type();
+			return values_[size_t(pos - indices_.begin())];
+		}
+
+
+		/// \brief Row-wise iteration over all values including the zeros
+		auto begin()const{
+			return make_function_iterator(
+				sparse_value_fn< sparse_matrix_impl const >{this});
+		}
+
+		auto end()const{
+			return make_function_iterator(
+				sparse_value_fn< sparse_matrix_impl const >{this},
+				size_t(this->cols()) * size_t(this->rows()));
+		}
+
+
+		/// \brief Count of stored values
+		size_t nonzeros()const{
+			return values_.size();
+		}
+
+		/// \brief Position of the first stored value of every row (CSR)
+		///        or column (CSC) and the count of stored values
+		std::vector< size_t > const& offsets()const{
+			return offsets_;
+		}
+
+		/// \brief Column (CSR) or row (CSC) of every stored value,
+		///        ascending within a row or column
+		std::vector< size_t > const& indices()const{
+			return indices_;
+		}
+
+		/// \brief Stored values, may be modified without changing the
+		///        sparsity pattern
+		std::vector< value_type >& values(){
+			return values_;
+		}
+
+		std::vector< value_type > const& values()const{
+			return values_;
+		}
+
+
+		template < typename Iter >
+		void reinit_iter(Iter iter){
+			*this = maker_type().by_sequence
+				(this->cols(), this->rows(), iter).impl();
+		}
+
+
+	private:
+		std::vector< size_t > offsets_;
+		std::vector< size_t > indices_;
+		std::vector< value_type > values_;
+	};
+
+
+}
+
+
+namespace mitrax::maker{
+
+
+	template < typename Layout >
+	template < typename Iter, bool Cct, col_t C, bool Rct, row_t R >
+	sparse_matrix< iter_type_t< Iter >, Layout,
+		Cct ? C : 0_C, Rct ? R : 0_R >
+	sparse_t< Layout >::by_sequence(
+		col< Cct, C > c, row< Rct, R > r, Iter iter
+	)const{
+		using value_type = iter_type_t< Iter >;
+
+		// The sequence is row-wise
+		std::vector< sparse_triplet< value_type > > triplets;
+		for(size_t y = 0; y < size_t(r); ++y){
+			for(size_t x = 0; x < size_t(c); ++x, ++iter){
+				value_type v = *iter;
+				if(v == value_type()) continue;
+				triplets.push_back({c_t(x), r_t(y), std::move(v)});
+			}
+		}
+
+		return by_triplets< value_type >(
+			c, r, triplets.begin(), triplets.end());
+	}
+
+	template < typename Layout >
+	template < typename T, bool Cct, col_t C, bool Rct, row_t R,
+		typename Iter >
+	sparse_matrix< T, Layout, Cct ? C : 0_C, Rct ? R : 0_R >
+	sparse_t< Layout >::by_triplets(
+		col< Cct, C > c, row< Rct, R > r, Iter first, Iter last
+	)const{
+		constexpr bool compressed_rows =
+			std::is_same_v< Layout, layout::row_major >;
+
+		auto const outer_count = compressed_rows ? size_t(r) : size_t(c);
+		auto const inner_count = compressed_rows ? size_t(c) : size_t(r);
+
+		std::vector< size_t > outer;
+		std::vector< size_t > inner;
+		std::vector< T > value;
+		for(; first != last; ++first){
+			auto const& t = *first;
+			if(size_t(t.c) >= size_t(c) || size_t(t.r) >= size_t(r)){
+				throw std::logic_error(
+					"sparse matrix triplet out of range");
+			}
+
+			outer.push_back(compressed_rows ? size_t(t.r) : size_t(t.c));
+			inner.push_back(compressed_rows ? size_t(t.c) : size_t(t.r));
+			value.push_back(static_cast< T >(t.value));
+		}
+
+		// Stable counting sorts by inner and then by outer index
+		auto const n = value.size();
+		std::vector< size_t > count(std::max(outer_count, inner_count) + 1);
+		auto const counting_sort = [&count](
+			std::vector< size_t > const& key, size_t key_count,
+			std::vector< size_t > const& in, std::vector< size_t >& out
+		){
+			std::fill(count.begin(), count.begin() + key_count + 1, 0);
+			for(auto const i: in) ++count[key[i] + 1];
+			std::partial_sum(count.begin(), count.begin() + key_count + 1,
+				count.begin());
+			for(auto const i: in) out[count[key[i]]++] = i;
+		};
+
+		std::vector< size_t > order(n);
+		std::vector< size_t > sorted(n);
+		std::iota(order.begin(), order.end(), size_t(0));
+		counting_sort(inner, inner_count, order, sorted);
+		counting_sort(outer, outer_count, sorted, order);
+
+		std::vector< size_t > offsets(outer_count + 1, 0);
+		std::vector< size_t > indices;
+		std::vector< T > values;
+		indices.reserve(n);
+		values.reserve(n);
+		for(size_t k = 0; k < n; ++k){
+			auto const i = order[k];
+			if(k > 0){
+				auto const j = order[k - 1];
+				if(outer[i] == outer[j] && inner[i] == inner[j]){
+					values.back() += value[i];
+					continue;
+				}
+			}
+
+			indices.push_back(inner[i]);
+			values.push_back(value[i]);
+			++offsets[outer[i] + 1];
+		}
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+		return {init, c, r,
+			std::move(offsets), std::move(indices), std::move(values)};
+	}
+
+	template < typename Layout >
+	template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+	sparse_matrix< T, Layout, Cct ? C : 0_C, Rct ? R : 0_R >
+	sparse_t< Layout >::by_compressed(
+		col< Cct, C > c, row< Rct, R > r,
+		std::vector< size_t > offsets,
+		std::vector< size_t > indices,
+		std::vector< T > values
+	)const{
+		constexpr bool compressed_rows =
+			std::is_same_v< Layout, layout::row_major >;
+
+		auto const outer_count = compressed_rows ? size_t(r) : size_t(c);
+		auto const inner_count = compressed_rows ? size_t(c) : size_t(r);
+
+		auto valid =
+			offsets.size() == outer_count + 1 &&
+			offsets.front() == 0 &&
+			offsets.back() == indices.size() &&
+			indices.size() == values.size();
+
+		for(size_t o = 0; valid && o < outer_count; ++o){
+			valid = offsets[o] <= offsets[o + 1] &&
+				offsets[o + 1] <= indices.size();
+			for(auto k = offsets[o]; valid && k < offsets[o + 1]; ++k){
+				valid = indices[k] < inner_count &&
+					(k == offsets[o] || indices[k - 1] < indices[k]);
+			}
+		}
+
+		if(!valid){
+			throw std::logic_error("sparse matrix with invalid compressed "
+				"storage");
+		}
+
+		return {init, c, r,
+			std::move(offsets), std::move(indices), std::move(values)};
+	}
+
+	constexpr auto csr = sparse_t< layout::row_major >();
+
+	constexpr auto csc = sparse_t< layout::col_major >();
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Sparse matrix of the triplets, values at the same position
+	///        are summed up
+	///
+	/// Construction sorts the triplets in O(triplets + cols + rows).
+	template < typename Layout = layout::row_major,
+		bool Cct, col_t C, bool Rct, row_t R, typename Range >
+	auto make_sparse_matrix(
+		col< Cct, C > c, row< Rct, R > r, Range const& triplets
+	){
+		using value_type =
+			std::decay_t< decltype(std::begin(triplets)->value) >;
+
+		return maker::sparse_t< Layout >().template by_triplets< value_type >(
+			c, r, std::begin(triplets), std::end(triplets));
+	}
+
+	template < typename Layout = layout::row_major,
+		bool Cct, col_t C, bool Rct, row_t R, typename Range >
+	auto make_sparse_matrix(
+		dim_pair_t< Cct, C, Rct, R > const& d, Range const& triplets
+	){
+		return make_sparse_matrix< Layout >(d.cols(), d.rows(), triplets);
+	}
+
+
+	/// \brief Transposed matrix, a copy of the compressed storage
+	///
+	/// The compressed rows of m are the compressed columns of the result
+	/// and vice versa.
+	template < typename T, typename Layout, col_t C, row_t R >
+	auto transpose(sparse_matrix< T, Layout, C, R > const& m){
+		using transposed = std::conditional_t<
+			std::is_same_v< Layout, layout::row_major >,
+			layout::col_major, layout::row_major >;
+
+		auto const& impl = m.impl();
+		return maker::sparse_t< transposed >().by_compressed(
+			m.rows().as_col(), m.cols().as_row(),
+			impl.offsets(), impl.indices(), impl.values());
+	}
+
+
+}
+
+
+#endif
@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__matrix__sparse_fwd__hpp_INCLUDED_
+#define _mitrax__matrix__sparse_fwd__hpp_INCLUDED_
+
+#include "../matrix_interface.hpp"
+#include "../layout.hpp"
+
+#include <vector>
+
+
+namespace mitrax::detail{
+
+
+	template < typename T, typename Layout, col_t C, row_t R >
+	class sparse_matrix_impl;
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Matrix which stores only its non zero values
+	///
+	/// With layout::row_major the values are compressed by rows (CSR),
+	/// with layout::col_major by columns (CSC).
+	template < typename T, typename Layout, col_t C, row_t R >
+	using sparse_matrix =
+		matrix< detail::sparse_matrix_impl< T, Layout, C, R >, C, R >;
+
+	template < typename T, col_t C, row_t R >
+	using csr_matrix = sparse_matrix< T, layout::row_major, C, R >;
+
+	template < typename T, col_t C, row_t R >
+	using csc_matrix = sparse_matrix< T, layout::col_major, C, R >;
+
+
+	/// \brief Value at position (c, r) for the construction of a sparse
+	///        matrix
+	template < typename T >
+	struct sparse_triplet{
+		c_t c;
+		r_t r;
+		T value;
+	};
+
+
+}
+
+
+namespace mitrax::maker{
+
+
+	template < typename Layout >
+	struct sparse_t: key{
+		/// \brief Stores the non zero values of the sequence
+		template < typename Iter, bool Cct, col_t C, bool Rct, row_t R >
+		sparse_matrix< iter_type_t< Iter >, Layout,
+			Cct ? C : 0_C, Rct ? R : 0_R >
+		by_sequence(col< Cct, C > c, row< Rct, R > r, Iter iter)const;
+
+		/// \brief Stores the values of the triplets, values at the same
+		///        position are summed up
+		template < typename T, bool Cct, col_t C, bool Rct, row_t R,
+			typename Iter >
+		sparse_matrix< T, Layout, Cct ? C : 0_C, Rct ? R : 0_R >
+		by_triplets(
+			col< Cct, C > c, row< Rct, R > r, Iter first, Iter last
+		)const;
+
+		/// \brief Takes compressed rows (CSR) or columns (CSC) as they are
+		///
+		/// Throws std::logic_error if the arrays are inconsistent.
+		template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+		sparse_matrix< T, Layout, Cct ? C : 0_C, Rct ? R : 0_R >
+		by_compressed(
+			col< Cct, C > c, row< Rct, R > r,
+			std::vector< size_t > offsets,
+			std::vector< size_t > indices,
+			std::vector< T > values
+		)const;
+	};
+
+
+}
+
+
+#endif
@@ -0,0 +1,728 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__matrix__tiled__hpp_INCLUDED_
+#define _mitrax__matrix__tiled__hpp_INCLUDED_
+
+#include "tiled_fwd.hpp"
+
+#include "../iterator/function.hpp"
+
+#include <unordered_map>
+#include <filesystem>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <future>
+#include <random>
+#include <memory>
+#include <list>
+
+
+namespace mitrax::tile_codec{
+
+
+	/// \brief Store tile values uncompressed
+	struct raw{
+		template < typename T >
+		static void encode(std::ostream& os, T const* values, size_t count){
+			os.write(reinterpret_cast< char const* >(values),
+				count * sizeof(T));
+		}
+
+		template < typename T >
+		static void decode(std::istream& is, T* values, size_t count){
+			is.read(reinterpret_cast< char* >(values), count * sizeof(T));
+		}
+	};
+
+
+	/// \brief Store runs of bitwise equal values as count and value
+	///
+	/// Efficient for masks and images with large uniform areas.
+	struct rle{
+		template < typename T >
+		static void encode(std::ostream& os, T const* values, size_t count){
+			for(size_t i = 0; i < count;){
+				std::uint32_t run = 1;
+				while(
+					i + run < count &&
+					run < std::numeric_limits< std::uint32_t >::max() &&
+					std::memcmp(values + i + run, values + i, sizeof(T)) == 0
+				) ++run;
+
+				os.write(reinterpret_cast< char const* >(&run), sizeof(run));
+				os.write(reinterpret_cast< char const* >(values + i),
+					sizeof(T));
+				i += run;
+			}
+		}
+
+		template < typename T >
+		static void decode(std::istream& is, T* values, size_t count){
+			for(size_t i = 0; i < count;){
+				std::uint32_t run = 0;
+				T value;
+				is.read(reinterpret_cast< char* >(&run), sizeof(run));
+				is.read(reinterpret_cast< char* >(&value), sizeof(T));
+				if(!is || run == 0 || run > count - i){
+					is.setstate(std::ios::failbit);
+					return;
+				}
+
+				std::fill(values + i, values + i + run, value);
+				i += run;
+			}
+		}
+	};
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Create a new, empty directory for temporary tile files
+	inline std::filesystem::path make_tile_directory(){
+		static std::mt19937_64 engine(std::random_device{}());
+		static std::mutex mutex;
+
+		auto const base = std::filesystem::temp_directory_path();
+		for(;;){
+			std::uint64_t id;
+			{
+				std::lock_guard< std::mutex > lock(mutex);
+				id = engine();
+			}
+
+			auto path = base / ("mitrax_tiles_" + std::to_string(id));
+			if(std::filesystem::create_directory(path)) return path;
+		}
+	}
+
+
+	/// \brief Bounded LRU set of resident tiles, backed by one file per tile
+	///
+	/// Tiles have a fixed size, tiles at the right and bottom border are
+	/// padded. A tile without file has value_type() in all values.
+	///
+	/// All member functions lock the cache, so get and set may be called
+	/// concurrently. Pointers from tile and create are only safe while no
+	/// other thread accesses the cache.
+	template < typename T, typename Codec >
+	class tile_cache final{
+	public:
+		static_assert(std::is_trivially_copyable_v< T >,
+			"tiled_matrix value type must be trivially copyable");
+
+
+		tile_cache(size_t cols, size_t rows, tiled_options const& options):
+			tile_cols_(options.tile_cols),
+			tile_rows_(options.tile_rows),
+			cache_size_(options.cache_size),
+			prefetch_(options.prefetch),
+			tiles_per_row_(
+				options.tile_cols > 0
+					? (cols + options.tile_cols - 1) / options.tile_cols : 0),
+			tiles_per_col_(
+				options.tile_rows > 0
+					? (rows + options.tile_rows - 1) / options.tile_rows : 0),
+			owned_(options.directory.empty()),
+			directory_(owned_
+				? make_tile_directory()
+				: std::filesystem::path(options.directory))
+		{
+			if(tile_cols_ == 0 || tile_rows_ == 0){
+				throw std::logic_error("tiled_matrix: tile size is 0");
+			}
+
+			// Copying a value between two tiles needs both in memory
+			if(cache_size_ < 2){
+				throw std::logic_error("tiled_matrix: cache size is less "
+					"than 2");
+			}
+
+			if(!owned_) std::filesystem::create_directories(directory_);
+		}
+
+		tile_cache(tile_cache const&) = delete;
+
+		tile_cache& operator=(tile_cache const&) = delete;
+
+		~tile_cache(){
+			// Wait for running prefetches before touching the directory
+			pending_.clear();
+
+			if(owned_){
+				std::error_code ec;
+				std::filesystem::remove_all(directory_, ec);
+			}else{
+				try{
+					flush();
+				}catch(...){}
+			}
+		}
+
+
+		size_t tile_cols()const{ return tile_cols_; }
+		size_t tile_rows()const{ return tile_rows_; }
+		size_t tiles_per_row()const{ return tiles_per_row_; }
+		size_t tiles_per_col()const{ return tiles_per_col_; }
+
+		tiled_options options()const{
+			return {tile_cols_, tile_rows_, cache_size_, prefetch_, {}};
+		}
+
+
+		/// \brief Copy of a value, does not mark its tile as modified
+		T get(size_t c, size_t r){
+			std::lock_guard< std::mutex > lock(mutex_);
+			return value(c, r, false);
+		}
+
+		/// \brief Overwrite a value and mark its tile as modified
+		void set(size_t c, size_t r, T const& v){
+			std::lock_guard< std::mutex > lock(mutex_);
+			value(c, r, true) = v;
+		}
+
+		/// \brief Values of a tile, valid until another tile is accessed
+		T* tile(size_t index, bool modify){
+			std::lock_guard< std::mutex > lock(mutex_);
+			return find(index, modify);
+		}
+
+		/// \brief Replace a tile by value_type() without reading its file
+		T* create(size_t index){
+			std::lock_guard< std::mutex > lock(mutex_);
+			pending_.erase(index);
+
+			auto const iter = map_.find(index);
+			if(iter != map_.end()){
+				lru_.erase(iter->second);
+				map_.erase(iter);
+			}
+
+			auto values = std::make_unique< T[] >(tile_size());
+			return insert(index, std::move(values), true).values.get();
+		}
+
+		/// \brief Start an asynchronous read of a tile
+		void prefetch(size_t index){
+			std::lock_guard< std::mutex > lock(mutex_);
+			start_prefetch(index);
+		}
+
+		/// \brief Write all modified resident tiles
+		void flush(){
+			std::lock_guard< std::mutex > lock(mutex_);
+			for(auto& entry: lru_){
+				if(!entry.dirty) continue;
+				write(entry);
+				entry.dirty = false;
+			}
+		}
+
+
+	private:
+		struct entry_t{
+			size_t index;
+			std::unique_ptr< T[] > values;
+			bool dirty;
+		};
+
+		static constexpr size_t max_pending = 2;
+
+
+		size_t tile_size()const{
+			return tile_cols_ * tile_rows_;
+		}
+
+		std::filesystem::path tile_path(size_t index)const{
+			return directory_ / ("tile_" + std::to_string(index));
+		}
+
+
+		T& value(size_t c, size_t r, bool modify){
+			auto const tx = c / tile_cols_;
+			auto const ty = r / tile_rows_;
+			auto const values = find(ty * tiles_per_row_ + tx, modify);
+			return values[
+				(r - ty * tile_rows_) * tile_cols_ + (c - tx * tile_cols_)];
+		}
+
+		T* find(size_t index, bool modify){
+			// Fast path for repeated access to the same tile
+			if(!lru_.empty() && lru_.front().index == index){
+				lru_.front().dirty |= modify;
+				return lru_.front().values.get();
+			}
+
+			auto const iter = map_.find(index);
+			if(iter != map_.end()){
+				lru_.splice(lru_.begin(), lru_, iter->second);
+				lru_.front().dirty |= modify;
+				return lru_.front().values.get();
+			}
+
+			auto values = load(index);
+			auto& entry = insert(index, std::move(values), modify);
+			prefetch_next(index);
+			return entry.values.get();
+		}
+
+		void start_prefetch(size_t index){
+			if(
+				index >= tiles_per_row_ * tiles_per_col_ ||
+				map_.count(index) > 0 ||
+				pending_.count(index) > 0
+			) return;
+
+			// Bound the memory of tiles that are read ahead
+			if(pending_.size() >= max_pending) return;
+
+			pending_.emplace(index, std::async(std::launch::async,
+				&tile_cache::read, tile_path(index), tile_size()));
+		}
+
+
+		static std::unique_ptr< T[] > read(
+			std::filesystem::path const& path, size_t count
+		){
+			auto values = std::make_unique< T[] >(count);
+
+			std::ifstream is(path, std::ios::binary);
+			if(!is) return values;
+
+			Codec::decode(is, values.get(), count);
+			if(!is){
+				throw std::runtime_error("tiled_matrix: can not read tile '"
+					+ path.string() + "'");
+			}
+
+			return values;
+		}
+
+		void write(entry_t const& entry)const{
+			auto const path = tile_path(entry.index);
+			std::ofstream os(path, std::ios::binary | std::ios::trunc);
+			Codec::encode(os, entry.values.get(), tile_size());
+			if(!os.flush()){
+				throw std::runtime_error("tiled_matrix: can not write tile '"
+					+ path.string() + "'");
+			}
+		}
+
+
+		std::unique_ptr< T[] > load(size_t index){
+			auto const iter = pending_.find(index);
+			if(iter == pending_.end()){
+				return read(tile_path(index), tile_size());
+			}
+
+			auto future = std::move(iter->second);
+			pending_.erase(iter);
+			return future.get();
+		}
+
+		entry_t& insert(
+			size_t index, std::unique_ptr< T[] >&& values, bool dirty
+		){
+			while(lru_.size() >= cache_size_){
+				auto& victim = lru_.back();
+				if(victim.dirty) write(victim);
+				map_.erase(victim.index);
+				lru_.pop_back();
+			}
+
+			lru_.push_front(entry_t{index, std::move(values), dirty});
+			map_.emplace(index, lru_.begin());
+			return lru_.front();
+		}
+
+		void prefetch_next(size_t index){
+			switch(prefetch_){
+				case tile_prefetch::none: break;
+				case tile_prefetch::row_wise:
+					if((index + 1) % tiles_per_row_ != 0){
+						start_prefetch(index + 1);
+					}
+				break;
+				case tile_prefetch::col_wise:
+					start_prefetch(index + tiles_per_row_);
+				break;
+			}
+		}
+
+
+		size_t tile_cols_;
+		size_t tile_rows_;
+		size_t cache_size_;
+		tile_prefetch prefetch_;
+		size_t tiles_per_row_;
+		size_t tiles_per_col_;
+		bool owned_;
+		std::filesystem::path directory_;
+
+		/// \brief Most recently used tile at front
+		std::list< entry_t > lru_;
+		std::unordered_map< size_t, typename std::list< entry_t >::iterator >
+			map_;
+		std::unordered_map< size_t, std::future< std::unique_ptr< T[] > > >
+			pending_;
+
+		std::mutex mutex_;
+	};
+
+
+	/// \brief Reference to a value of a tiled matrix
+	///
+	/// Reading does not mark the tile as modified, only assignments do.
+	/// Every access finds the tile again, so the reference stays valid
+	/// when other tiles are accessed.
+	template < typename T, typename Codec >
+	class tiled_reference{
+	public:
+		tiled_reference(tile_cache< T, Codec >& cache, size_t c, size_t r):
+			cache_(&cache), c_(c), r_(r) {}
+
+		tiled_reference(tiled_reference const&) = default;
+
+
+		operator T()const{
+			return cache_->get(c_, r_);
+		}
+
+
+		tiled_reference const& operator=(T const& v)const{
+			cache_->set(c_, r_, v);
+			return *this;
+		}
+
+		tiled_reference const& operator=(tiled_reference const& v)const{
+			return *this = T(v);
+		}
+
+		template < typename U >
+		tiled_reference const& operator+=(U const& v)const{
+			return *this = T(*this) + v;
+		}
+
+		template < typename U >
+		tiled_reference const& operator-=(U const& v)const{
+			return *this = T(*this) - v;
+		}
+
+		template < typename U >
+		tiled_reference const& operator*=(U const& v)const{
+			return *this = T(*this) * v;
+		}
+
+		template < typename U >
+		tiled_reference const& operator/=(U const& v)const{
+			return *this = T(*this) / v;
+		}
+
+
+	private:
+		tile_cache< T, Codec >* cache_;
+		size_t c_;
+		size_t r_;
+	};
+
+
+	template < typename Impl >
+	struct tiled_value_fn{
+		decltype(auto) operator()(size_t i)const{
+			auto const cols = size_t(impl->cols());
+			return (*impl)(c_t(i % cols), r_t(i / cols));
+		}
+
+		Impl* impl;
+	};
+
+
+	template < typename T, col_t C, row_t R, typename Codec >
+	class tiled_matrix_impl final: auto_dim_pair_t< C, R >{
+	public:
+		static_assert(!std::is_const_v< T >);
+		static_assert(!std::is_reference_v< T >);
+
+
+		/// \brief Type of the data that administrates the matrix
+		using value_type = T;
+
+		/// \brief Type with the make functions
+		using maker_type = maker::tiled_t< Codec >;
+
+		/// \brief Type of the resident tile set
+		using cache_type = tile_cache< T, Codec >;
+
+
+		tiled_matrix_impl(default_constructor_key):
+			cache_(std::make_unique< cache_type >(
+				size_t(C), size_t(R), tiled_options()))
+			{}
+
+		tiled_matrix_impl(
+			col< C != 0_C, C > c, row< R != 0_R, R > r,
+			tiled_options const& options
+		):
+			auto_dim_pair_t< C, R >(c, r),
+			cache_(std::make_unique< cache_type >(
+				size_t(c), size_t(r), options))
+			{}
+
+		tiled_matrix_impl(tiled_matrix_impl&&) = default;
+
+		tiled_matrix_impl(tiled_matrix_impl const&) = delete;
+
+
+		tiled_matrix_impl& operator=(tiled_matrix_impl&&) = default;
+
+		tiled_matrix_impl& operator=(tiled_matrix_impl const&) = delete;
+
+
+		using auto_dim_pair_t< C, R >::cols;
+		using auto_dim_pair_t< C, R >::rows;
+
+
+		/// \brief Only assignments mark the tile as modified
+		tiled_reference< T, Codec > operator()(c_t c, r_t r){
+			return {*cache_, size_t(c), size_t(r)};
+		}
+
+		/// \brief Copy of the value, may be called concurrently
+		value_type operator()(c_t c, r_t r)const{
+			return cache_->get(size_t(c), size_t(r));
+		}
+
+
+		/// \brief Row-wise iteration, prefer the tile-aware for_each
+		auto begin(){
+			return make_function_iterator(
+				tiled_value_fn< tiled_matrix_impl >{this});
+		}
+
+		auto begin()const{
+			return make_function_iterator(
+				tiled_value_fn< tiled_matrix_impl const >{this});
+		}
+
+		auto end(){
+			return make_function_iterator(
+				tiled_value_fn< tiled_matrix_impl >{this}, point_count());
+		}
+
+		auto end()const{
+			return make_function_iterator(
+				tiled_value_fn< tiled_matrix_impl const >{this},
+				point_count());
+		}
+
+
+		/// \brief The resident tile set
+		cache_type& tiles()const{
+			return *cache_;
+		}
+
+		/// \brief Tile geometry and cache settings of this matrix
+		///
+		/// The directory is always empty.
+		tiled_options options()const{
+			return cache_->options();
+		}
+
+		/// \brief Start an asynchronous read of the tile with the point
+		void prefetch(c_t c, r_t r)const{
+			cache_->prefetch(
+				size_t(r) / cache_->tile_rows() * cache_->tiles_per_row() +
+				size_t(c) / cache_->tile_cols());
+		}
+
+		/// \brief Write all modified resident tiles to disk
+		void flush()const{
+			cache_->flush();
+		}
+
+
+		template < typename Iter >
+		void reinit_iter(Iter iter){
+			*this = maker_type(options()).by_sequence
+				(this->cols(), this->rows(), iter).impl();
+		}
+
+
+	private:
+		size_t point_count()const{
+			return size_t(this->cols()) * size_t(this->rows());
+		}
+
+		std::unique_ptr< cache_type > cache_;
+	};
+
+
+}
+
+
+namespace mitrax::maker{
+
+
+	template < typename Codec >
+	template < typename Iter, bool Cct, col_t C, bool Rct, row_t R >
+	tiled_matrix< iter_type_t< Iter >, Cct ? C : 0_C, Rct ? R : 0_R, Codec >
+	tiled_t< Codec >::by_sequence(
+		col< Cct, C > c, row< Rct, R > r, Iter iter
+	)const{
+		auto result = by_default< iter_type_t< Iter > >(c, r);
+		auto& tiles = result.impl().tiles();
+
+		auto const cols = size_t(c);
+		auto const rows = size_t(r);
+		auto const tc = tiles.tile_cols();
+		auto const tr = tiles.tile_rows();
+
+		if constexpr(std::is_base_of_v< std::random_access_iterator_tag,
+			typename std::iterator_traits< Iter >::iterator_category >
+		){
+			// Fill tile by tile, so every tile is written once
+			for(size_t ty = 0; ty < tiles.tiles_per_col(); ++ty){
+				for(size_t tx = 0; tx < tiles.tiles_per_row(); ++tx){
+					auto const values =
+						tiles.create(ty * tiles.tiles_per_row() + tx);
+					auto const h = std::min(tr, rows - ty * tr);
+					auto const w = std::min(tc, cols - tx * tc);
+					for(size_t y = 0; y < h; ++y){
+						auto const line = (ty * tr + y) * cols + tx * tc;
+						for(size_t x = 0; x < w; ++x){
+							values[y * tc + x] = iter[line + x];
+						}
+					}
+				}
+			}
+		}else{
+			for(size_t y = 0; y < rows; ++y){
+				for(size_t x = 0; x < cols; ++x){
+					tiles.set(x, y, *iter++);
+				}
+			}
+		}
+
+		return result;
+	}
+
+	template < typename Codec >
+	template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+	tiled_matrix< T, Cct ? C : 0_C, Rct ? R : 0_R, Codec >
+	tiled_t< Codec >::by_default(col< Cct, C > c, row< Rct, R > r)const{
+		return {init, c, r, options};
+	}
+
+	constexpr auto tiled = tiled_t<>();
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Call f for every value, processing one tile at a time
+	///
+	/// The order of the values is row-wise within each tile.
+	template < typename F, typename T, col_t C, row_t R, typename Codec >
+	void for_each(F&& f, tiled_matrix< T, C, R, Codec > const& image){
+		auto& tiles = image.impl().tiles();
+
+		auto const cols = size_t(image.cols());
+		auto const rows = size_t(image.rows());
+		auto const tc = tiles.tile_cols();
+		auto const tr = tiles.tile_rows();
+
+		for(size_t ty = 0; ty < tiles.tiles_per_col(); ++ty){
+			for(size_t tx = 0; tx < tiles.tiles_per_row(); ++tx){
+				T const* const values =
+					tiles.tile(ty * tiles.tiles_per_row() + tx, false);
+				auto const h = std::min(tr, rows - ty * tr);
+				auto const w = std::min(tc, cols - tx * tc);
+				for(size_t y = 0; y < h; ++y){
+					for(size_t x = 0; x < w; ++x){
+						f(values[y * tc + x]);
+					}
+				}
+			}
+		}
+	}
+
+
+	/// \brief Tiled matrix of f applied to every value
+	///
+	/// The result has the same tiling and cache settings in a new
+	/// temporary directory, both are processed one tile at a time.
+	template < typename F, typename T, col_t C, row_t R, typename Codec >
+	auto transform(F&& f, tiled_matrix< T, C, R, Codec > const& image){
+		using result_type = std::decay_t< decltype(f(std::declval< T >())) >;
+
+		auto result = maker::tiled_t< Codec >(image.impl().options())
+			.template by_default< result_type >(image.cols(), image.rows());
+
+		auto& in = image.impl().tiles();
+		auto& out = result.impl().tiles();
+
+		auto const cols = size_t(image.cols());
+		auto const rows = size_t(image.rows());
+		auto const tc = in.tile_cols();
+		auto const tr = in.tile_rows();
+
+		for(size_t ty = 0; ty < in.tiles_per_col(); ++ty){
+			for(size_t tx = 0; tx < in.tiles_per_row(); ++tx){
+				auto const index = ty * in.tiles_per_row() + tx;
+				T const* const values = in.tile(index, false);
+				auto const results = out.create(index);
+				auto const h = std::min(tr, rows - ty * tr);
+				auto const w = std::min(tc, cols - tx * tc);
+				for(size_t y = 0; y < h; ++y){
+					for(size_t x = 0; x < w; ++x){
+						results[y * tc + x] = f(values[y * tc + x]);
+					}
+				}
+			}
+		}
+
+		return result;
+	}
+
+
+	/// \brief Tiled matrix with value_type() in all tiles without file
+	template < typename T, typename Codec = tile_codec::raw,
+		bool Cct, col_t C, bool Rct, row_t R >
+	auto make_tiled_matrix(
+		col< Cct, C > c, row< Rct, R > r,
+		tiled_options const& options = tiled_options()
+	){
+		return maker::tiled_t< Codec >(options).template by_default< T >(c, r);
+	}
+
+	template < typename T, typename Codec = tile_codec::raw,
+		bool Cct, col_t C, bool Rct, row_t R >
+	auto make_tiled_matrix(
+		dim_pair_t< Cct, C, Rct, R > const& d,
+		tiled_options const& options = tiled_options()
+	){
+		return make_tiled_matrix< T, Codec >(d.cols(), d.rows(), options);
+	}
+
+
+}
+
+
+#endif
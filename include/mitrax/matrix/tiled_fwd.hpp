@@ -0,0 +1,111 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__matrix__tiled_fwd__hpp_INCLUDED_
+#define _mitrax__matrix__tiled_fwd__hpp_INCLUDED_
+
+#include "../matrix_interface.hpp"
+
+#include <string_view>
+
+
+namespace mitrax::tile_codec{
+
+
+	struct raw;
+	struct rle;
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	template < typename T, col_t C, row_t R, typename Codec >
+	class tiled_matrix_impl;
+
+
+}
+
+
+namespace mitrax{
+
+
+	template < typename T, col_t C, row_t R,
+		typename Codec = tile_codec::raw >
+	using tiled_matrix =
+		matrix< detail::tiled_matrix_impl< T, C, R, Codec >, C, R >;
+
+	template < typename T, typename Codec = tile_codec::raw >
+	using tiled_bitmap = tiled_matrix< T, 0_C, 0_R, Codec >;
+
+
+	/// \brief Tile that is read ahead after a cache miss
+	enum class tile_prefetch{
+		/// \brief No read ahead
+		none,
+
+		/// \brief Right neighbor tile
+		row_wise,
+
+		/// \brief Lower neighbor tile
+		col_wise
+	};
+
+	struct tiled_options{
+		/// \brief Width of a tile in values
+		size_t tile_cols = 256;
+
+		/// \brief Height of a tile in values
+		size_t tile_rows = 256;
+
+		/// \brief Maximal count of tiles in memory
+		size_t cache_size = 64;
+
+		/// \brief Read ahead along the traversal direction
+		tile_prefetch prefetch = tile_prefetch::none;
+
+		/// \brief Directory for the tile files
+		///
+		/// If empty, a temporary directory is created and removed with the
+		/// matrix. Otherwise existing tile files are used and modified
+		/// tiles are written back on destruction.
+		std::string_view directory = {};
+	};
+
+
+}
+
+
+namespace mitrax::maker{
+
+
+	template < typename Codec = tile_codec::raw >
+	struct tiled_t: key{
+		constexpr tiled_t(tiled_options const& options = tiled_options()):
+			options(options) {}
+
+		template < typename Iter, bool Cct, col_t C, bool Rct, row_t R >
+		tiled_matrix< iter_type_t< Iter >, Cct ? C : 0_C, Rct ? R : 0_R,
+			Codec >
+		by_sequence(col< Cct, C > c, row< Rct, R > r, Iter iter)const;
+
+		/// \brief Matrix with value_type() in all tiles, writes no files
+		template < typename T, bool Cct, col_t C, bool Rct, row_t R >
+		tiled_matrix< T, Cct ? C : 0_C, Rct ? R : 0_R, Codec >
+		by_default(col< Cct, C > c, row< Rct, R > r)const;
+
+		tiled_options options;
+	};
+
+
+}
+
+
+#endif
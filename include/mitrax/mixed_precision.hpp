@@ -0,0 +1,271 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__mixed_precision__hpp_INCLUDED_
+#define _mitrax__mixed_precision__hpp_INCLUDED_
+
+#include "convert.hpp"
+#include "lu_decomposition.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <cmath>
+
+
+namespace mitrax{
+
+
+	struct mixed_precision_options{
+		/// \brief Maximal count of refinement steps
+		size_t max_iterations = 10;
+
+		/// \brief Solve in full precision if the refinement does not
+		///        converge, throw std::logic_error otherwise
+		bool fallback = true;
+	};
+
+
+	/// \brief LU factorisation in precision F with iterative refinement in
+	///        precision T
+	///
+	/// The matrix is factorised in F, typically float. Every solve starts
+	/// with the F solution and corrects it with residuals b - A * x which
+	/// are calculated in T until the backward error is below the precision
+	/// of T. This converges to full T accuracy if the condition number of A
+	/// is well below 1 / epsilon of F.
+	///
+	/// If the factorisation in F fails or the residuals do not shrink, a
+	/// factorisation in T is used instead, if options.fallback is set. It
+	/// is built once, serves all later solves and is shared by copies.
+	/// solve may be called concurrently.
+	template < typename T, dim_t D, typename F = float >
+	class mixed_precision_lu_decomposition{
+	public:
+		/// \brief Type of the solutions
+		using value_type = T;
+
+		/// \brief Type of the factors
+		using factor_type = F;
+
+
+		template < typename M, col_t C, row_t R >
+		explicit mixed_precision_lu_decomposition(
+			matrix< M, C, R > const& m,
+			mixed_precision_options const& options =
+				mixed_precision_options()
+		):
+			a_(make_copy(m)),
+			a_norm_(max_row_sum(a_)),
+			options_(options)
+		{
+			try{
+				low_.emplace(a_);
+			}catch(std::logic_error const&){
+				if(!options_.fallback) throw;
+				high();
+			}
+		}
+
+
+		/// \brief Dimension of the factorised square matrix
+		auto size()const{
+			return a_.cols().as_dim();
+		}
+
+		/// \brief true if the factorisation in F was successful
+		bool mixed()const{
+			return low_.has_value();
+		}
+
+
+		/// \brief Solve A * X = B for all columns of B
+		template < typename M, col_t C, row_t R >
+		auto solve(matrix< M, C, R > const& b)const{
+			using std::abs;
+
+			auto const n = size_t(size());
+			if(size_t(b.rows()) != n){
+				throw std::logic_error("mixed_precision_lu_decomposition::"
+					"solve: incompatible dimensions");
+			}
+
+			if(high_->ready) return high_->lu->solve(convert< T >(b));
+
+			auto const bt = convert< T >(b);
+			auto x = convert< T >(low_->solve(convert< F >(bt)));
+			auto r = make_matrix_v< T >(b.dims());
+
+			auto const m = size_t(b.cols());
+			auto const count = n * m;
+			auto const ad = a_.data();
+			auto const bd = bt.data();
+			auto const xd = x.data();
+			auto const rd = r.data();
+
+			auto const max_abs = [count](T const* v){
+				T result = 0;
+				for(size_t i = 0; i < count; ++i){
+					result = std::max(result, T(abs(v[i])));
+				}
+				return result;
+			};
+
+			// Backward error criterion of LAPACK's dsgesv
+			auto const tolerance = std::sqrt(T(n)) * a_norm_ *
+				std::numeric_limits< T >::epsilon();
+			auto last = std::numeric_limits< T >::infinity();
+			for(size_t k = 0; k < options_.max_iterations; ++k){
+				// R = B - A * X in T
+				for(size_t i = 0; i < n; ++i){
+					auto const ai = ad + i * n;
+					for(size_t j = 0; j < m; ++j){
+						auto sum = bd[i * m + j];
+						for(size_t l = 0; l < n; ++l){
+							sum -= ai[l] * xd[l * m + j];
+						}
+						rd[i * m + j] = sum;
+					}
+				}
+
+				auto const scale = max_abs(rd);
+				if(scale <= tolerance * max_abs(xd)) return x;
+
+				// The residual must shrink, otherwise A is too ill
+				// conditioned for F
+				if(!(scale < last)) break;
+				last = scale;
+
+				// Scale R to avoid under- and overflow in F
+				for(size_t i = 0; i < count; ++i) rd[i] /= scale;
+
+				auto const d = low_->solve(convert< F >(r));
+				auto const dd = d.data();
+				for(size_t i = 0; i < count; ++i){
+					xd[i] += scale * static_cast< T >(dd[i]);
+				}
+			}
+
+			if(!options_.fallback){
+				throw std::logic_error("mixed_precision_lu_decomposition::"
+					"solve: iterative refinement does not converge");
+			}
+
+			return high().solve(bt);
+		}
+
+
+	private:
+		/// \brief Factorisation in T, built by the first thread which
+		///        needs it
+		struct fallback{
+			std::once_flag once;
+			std::atomic< bool > ready{false};
+			std::optional< lu_decomposition< T, D > > lu;
+		};
+
+
+		lu_decomposition< T, D > const& high()const{
+			std::call_once(high_->once, [this]{
+				high_->lu.emplace(a_);
+				high_->ready = true;
+			});
+			return *high_->lu;
+		}
+
+
+		template < typename M, col_t C, row_t R >
+		static std_square_matrix< T, D > make_copy(
+			matrix< M, C, R > const& m
+		){
+			if(size_t(m.cols()) != size_t(m.rows())){
+				throw std::logic_error("mixed_precision_lu_decomposition "
+					"with non square matrix");
+			}
+
+			auto const f = [&m](c_t c, r_t r){
+				return static_cast< T >(m(c, r));
+			};
+
+			if constexpr(D == 0_D){
+				return make_matrix_fn(dims(dim_t(size_t(m.cols()))), f);
+			}else{
+				if(size_t(m.cols()) != size_t(D)){
+					throw std::logic_error("mixed_precision_lu_decomposition: "
+						"incompatible dimensions");
+				}
+
+				return make_matrix_fn(dims< D >(), f);
+			}
+		}
+
+
+		/// \brief Maximum absolute row sum norm
+		static T max_row_sum(std_square_matrix< T, D > const& a){
+			using std::abs;
+
+			auto const n = size_t(a.cols());
+			T result = 0;
+			for(size_t i = 0; i < n; ++i){
+				T sum = 0;
+				for(size_t j = 0; j < n; ++j){
+					sum += abs(a.data()[i * n + j]);
+				}
+				result = std::max(result, sum);
+			}
+			return result;
+		}
+
+
+		std_square_matrix< T, D > a_;
+		T a_norm_;
+		mixed_precision_options options_;
+		std::optional< lu_decomposition< F, D > > low_;
+		std::shared_ptr< fallback > high_ = std::make_shared< fallback >();
+	};
+
+
+	template < typename M, col_t C, row_t R >
+	mixed_precision_lu_decomposition(matrix< M, C, R > const&)
+		-> mixed_precision_lu_decomposition< value_type_t< M >,
+			C != 0_C ? dim_t(C) : dim_t(R) >;
+
+	template < typename M, col_t C, row_t R >
+	mixed_precision_lu_decomposition(
+		matrix< M, C, R > const&, mixed_precision_options const&
+	) -> mixed_precision_lu_decomposition< value_type_t< M >,
+			C != 0_C ? dim_t(C) : dim_t(R) >;
+
+
+	/// \brief Solve A * X = B with a float factorisation and iterative
+	///        refinement in the precision of A and B
+	template <
+		typename M1, col_t C1, row_t R1,
+		typename M2, col_t C2, row_t R2 >
+	auto mixed_precision_solve(
+		matrix< M1, C1, R1 > const& a,
+		matrix< M2, C2, R2 > const& b,
+		mixed_precision_options const& options = mixed_precision_options()
+	){
+		using value_type = std::common_type_t<
+			value_type_t< M1 >, value_type_t< M2 > >;
+
+		return mixed_precision_lu_decomposition< value_type,
+			C1 != 0_C ? dim_t(C1) : dim_t(R1) >(a, options).solve(b);
+	}
+
+
+}
+
+
+#endif
@@ -0,0 +1,216 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__multi_start__hpp_INCLUDED_
+#define _mitrax__multi_start__hpp_INCLUDED_
+
+#include "gauss_newton_algorithm.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+
+namespace mitrax{
+
+
+	struct multi_start_options{
+		/// \brief Cancel the remaining runs as soon as a run reaches a cost
+		///        up to target_cost, negative for no target
+		double target_cost = -1;
+
+		/// \brief Options of every single run
+		nonlinear_options solver;
+	};
+
+
+	/// \brief Final state of one run of a multi-start solve
+	enum class multi_start_status: unsigned char{
+		/// \brief The solver stopped by itself
+		finished,
+
+		/// \brief Stopped early because another run reached the target
+		cancelled,
+
+		/// \brief Not started because another run reached the target
+		skipped,
+
+		/// \brief The solver threw an exception
+		failed
+	};
+
+
+	/// \brief Statistics of one run of a multi-start solve
+	template < typename T >
+	struct multi_start_run{
+		multi_start_status status;
+
+		/// \brief Count of iterations
+		size_t iterations;
+
+		/// \brief Cost of the result, not set for skipped or failed runs
+		T cost;
+
+		/// \brief Time of the run
+		std::chrono::nanoseconds time;
+	};
+
+
+	template < typename P, typename T >
+	struct multi_start_result{
+		/// \brief Index of the run with the lowest cost
+		size_t best;
+
+		/// \brief Parameters of the best run
+		P parameters;
+
+		/// \brief Cost of the best run
+		T cost;
+
+		/// \brief Statistics of all runs in the order of the start values
+		std::vector< multi_start_run< T > > runs;
+	};
+
+
+	/// \brief Solve from every start value in starts concurrently, by
+	///        policy, and return the best result
+	///
+	/// solve(start, options, observer) runs one solver and returns its
+	/// parameters, it must pass observer and options to the solver.
+	/// cost(parameters) is the cost of a result. Both are called
+	/// concurrently and must only read shared data.
+	///
+	/// The runs are taken in order by the calling thread and the worker
+	/// threads of detail::thread_pool, which are created once and reused
+	/// by later calls.
+	///
+	/// A run which reaches options.target_cost cancels the others, the
+	/// running ones stop after their current iteration via observer and
+	/// the waiting ones are skipped. A run which throws counts as failed.
+	/// Throws std::logic_error if no run has a result.
+	template < typename Policy, typename Starts, typename Solve,
+		typename Cost,
+		std::enable_if_t< execution::is_execution_policy_v< Policy >,
+			int > = 0 >
+	auto multi_start(
+		Policy const& policy,
+		Starts const& starts,
+		Solve const& solve,
+		Cost const& cost,
+		multi_start_options const& options = multi_start_options()
+	){
+		using clock = std::chrono::steady_clock;
+		using start_type = std::decay_t< decltype(*std::begin(starts)) >;
+		using parameter_type = std::decay_t< decltype(
+			solve(std::declval< start_type const& >(), options.solver,
+				detail::ignore_iteration())) >;
+		using value_type = std::decay_t< decltype(
+			cost(std::declval< parameter_type const& >())) >;
+
+		auto const count = detail::data_size(starts);
+
+		std::vector< std::optional< parameter_type > > results(count);
+		std::vector< multi_start_run< value_type > > runs(count,
+			multi_start_run< value_type >{multi_start_status::skipped, 0,
+				value_type(0), std::chrono::nanoseconds(0)});
+		std::atomic< bool > cancel(false);
+
+		detail::parallel_for(count, detail::execution_threads(policy),
+			[&](size_t i){
+				if(cancel) return;
+
+				auto& run = runs[i];
+				auto const begin = clock::now();
+				try{
+					bool stopped = false;
+					auto observer = [&cancel, &run, &stopped](
+						auto const& state
+					){
+						run.iterations = state.iteration;
+						stopped = cancel;
+						return !stopped;
+					};
+
+					results[i].emplace(solve(starts[i], options.solver,
+						observer));
+					run.cost = cost(*results[i]);
+					run.status = stopped ?
+						multi_start_status::cancelled :
+						multi_start_status::finished;
+
+					if(
+						options.target_cost >= 0 &&
+						run.cost <= value_type(options.target_cost)
+					) cancel = true;
+				}catch(std::exception const&){
+					results[i].reset();
+					run.status = multi_start_status::failed;
+				}
+				run.time = std::chrono::duration_cast<
+					std::chrono::nanoseconds >(clock::now() - begin);
+			});
+
+		std::optional< size_t > best;
+		for(size_t i = 0; i < count; ++i){
+			if(!results[i]) continue;
+			if(!best || runs[i].cost < runs[*best].cost) best = i;
+		}
+
+		if(!best){
+			throw std::logic_error("multi_start without any result");
+		}
+
+		return multi_start_result< parameter_type, value_type >{
+			*best, std::move(*results[*best]), runs[*best].cost,
+			std::move(runs)};
+	}
+
+
+	/// \brief levenberg_marquardt_algorithm from every start value in
+	///        starts, see multi_start
+	///
+	/// The runs share f and data. Every run is sequential, the runs are
+	/// distributed by policy. The cost is the sum of the squared
+	/// residuals of the result.
+	template < typename Policy, typename F, typename Starts, typename T,
+		typename Data,
+		std::enable_if_t< execution::is_execution_policy_v< Policy >,
+			int > = 0 >
+	auto multi_start_levenberg_marquardt(
+		Policy const& policy,
+		F const& f,
+		Starts const& starts,
+		T const& threshold,
+		T const& mu,
+		T const& beta0,
+		T const& beta1,
+		Data const& data,
+		multi_start_options const& options = multi_start_options()
+	){
+		return multi_start(policy, starts,
+			[&](auto const& start, nonlinear_options const& solver,
+				auto&& observer
+			){
+				return levenberg_marquardt_algorithm(execution::seq, f, start,
+					threshold, mu, beta0, beta1, data, solver, observer);
+			},
+			[&](auto const& parameters){
+				return residual_cost(execution::seq, f, parameters, data);
+			}, options);
+	}
+
+
+}
+
+
+#endif
@@ -0,0 +1,379 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__qr_decomposition__hpp_INCLUDED_
+#define _mitrax__qr_decomposition__hpp_INCLUDED_
+
+#include "make_matrix.hpp"
+#include "triangular.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+
+
+namespace mitrax{
+
+
+	/// \brief Householder QR factorisation: A = Q * R
+	///
+	/// R is stored in the upper triangle, the Householder vectors below
+	/// the diagonal (with an implicit leading 1). Q = H_0 * ... * H_(n-1)
+	/// with H_j = I - tau_j * v_j * v_j^T is never formed. The reflectors
+	/// are grouped into blocks of block_size which are applied in compact
+	/// WY form I - V * T * V^T, so all updates are matrix-matrix products.
+	///
+	/// A must have at least as many rows as columns.
+	template < typename T, col_t C, row_t R >
+	class qr_decomposition{
+	public:
+		/// \brief Type of the factors
+		using value_type = T;
+
+		/// \brief Count of reflectors in a WY block
+		static constexpr size_t block_size = 32;
+
+
+		template < typename M, col_t Cm, row_t Rm >
+		explicit qr_decomposition(matrix< M, Cm, Rm > const& m):
+			qr_(make_factors(m)),
+			tau_(make_vector_v< T >(qr_.cols().as_row())),
+			t_(size_t(qr_.cols()) *
+				std::min(size_t(qr_.cols()), block_size))
+		{
+			factorise();
+		}
+
+
+		/// \brief Column count of the factorised matrix
+		auto cols()const{
+			return qr_.cols();
+		}
+
+		/// \brief Row count of the factorised matrix
+		auto rows()const{
+			return qr_.rows();
+		}
+
+
+		/// \brief Calculate Q * B without forming Q
+		template < typename M, col_t Cb, row_t Rb >
+		auto apply_q(matrix< M, Cb, Rb > const& b)const{
+			auto x = copy(b, "qr_decomposition::apply_q");
+			auto const n = size_t(cols());
+			auto const p = size_t(b.cols());
+
+			std::vector< value_type_t< decltype(x) > > w;
+			auto kb = (n + block_size - 1) / block_size * block_size;
+			while(kb > 0){
+				kb -= block_size;
+				apply_block(kb, std::min(kb + block_size, n), false,
+					x.data(), p, p, w);
+			}
+
+			return x;
+		}
+
+		/// \brief Calculate Q^T * B without forming Q
+		template < typename M, col_t Cb, row_t Rb >
+		auto apply_qt(matrix< M, Cb, Rb > const& b)const{
+			auto x = copy(b, "qr_decomposition::apply_qt");
+			auto const n = size_t(cols());
+			auto const p = size_t(b.cols());
+
+			std::vector< value_type_t< decltype(x) > > w;
+			for(size_t kb = 0; kb < n; kb += block_size){
+				apply_block(kb, std::min(kb + block_size, n), true,
+					x.data(), p, p, w);
+			}
+
+			return x;
+		}
+
+
+		/// \brief Orthogonal factor (rows x rows)
+		std_square_matrix< T, dim_t(R) > q()const{
+			return apply_q(make_identity_matrix< T >(rows().as_dim()));
+		}
+
+		/// \brief Upper triangular factor (cols x rows)
+		std_matrix< T, C, R > r()const{
+			return make_matrix_fn(qr_.dims(), [this](c_t c, r_t r){
+				return size_t(c) >= size_t(r) ? qr_(c, r) : T(0);
+			});
+		}
+
+
+		/// \brief Least squares solution of A * X = B for all columns of B
+		template < typename M, col_t Cb, row_t Rb >
+		auto solve(matrix< M, Cb, Rb > const& b)const{
+			auto const y = apply_qt(b);
+			using result_type = value_type_t< decltype(y) >;
+
+			auto const n = size_t(cols());
+			auto const p = size_t(b.cols());
+			auto x = make_matrix_v< result_type >(b.cols(), cols().as_row());
+			auto const xd = x.data();
+			auto const yd = y.data();
+			auto const a = qr_.data();
+
+			for(size_t i = 0; i < n; ++i){
+				if(a[i * n + i] == T(0)){
+					throw std::logic_error(
+						"qr_decomposition::solve with rank deficient matrix");
+				}
+			}
+
+			// R * X = (Q^T * B)[0, n)
+			std::copy(yd, yd + n * p, xd);
+			detail::trsm(triangle::upper, operation::none, diag::non_unit,
+				n, p, detail::row_pointer{a, n}, detail::row_pointer{xd, p});
+
+			return x;
+		}
+
+
+	private:
+		template < typename M, col_t Cm, row_t Rm >
+		static std_matrix< T, C, R > make_factors(
+			matrix< M, Cm, Rm > const& m
+		){
+			if(size_t(m.cols()) > size_t(m.rows())){
+				throw std::logic_error(
+					"qr_decomposition with more columns than rows");
+			}
+
+			if(
+				(C != 0_C && size_t(m.cols()) != size_t(C)) ||
+				(R != 0_R && size_t(m.rows()) != size_t(R))
+			){
+				throw std::logic_error(
+					"qr_decomposition: incompatible dimensions");
+			}
+
+			auto const f = [&m](c_t c, r_t r){
+				return static_cast< T >(m(c, r));
+			};
+
+			auto const c = [&m]{
+				if constexpr(C == 0_C){
+					return mitrax::cols(col_t(size_t(m.cols())));
+				}else{
+					return mitrax::cols< C >();
+				}
+			}();
+
+			auto const r = [&m]{
+				if constexpr(R == 0_R){
+					return mitrax::rows(row_t(size_t(m.rows())));
+				}else{
+					return mitrax::rows< R >();
+				}
+			}();
+
+			return make_matrix_fn(c, r, f);
+		}
+
+		/// \brief Row-major copy of b in the common value type
+		template < typename M, col_t Cb, row_t Rb >
+		auto copy(matrix< M, Cb, Rb > const& b, char const* name)const{
+			using result_type = std::common_type_t< T, value_type_t< M > >;
+
+			if(size_t(b.rows()) != size_t(rows())){
+				throw std::logic_error(
+					std::string(name) + ": incompatible dimensions");
+			}
+
+			return make_matrix_fn(b.dims(), [&b](c_t c, r_t r){
+				return static_cast< result_type >(b(c, r));
+			});
+		}
+
+
+		/// \brief Component p of the Householder vector j
+		T v(size_t p, size_t j)const{
+			return p < j ? T(0) : p == j ? T(1)
+				: qr_.data()[p * size_t(cols()) + j];
+		}
+
+		/// \brief Element (i, j) of the triangular factor of the WY block
+		///        starting at column kb with nb reflectors
+		T& t(size_t kb, size_t nb, size_t i, size_t j){
+			return t_[kb * std::min(size_t(cols()), block_size) + i * nb + j];
+		}
+
+		T t(size_t kb, size_t nb, size_t i, size_t j)const{
+			return t_[kb * std::min(size_t(cols()), block_size) + i * nb + j];
+		}
+
+
+		/// \brief Apply the WY block [kb, ke) to the rows [kb, m) of x
+		///
+		/// Calculates (I - V * T * V^T) * X or with trans (I - V * T^T * V^T)
+		/// * X, where row p of X starts at x + p * stride and has width
+		/// elements.
+		template < typename U >
+		void apply_block(
+			size_t kb, size_t ke, bool trans,
+			U* x, size_t width, size_t stride, std::vector< U >& w
+		)const{
+			auto const m = size_t(rows());
+			auto const nb = ke - kb;
+
+			// W = V^T * X
+			w.assign(nb * width, U(0));
+			for(size_t p = kb; p < m; ++p){
+				auto const xp = x + p * stride;
+				for(size_t l = 0; l < nb && kb + l <= p; ++l){
+					auto const vl = v(p, kb + l);
+					auto const wl = w.data() + l * width;
+					for(size_t j = 0; j < width; ++j) wl[j] += vl * xp[j];
+				}
+			}
+
+			// W = T * W or W = T^T * W, in place
+			if(trans){
+				for(size_t i = nb; i-- > 0;){
+					auto const wi = w.data() + i * width;
+					auto const d = t(kb, nb, i, i);
+					for(size_t j = 0; j < width; ++j) wi[j] *= d;
+					for(size_t l = 0; l < i; ++l){
+						auto const tl = t(kb, nb, l, i);
+						auto const wl = w.data() + l * width;
+						for(size_t j = 0; j < width; ++j) wi[j] += tl * wl[j];
+					}
+				}
+			}else{
+				for(size_t i = 0; i < nb; ++i){
+					auto const wi = w.data() + i * width;
+					auto const d = t(kb, nb, i, i);
+					for(size_t j = 0; j < width; ++j) wi[j] *= d;
+					for(size_t l = i + 1; l < nb; ++l){
+						auto const tl = t(kb, nb, i, l);
+						auto const wl = w.data() + l * width;
+						for(size_t j = 0; j < width; ++j) wi[j] += tl * wl[j];
+					}
+				}
+			}
+
+			// X -= V * W
+			for(size_t p = kb; p < m; ++p){
+				auto const xp = x + p * stride;
+				for(size_t l = 0; l < nb && kb + l <= p; ++l){
+					auto const vl = v(p, kb + l);
+					auto const wl = w.data() + l * width;
+					for(size_t j = 0; j < width; ++j) xp[j] -= vl * wl[j];
+				}
+			}
+		}
+
+
+		void factorise(){
+			using std::abs;
+			using std::sqrt;
+
+			auto const n = size_t(cols());
+			auto const m = size_t(rows());
+			auto const a = qr_.data();
+			auto const tau = tau_.data();
+
+			std::vector< T > w;
+			for(size_t kb = 0; kb < n; kb += block_size){
+				auto const ke = std::min(kb + block_size, n);
+				auto const nb = ke - kb;
+
+				// Unblocked factorisation of the panel columns [kb, ke)
+				for(size_t j = kb; j < ke; ++j){
+					auto const alpha = a[j * n + j];
+					T norm2 = T(0);
+					for(size_t p = j + 1; p < m; ++p){
+						norm2 += a[p * n + j] * a[p * n + j];
+					}
+
+					if(norm2 == T(0)){
+						tau[j] = T(0);
+						continue;
+					}
+
+					auto beta = sqrt(alpha * alpha + norm2);
+					if(alpha >= T(0)) beta = -beta;
+
+					tau[j] = (beta - alpha) / beta;
+					auto const scale = T(1) / (alpha - beta);
+					for(size_t p = j + 1; p < m; ++p) a[p * n + j] *= scale;
+					a[j * n + j] = beta;
+
+					// Apply H_j to the remaining panel columns
+					auto const pc = ke - j - 1;
+					if(pc == 0) continue;
+
+					w.assign(a + j * n + j + 1, a + j * n + ke);
+					for(size_t p = j + 1; p < m; ++p){
+						auto const vp = a[p * n + j];
+						auto const ap = a + p * n + j + 1;
+						for(size_t c = 0; c < pc; ++c) w[c] += vp * ap[c];
+					}
+
+					for(size_t p = j; p < m; ++p){
+						auto const vp = v(p, j) * tau[j];
+						auto const ap = a + p * n + j + 1;
+						for(size_t c = 0; c < pc; ++c) ap[c] -= vp * w[c];
+					}
+				}
+
+				// T of the block: T(0:i, i) = -tau_i * T(0:i, 0:i) * z
+				// with z = V(:, 0:i)^T * v_i
+				for(size_t i = 0; i < nb; ++i){
+					auto const ji = kb + i;
+					t(kb, nb, i, i) = tau[ji];
+
+					w.assign(i, T(0));
+					for(size_t l = 0; l < i; ++l){
+						auto z = v(ji, kb + l);
+						for(size_t p = ji + 1; p < m; ++p){
+							z += v(p, kb + l) * a[p * n + ji];
+						}
+						w[l] = z;
+					}
+
+					for(size_t r = 0; r < i; ++r){
+						T sum = T(0);
+						for(size_t l = r; l < i; ++l){
+							sum += t(kb, nb, r, l) * w[l];
+						}
+						t(kb, nb, r, i) = -tau[ji] * sum;
+					}
+
+					for(size_t r = i + 1; r < nb; ++r) t(kb, nb, r, i) = T(0);
+				}
+
+				// Apply the block transposed to the trailing columns
+				if(ke < n){
+					apply_block(kb, ke, true, a + ke, n - ke, n, w);
+				}
+			}
+		}
+
+
+		std_matrix< T, C, R > qr_;
+		std_col_vector< T, row_t(C) > tau_;
+		std::vector< T > t_;
+	};
+
+
+	template < typename M, col_t C, row_t R >
+	qr_decomposition(matrix< M, C, R > const&)
+		-> qr_decomposition< value_type_t< M >, C, R >;
+
+
+}
+
+
+#endif
@@ -153,12 +153,12 @@ namespace mitrax{
 
 	template < typename M >
 	constexpr auto forward_ref(M& m)noexcept{
-		return ref(m);
+		return mitrax::ref(m);
 	}
 
 	template < typename M >
 	constexpr auto forward_ref(M const&& m)noexcept{
-		return ref(m);
+		return mitrax::ref(m);
 	}
 
 	template < typename M >
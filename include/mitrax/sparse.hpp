@@ -0,0 +1,340 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__sparse__hpp_INCLUDED_
+#define _mitrax__sparse__hpp_INCLUDED_
+
+#include "convert.hpp"
+#include "layout.hpp"
+#include "utility.hpp"
+#include "matrix/sparse.hpp"
+#include "detail/parallel_for.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace mitrax{
+
+
+	struct sparse_options{
+		/// \brief Count of threads, 0 for the hardware concurrency
+		size_t threads = 0;
+	};
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Smallest count of multiply-adds which is processed in
+	///        parallel
+	constexpr size_t sparse_parallel_work = size_t(1) << 16;
+
+	/// \brief Count of rows of a parallel task
+	constexpr size_t sparse_chunk_rows = 64;
+
+
+	/// \brief Count of threads for work multiply-adds
+	inline size_t sparse_threads(size_t work, size_t threads){
+		if(work < sparse_parallel_work) return 1;
+		if(threads == 0){
+			threads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		return threads;
+	}
+
+	/// \brief Call f(i) for all i in [0, count) in chunks of rows
+	template < typename F >
+	void sparse_for_rows(size_t count, size_t threads, F const& f){
+		auto const chunks = (count + sparse_chunk_rows - 1) / sparse_chunk_rows;
+		parallel_for(chunks, threads, [count, &f](size_t k){
+			auto const end = std::min((k + 1) * sparse_chunk_rows, count);
+			for(size_t i = k * sparse_chunk_rows; i < end; ++i) f(i);
+		});
+	}
+
+
+	/// \brief Compressed rows of a sparse matrix
+	template < typename T >
+	struct compressed_view{
+		size_t count;
+		size_t const* offsets;
+		size_t const* indices;
+		T const* values;
+	};
+
+	template < typename T, typename Layout, col_t C, row_t R >
+	compressed_view< T > make_compressed_view(
+		sparse_matrix< T, Layout, C, R > const& m
+	){
+		auto const& impl = m.impl();
+		return {impl.offsets().size() - 1, impl.offsets().data(),
+			impl.indices().data(), impl.values().data()};
+	}
+
+
+	/// \brief Y = A * X, the rows of A are compressed
+	///
+	/// X and Y are row-major with p columns. Every row of Y is a linear
+	/// combination of rows of X.
+	template < typename T, typename U, typename V >
+	void compressed_gather(
+		compressed_view< T > const& a, size_t p,
+		U const* x, V* y, size_t threads
+	){
+		sparse_for_rows(a.count, threads, [&a, p, x, y](size_t i){
+			auto const yi = y + i * p;
+			for(auto k = a.offsets[i]; k < a.offsets[i + 1]; ++k){
+				auto const v = a.values[k];
+				auto const xk = x + a.indices[k] * p;
+				for(size_t j = 0; j < p; ++j) yi[j] += v * xk[j];
+			}
+		});
+	}
+
+	/// \brief Y = A^T * X, the rows of A are compressed
+	///
+	/// X and Y are row-major with p columns, Y has m rows and is zero. The
+	/// rows of A are split between the threads, every thread scatters
+	/// into its own copy of Y, the copies are summed up at the end.
+	template < typename T, typename U, typename V >
+	void compressed_scatter(
+		compressed_view< T > const& a, size_t m, size_t p,
+		U const* x, V* y, size_t threads
+	){
+		auto const parts = std::min(threads, std::max(a.count, size_t(1)));
+		std::vector< V > partial((parts - 1) * m * p, V(0));
+
+		parallel_for(parts, threads, [&](size_t t){
+			auto const out = t == 0 ? y : partial.data() + (t - 1) * m * p;
+			auto const end = (t + 1) * a.count / parts;
+			for(auto i = t * a.count / parts; i < end; ++i){
+				auto const xi = x + i * p;
+				for(auto k = a.offsets[i]; k < a.offsets[i + 1]; ++k){
+					auto const v = a.values[k];
+					auto const yk = out + a.indices[k] * p;
+					for(size_t j = 0; j < p; ++j) yk[j] += v * xi[j];
+				}
+			}
+		});
+
+		if(parts == 1) return;
+
+		sparse_for_rows(m, threads, [&partial, parts, m, p, y](size_t i){
+			auto const yi = y + i * p;
+			for(size_t t = 1; t < parts; ++t){
+				auto const pi = partial.data() + ((t - 1) * m + i) * p;
+				for(size_t j = 0; j < p; ++j) yi[j] += pi[j];
+			}
+		});
+	}
+
+
+	template < typename M >
+	struct is_sparse_impl: std::false_type{};
+
+	template < typename T, typename Layout, col_t C, row_t R >
+	struct is_sparse_impl< sparse_matrix_impl< T, Layout, C, R > >:
+		std::true_type{};
+
+	template < typename M >
+	constexpr bool is_sparse_impl_v = is_sparse_impl< M >::value;
+
+
+	/// \brief Call f(pointer) with the row-major values of m
+	template < typename M, col_t C, row_t R, typename F >
+	void with_row_major_data(matrix< M, C, R > const& m, F const& f){
+		if constexpr(has_row_major_data_v< M >){
+			f(m.data());
+		}else{
+			auto const copy = convert< value_type_t< M > >(m);
+			f(copy.data());
+		}
+	}
+
+
+	/// \brief op(A) * X for sparse A and dense X
+	template < bool Transposed,
+		typename T, typename Layout, col_t C, row_t R,
+		typename M, col_t Cx, row_t Rx >
+	auto sparse_dense_product(
+		sparse_matrix< T, Layout, C, R > const& a,
+		matrix< M, Cx, Rx > const& x,
+		sparse_options const& options, char const* name
+	){
+		using value_type = std::common_type_t< T, value_type_t< M > >;
+
+		auto const inner = Transposed ? size_t(a.rows()) : size_t(a.cols());
+		if(size_t(x.rows()) != inner){
+			throw std::logic_error(
+				std::string(name) + ": incompatible dimensions");
+		}
+
+		auto const rows = [&a]{
+			if constexpr(Transposed){
+				return a.cols().as_row();
+			}else{
+				return a.rows();
+			}
+		}();
+
+		auto y = make_matrix_v< value_type >(x.cols(), rows);
+		auto const p = size_t(x.cols());
+		auto const threads = sparse_threads(
+			a.impl().nonzeros() * p, options.threads);
+
+		// A compressed by rows gathers, by columns scatters, transposed
+		// the other way around
+		constexpr bool gather =
+			std::is_same_v< Layout, layout::row_major > != Transposed;
+
+		with_row_major_data(x, [&](auto const xd){
+			auto const view = make_compressed_view(a);
+			if constexpr(gather){
+				compressed_gather(view, p, xd, y.data(), threads);
+			}else{
+				compressed_scatter(view, size_t(rows), p, xd, y.data(),
+					threads);
+			}
+		});
+
+		return y;
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief A * X for sparse A and dense X in O(stored values * cols of
+	///        X)
+	///
+	/// Compressed rows are processed in parallel, compressed columns with
+	/// one partial result per thread.
+	template <
+		typename T, typename Layout, col_t C, row_t R,
+		typename M, col_t Cx, row_t Rx >
+	auto multiply(
+		sparse_matrix< T, Layout, C, R > const& a,
+		matrix< M, Cx, Rx > const& x,
+		sparse_options const& options = sparse_options()
+	){
+		return detail::sparse_dense_product< false >(
+			a, x, options, "multiply");
+	}
+
+	/// \brief A^T * X for sparse A and dense X without forming A^T
+	template <
+		typename T, typename Layout, col_t C, row_t R,
+		typename M, col_t Cx, row_t Rx >
+	auto transpose_multiply(
+		sparse_matrix< T, Layout, C, R > const& a,
+		matrix< M, Cx, Rx > const& x,
+		sparse_options const& options = sparse_options()
+	){
+		return detail::sparse_dense_product< true >(
+			a, x, options, "transpose_multiply");
+	}
+
+	/// \brief X * A for dense X and sparse A in O(rows of X * stored
+	///        values)
+	///
+	/// The rows of X are processed in parallel.
+	template <
+		typename M, col_t Cx, row_t Rx,
+		typename T, typename Layout, col_t C, row_t R >
+	auto multiply(
+		matrix< M, Cx, Rx > const& x,
+		sparse_matrix< T, Layout, C, R > const& a,
+		sparse_options const& options = sparse_options()
+	){
+		using value_type = std::common_type_t< value_type_t< M >, T >;
+
+		if(size_t(x.cols()) != size_t(a.rows())){
+			throw std::logic_error("multiply: incompatible dimensions");
+		}
+
+		auto y = make_matrix_v< value_type >(a.cols(), x.rows());
+		auto const n = size_t(a.cols());
+		auto const k = size_t(a.rows());
+		auto const view = detail::make_compressed_view(a);
+		auto const threads = detail::sparse_threads(
+			a.impl().nonzeros() * size_t(x.rows()), options.threads);
+
+		detail::with_row_major_data(x, [&](auto const xd){
+			auto const yd = y.data();
+			detail::sparse_for_rows(size_t(x.rows()), threads,
+				[&view, n, k, xd, yd](size_t i){
+					auto const xi = xd + i * k;
+					auto const yi = yd + i * n;
+					if constexpr(std::is_same_v< Layout, layout::row_major >){
+						// Row i of Y is a combination of the rows of A
+						for(size_t l = 0; l < k; ++l){
+							auto const v = xi[l];
+							if(v == value_type_t< M >(0)) continue;
+							for(auto o = view.offsets[l];
+								o < view.offsets[l + 1]; ++o
+							){
+								yi[view.indices[o]] += v * view.values[o];
+							}
+						}
+					}else{
+						// Y(j, i) is row i of X times column j of A
+						for(size_t j = 0; j < n; ++j){
+							auto sum = value_type(0);
+							for(auto o = view.offsets[j];
+								o < view.offsets[j + 1]; ++o
+							){
+								sum += xi[view.indices[o]] * view.values[o];
+							}
+							yi[j] = sum;
+						}
+					}
+				});
+		});
+
+		return y;
+	}
+
+
+	template <
+		typename T, typename Layout, col_t C, row_t R,
+		typename M, col_t Cx, row_t Rx,
+		std::enable_if_t< !detail::is_sparse_impl_v< M >, int > = 0 >
+	auto operator*(
+		sparse_matrix< T, Layout, C, R > const& a,
+		matrix< M, Cx, Rx > const& x
+	){
+		return multiply(a, x);
+	}
+
+	template <
+		typename M, col_t Cx, row_t Rx,
+		typename T, typename Layout, col_t C, row_t R,
+		std::enable_if_t< !detail::is_sparse_impl_v< M >, int > = 0 >
+	auto operator*(
+		matrix< M, Cx, Rx > const& x,
+		sparse_matrix< T, Layout, C, R > const& a
+	){
+		return multiply(x, a);
+	}
+
+
+}
+
+
+#endif
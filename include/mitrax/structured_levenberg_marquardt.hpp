@@ -0,0 +1,672 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__structured_levenberg_marquardt__hpp_INCLUDED_
+#define _mitrax__structured_levenberg_marquardt__hpp_INCLUDED_
+
+#include "gauss_newton_algorithm.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <cmath>
+
+
+namespace mitrax{
+
+
+	template < typename T >
+	class structured_problem;
+
+	template < typename T, typename O = detail::ignore_iteration >
+	nonlinear_iteration< T > structured_levenberg_marquardt(
+		structured_problem< T >& problem,
+		T const& threshold,
+		T mu,
+		T const& beta0,
+		T const& beta1,
+		nonlinear_options const& options = nonlinear_options(),
+		O&& observer = O());
+
+
+	/// \brief Nonlinear least squares problem with a block sparse Jacobian
+	///
+	/// The parameters are declared as blocks, every residual block
+	/// declares the parameter blocks it depends on. Only the nonzero
+	/// blocks of the Jacobian are stored.
+	///
+	/// Blocks which are marked as eliminated, like the 3D points of a
+	/// bundle adjustment, are removed from the normal equations by the
+	/// Schur complement. A residual block may depend on at most one
+	/// eliminated block, so their part of J^T * J is block diagonal.
+	template < typename T >
+	class structured_problem{
+	public:
+		/// \brief Type of the parameters and residuals
+		using value_type = T;
+
+		/// \brief Residual function f(parameters, residuals)
+		///
+		/// parameters[k] points to the values of the k-th block of the
+		/// residual block, residuals to its count residuals.
+		using residual_function =
+			std::function< void(T const* const*, T*) >;
+
+
+		/// \brief Adds a parameter block with its start values and returns
+		///        its index
+		std::size_t add_parameter_block(
+			std::vector< T > const& values, bool eliminate = false
+		){
+			if(values.empty()){
+				throw std::logic_error("structured_problem::"
+					"add_parameter_block with empty block");
+			}
+
+			blocks_.push_back({values_.size(), values.size(), eliminate});
+			values_.insert(values_.end(), values.begin(), values.end());
+			return blocks_.size() - 1;
+		}
+
+		/// \brief Adds count residuals which depend on the parameter blocks
+		///        with the indices blocks
+		template < typename F >
+		void add_residual_block(
+			std::size_t count, std::vector< std::size_t > blocks, F&& f
+		){
+			auto eliminated = no_block;
+			for(auto const b: blocks){
+				if(b >= blocks_.size()){
+					throw std::logic_error("structured_problem::"
+						"add_residual_block with unknown parameter block");
+				}
+
+				if(!blocks_[b].eliminate) continue;
+				if(eliminated != no_block){
+					throw std::logic_error("structured_problem::"
+						"add_residual_block with two eliminated blocks");
+				}
+				eliminated = b;
+			}
+
+			residual_blocks_.push_back({residual_count_, count,
+				std::move(blocks), eliminated,
+				residual_function(static_cast< F&& >(f))});
+			residual_count_ += count;
+		}
+
+
+		/// \brief Count of parameter blocks
+		std::size_t block_count()const noexcept{
+			return blocks_.size();
+		}
+
+		/// \brief Count of all residuals
+		std::size_t residual_count()const noexcept{
+			return residual_count_;
+		}
+
+		/// \brief Values of parameter block b
+		T const* parameters(std::size_t b)const{
+			return values_.data() + blocks_.at(b).offset;
+		}
+
+		/// \brief Size of parameter block b
+		std::size_t block_size(std::size_t b)const{
+			return blocks_.at(b).size;
+		}
+
+
+	private:
+		static constexpr auto no_block =
+			std::numeric_limits< std::size_t >::max();
+
+		struct parameter_block{
+			std::size_t offset;
+			std::size_t size;
+			bool eliminate;
+		};
+
+		struct residual_block{
+			/// \brief Index of the first residual
+			std::size_t offset;
+			std::size_t count;
+			std::vector< std::size_t > blocks;
+
+			/// \brief The eliminated block or no_block
+			std::size_t eliminated;
+
+			residual_function f;
+		};
+
+
+		std::vector< T > values_;
+		std::vector< parameter_block > blocks_;
+		std::vector< residual_block > residual_blocks_;
+		std::size_t residual_count_ = 0;
+
+
+		template < typename U, typename O >
+		friend nonlinear_iteration< U > structured_levenberg_marquardt(
+			structured_problem< U >& problem,
+			U const& threshold,
+			U mu,
+			U const& beta0,
+			U const& beta1,
+			nonlinear_options const& options,
+			O&& observer);
+	};
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief In place Cholesky factorisation of a row-major n x n matrix,
+	///        the lower triangle holds L afterwards
+	template < typename T >
+	bool small_cholesky(T* a, std::size_t n){
+		using std::sqrt;
+
+		for(std::size_t j = 0; j < n; ++j){
+			auto d = a[j * n + j];
+			for(std::size_t k = 0; k < j; ++k) d -= a[j * n + k] * a[j * n + k];
+			if(!(d > T(0))) return false;
+
+			auto const l = sqrt(d);
+			a[j * n + j] = l;
+			for(std::size_t i = j + 1; i < n; ++i){
+				auto v = a[i * n + j];
+				for(std::size_t k = 0; k < j; ++k){
+					v -= a[i * n + k] * a[j * n + k];
+				}
+				a[i * n + j] = v / l;
+			}
+		}
+
+		return true;
+	}
+
+	/// \brief Solve L * L^T * x = b in place
+	template < typename T >
+	void small_cholesky_solve(T const* l, std::size_t n, T* b){
+		for(std::size_t i = 0; i < n; ++i){
+			for(std::size_t k = 0; k < i; ++k) b[i] -= l[i * n + k] * b[k];
+			b[i] /= l[i * n + i];
+		}
+		for(std::size_t i = n; i-- > 0;){
+			for(std::size_t k = i + 1; k < n; ++k) b[i] -= l[k * n + i] * b[k];
+			b[i] /= l[i * n + i];
+		}
+	}
+
+
+	/// \brief Normal equations of an eliminated parameter block
+	template < typename T >
+	struct schur_point{
+		/// \brief J_p^T * J_p, size x size
+		std::vector< T > v;
+
+		/// \brief J_p^T * r
+		std::vector< T > g;
+
+		/// \brief Reduced blocks b with a nonzero J_b^T * J_p
+		std::vector< std::size_t > coupled;
+
+		/// \brief J_b^T * J_p for all coupled blocks, row-major
+		///        size(b) x size each, concatenated
+		std::vector< T > w;
+
+		/// \brief Offsets of the coupled blocks in w
+		std::vector< std::size_t > w_offset;
+
+		/// \brief Factor of v + mu^2 * I
+		std::vector< T > factor;
+	};
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Levenberg-Marquardt algorithm for a structured_problem with
+	///        Schur complement elimination
+	///
+	/// The Jacobian blocks are forward differences with threshold / 128.
+	/// J^T * J is assembled block by block, the eliminated blocks are
+	/// removed by the Schur complement and the reduced system of the other
+	/// blocks is solved by a dense Cholesky factorisation. The step of
+	/// the eliminated blocks follows by back substitution block by block.
+	/// Without eliminated blocks this is the normal Levenberg-Marquardt
+	/// algorithm.
+	///
+	/// The parameters of problem are updated in place. Stops like
+	/// levenberg_marquardt_algorithm and returns the state of the last
+	/// iteration. Throws std::logic_error like it if no damping gives a
+	/// step which reduces the cost.
+	template < typename T, typename O >
+	nonlinear_iteration< T > structured_levenberg_marquardt(
+		structured_problem< T >& problem,
+		T const& threshold,
+		T mu,
+		T const& beta0,
+		T const& beta1,
+		nonlinear_options const& options,
+		O&& observer
+	){
+		using clock = std::chrono::steady_clock;
+		using std::sqrt;
+
+		auto const start = clock::now();
+		auto const step = threshold / 128;
+
+		auto& values = problem.values_;
+		auto const& blocks = problem.blocks_;
+		auto const& residual_blocks = problem.residual_blocks_;
+
+		// Offsets of the reduced blocks in the reduced system and indices
+		// of the eliminated blocks in points
+		std::vector< std::size_t > index(blocks.size());
+		std::size_t reduced = 0;
+		std::size_t eliminated = 0;
+		for(std::size_t b = 0; b < blocks.size(); ++b){
+			if(blocks[b].eliminate){
+				index[b] = eliminated++;
+			}else{
+				index[b] = reduced;
+				reduced += blocks[b].size;
+			}
+		}
+
+		// Jacobian blocks of every residual block, row-major count x size
+		// per parameter block, concatenated
+		std::vector< std::vector< T > > jacobians(residual_blocks.size());
+		for(std::size_t i = 0; i < residual_blocks.size(); ++i){
+			std::size_t size = 0;
+			for(auto const b: residual_blocks[i].blocks){
+				size += blocks[b].size;
+			}
+			jacobians[i].resize(residual_blocks[i].count * size);
+		}
+
+		std::vector< T const* > pointers;
+		auto const evaluate = [&](
+			T const* x, std::size_t i, T* r
+		){
+			auto const& rb = residual_blocks[i];
+			pointers.clear();
+			for(auto const b: rb.blocks){
+				pointers.push_back(x + blocks[b].offset);
+			}
+			rb.f(pointers.data(), r);
+		};
+
+		auto const evaluate_all = [&](T const* x, std::vector< T >& r){
+			r.resize(problem.residual_count_);
+			for(std::size_t i = 0; i < residual_blocks.size(); ++i){
+				evaluate(x, i, r.data() + residual_blocks[i].offset);
+			}
+		};
+
+		auto const cost_of = [](std::vector< T > const& r){
+			T sum = 0;
+			for(auto const v: r) sum += v * v;
+			return sum;
+		};
+
+		std::vector< T > r;
+		std::chrono::nanoseconds first_residual_time{0};
+		detail::timed(first_residual_time, [&]{
+			evaluate_all(values.data(), r);
+			return 0;
+		});
+
+		std::vector< detail::schur_point< T > > points(eliminated);
+		std::vector< T > u(reduced * reduced);
+		std::vector< T > gc(reduced);
+		std::vector< T > trial_values;
+		std::vector< T > trial;
+		std::vector< T > delta(values.size());
+		std::vector< T > y;
+		std::vector< T > perturbed;
+
+		nonlinear_iteration< T > state{};
+		for(std::size_t iteration = 1;; ++iteration){
+			state = nonlinear_iteration< T >{iteration, T(0), T(0), T(0),
+				iteration == 1 ?
+					first_residual_time : std::chrono::nanoseconds{0},
+				{}, {}, {}};
+
+			// Forward difference Jacobian blocks
+			detail::timed(state.jacobian_time, [&]{
+				for(std::size_t i = 0; i < residual_blocks.size(); ++i){
+					auto const& rb = residual_blocks[i];
+					auto const r0 = r.data() + rb.offset;
+					perturbed.resize(rb.count);
+
+					auto j = jacobians[i].data();
+					for(auto const b: rb.blocks){
+						auto const& pb = blocks[b];
+						for(std::size_t c = 0; c < pb.size; ++c){
+							auto& v = values[pb.offset + c];
+							auto const old = v;
+							v += step;
+							evaluate(values.data(), i, perturbed.data());
+							v = old;
+
+							for(std::size_t k = 0; k < rb.count; ++k){
+								j[k * pb.size + c] = (perturbed[k] - r0[k]) /
+									step;
+							}
+						}
+						j += rb.count * pb.size;
+					}
+				}
+				return 0;
+			});
+
+			// Block sparse J^T * J and J^T * r
+			detail::timed(state.solve_time, [&]{
+				std::fill(u.begin(), u.end(), T(0));
+				std::fill(gc.begin(), gc.end(), T(0));
+				for(std::size_t b = 0; b < blocks.size(); ++b){
+					if(!blocks[b].eliminate) continue;
+					auto& p = points[index[b]];
+					auto const n = blocks[b].size;
+					p.v.assign(n * n, T(0));
+					p.g.assign(n, T(0));
+					p.coupled.clear();
+					p.w.clear();
+					p.w_offset.clear();
+				}
+
+				for(std::size_t i = 0; i < residual_blocks.size(); ++i){
+					auto const& rb = residual_blocks[i];
+					auto const m = rb.count;
+					auto const r0 = r.data() + rb.offset;
+					auto const point = rb.eliminated;
+
+					auto ja = jacobians[i].data();
+					for(auto const a: rb.blocks){
+						auto const na = blocks[a].size;
+
+						// J_a^T * r
+						auto const g = blocks[a].eliminate ?
+							points[index[a]].g.data() : gc.data() + index[a];
+						for(std::size_t c = 0; c < na; ++c){
+							for(std::size_t k = 0; k < m; ++k){
+								g[c] += ja[k * na + c] * r0[k];
+							}
+						}
+
+						auto jb = jacobians[i].data();
+						for(auto const b: rb.blocks){
+							auto const nb = blocks[b].size;
+
+							T* target = nullptr;
+							std::size_t stride = 0;
+							if(!blocks[a].eliminate && !blocks[b].eliminate){
+								target = u.data() + index[a] * reduced +
+									index[b];
+								stride = reduced;
+							}else if(b == point && a == point){
+								target = points[index[b]].v.data();
+								stride = nb;
+							}else if(b == point){
+								auto& p = points[index[b]];
+								auto const it = std::find(
+									p.coupled.begin(), p.coupled.end(), a);
+								auto const w = std::size_t(
+									it - p.coupled.begin());
+								if(it == p.coupled.end()){
+									p.coupled.push_back(a);
+									p.w_offset.push_back(p.w.size());
+									p.w.resize(p.w.size() + na * nb, T(0));
+								}
+								target = p.w.data() + p.w_offset[w];
+								stride = nb;
+							}
+
+							if(target){
+								// J_a^T * J_b
+								for(std::size_t c = 0; c < na; ++c){
+									for(std::size_t d = 0; d < nb; ++d){
+										T sum = 0;
+										for(std::size_t k = 0; k < m; ++k){
+											sum += ja[k * na + c] *
+												jb[k * nb + d];
+										}
+										target[c * stride + d] += sum;
+									}
+								}
+							}
+
+							jb += m * nb;
+						}
+
+						ja += m * na;
+					}
+				}
+				return 0;
+			});
+
+			auto const cost = cost_of(r);
+
+			// Trace of J^T * J, floor of the damping
+			T trace = 0;
+			for(std::size_t i = 0; i < reduced; ++i){
+				trace += u[i * reduced + i];
+			}
+			for(std::size_t b = 0; b < blocks.size(); ++b){
+				if(!blocks[b].eliminate) continue;
+				auto const& p = points[index[b]];
+				auto const n = blocks[b].size;
+				for(std::size_t i = 0; i < n; ++i) trace += p.v[i * n + i];
+			}
+
+			// Damped Schur complement solve, returns false if the
+			// matrix is not positive definite
+			auto const solve = [&]{
+				auto s = u;
+				std::vector< T > rhs(reduced);
+				for(std::size_t i = 0; i < reduced; ++i){
+					s[i * reduced + i] += mu * mu;
+					rhs[i] = -gc[i];
+				}
+
+				for(std::size_t b = 0; b < blocks.size(); ++b){
+					if(!blocks[b].eliminate) continue;
+					auto& p = points[index[b]];
+					auto const n = blocks[b].size;
+
+					p.factor = p.v;
+					for(std::size_t i = 0; i < n; ++i){
+						p.factor[i * n + i] += mu * mu;
+					}
+					if(!detail::small_cholesky(p.factor.data(), n)){
+						return false;
+					}
+
+					// Y = W * (V + mu^2 * I)^-1 row by row, then
+					// S -= Y * W^T and rhs += Y * g
+					y.resize(p.w.size());
+					for(std::size_t x = 0; x < p.coupled.size(); ++x){
+						auto const na = blocks[p.coupled[x]].size;
+						auto const wa = p.w.data() + p.w_offset[x];
+						auto const ya = y.data() + p.w_offset[x];
+						std::copy(wa, wa + na * n, ya);
+						for(std::size_t c = 0; c < na; ++c){
+							detail::small_cholesky_solve(
+								p.factor.data(), n, ya + c * n);
+						}
+					}
+
+					for(std::size_t x = 0; x < p.coupled.size(); ++x){
+						auto const a = p.coupled[x];
+						auto const na = blocks[a].size;
+						auto const ya = y.data() + p.w_offset[x];
+						for(std::size_t c = 0; c < na; ++c){
+							auto const row = index[a] + c;
+							for(std::size_t k = 0; k < n; ++k){
+								rhs[row] += ya[c * n + k] * p.g[k];
+							}
+
+							for(std::size_t z = 0; z < p.coupled.size(); ++z){
+								auto const nb = blocks[p.coupled[z]].size;
+								auto const wb = p.w.data() + p.w_offset[z];
+								auto const col = index[p.coupled[z]];
+								for(std::size_t d = 0; d < nb; ++d){
+									T sum = 0;
+									for(std::size_t k = 0; k < n; ++k){
+										sum += ya[c * n + k] * wb[d * n + k];
+									}
+									s[row * reduced + col + d] -= sum;
+								}
+							}
+						}
+					}
+				}
+
+				if(reduced > 0){
+					auto const factors = try_cholesky_decomposition(
+						make_matrix_fn(dims(dim_t(reduced)),
+							[&s, reduced](c_t c, r_t r){
+								return s[size_t(r) * reduced + size_t(c)];
+							}));
+					if(!factors) return false;
+
+					auto const dc = factors->solve(make_vector_fn(
+						rows(row_t(reduced)), [&rhs](std::size_t i){
+							return rhs[i];
+						}));
+					for(std::size_t i = 0; i < reduced; ++i){
+						rhs[i] = dc[d_t(i)];
+					}
+				}
+
+				// Back substitution of the eliminated blocks
+				for(std::size_t b = 0; b < blocks.size(); ++b){
+					auto const offset = blocks[b].offset;
+					auto const n = blocks[b].size;
+					if(!blocks[b].eliminate){
+						std::copy(rhs.begin() + index[b],
+							rhs.begin() + index[b] + n,
+							delta.begin() + offset);
+						continue;
+					}
+
+					auto const& p = points[index[b]];
+					auto const dp = delta.data() + offset;
+					for(std::size_t k = 0; k < n; ++k) dp[k] = -p.g[k];
+					for(std::size_t x = 0; x < p.coupled.size(); ++x){
+						auto const na = blocks[p.coupled[x]].size;
+						auto const wa = p.w.data() + p.w_offset[x];
+						auto const dc = rhs.data() + index[p.coupled[x]];
+						for(std::size_t c = 0; c < na; ++c){
+							for(std::size_t k = 0; k < n; ++k){
+								dp[k] -= wa[c * n + k] * dc[c];
+							}
+						}
+					}
+					detail::small_cholesky_solve(p.factor.data(), n, dp);
+				}
+
+				return true;
+			};
+
+			for(std::size_t increases = 0;;){
+				auto const ok = detail::timed(state.solve_time, [&]{
+					return solve();
+				});
+
+				// Not positive definite, increase the damping
+				if(!ok){
+					mu = detail::increase_damping(mu, trace, increases);
+					continue;
+				}
+
+				// Predicted reduction -(2 * r^T * J * delta + |J * delta|^2)
+				T predicted = 0;
+				for(std::size_t i = 0; i < residual_blocks.size(); ++i){
+					auto const& rb = residual_blocks[i];
+					auto const r0 = r.data() + rb.offset;
+					for(std::size_t k = 0; k < rb.count; ++k){
+						T jd = 0;
+						auto j = jacobians[i].data();
+						for(auto const b: rb.blocks){
+							auto const n = blocks[b].size;
+							auto const d = delta.data() + blocks[b].offset;
+							for(std::size_t c = 0; c < n; ++c){
+								jd += j[k * n + c] * d[c];
+							}
+							j += rb.count * n;
+						}
+						predicted -= 2 * r0[k] * jd + jd * jd;
+					}
+				}
+
+				trial_values.resize(values.size());
+				for(std::size_t i = 0; i < values.size(); ++i){
+					trial_values[i] = values[i] + delta[i];
+				}
+				detail::timed(state.residual_time, [&]{
+					evaluate_all(trial_values.data(), trial);
+					return 0;
+				});
+
+				if(predicted == 0){
+					throw std::runtime_error("eps is infinite");
+				}
+
+				auto const eps = (cost - cost_of(trial)) / predicted;
+				if(eps <= beta0){
+					mu = detail::increase_damping(mu, trace, increases);
+					continue;
+				}
+
+				if(eps >= beta1){
+					mu /= 2;
+				}
+
+				break;
+			}
+
+			values.swap(trial_values);
+			r.swap(trial);
+
+			T step_norm = 0;
+			for(auto const d: delta) step_norm += d * d;
+
+			state.step_norm = sqrt(step_norm);
+			state.cost = cost;
+			state.mu = mu;
+			state.elapsed = std::chrono::duration_cast<
+				std::chrono::nanoseconds >(clock::now() - start);
+
+			if(
+				!detail::continue_iteration(observer, state, options) ||
+				step_norm < threshold
+			) break;
+		}
+
+		return state;
+	}
+
+
+}
+
+
+#endif
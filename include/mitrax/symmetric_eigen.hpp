@@ -0,0 +1,287 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__symmetric_eigen__hpp_INCLUDED_
+#define _mitrax__symmetric_eigen__hpp_INCLUDED_
+
+#include "cholesky_decomposition.hpp"
+#include "detail/closed_form.hpp"
+#include "detail/jacobi.hpp"
+#include "detail/parallel_for.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <cmath>
+
+
+namespace mitrax{
+
+
+	struct symmetric_eigen_options{
+		/// \brief Count of threads, 0 for the hardware concurrency
+		size_t threads = 0;
+	};
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Smallest count of rows which is processed in parallel
+	constexpr size_t eigen_parallel_rows = 128;
+
+	/// \brief Count of rows of a parallel task
+	constexpr size_t eigen_chunk_rows = 16;
+
+	/// \brief Maximal count of QL iterations per eigenvalue
+	constexpr size_t eigen_max_iterations = 30;
+
+
+	/// \brief Call f(i) for all i in [0, count), in chunks of rows on
+	///        up to threads threads if count is large enough
+	template < typename F >
+	void eigen_for_rows(size_t count, size_t threads, F const& f){
+		if(count < eigen_parallel_rows) threads = 1;
+
+		auto const chunks = (count + eigen_chunk_rows - 1) / eigen_chunk_rows;
+		parallel_for(chunks, threads, [count, &f](size_t k){
+			auto const end = std::min((k + 1) * eigen_chunk_rows, count);
+			for(size_t i = k * eigen_chunk_rows; i < end; ++i) f(i);
+		});
+	}
+
+
+	/// \brief Rotation of the elements i and i + 1 of a row
+	template < typename T >
+	struct plane_rotation{
+		size_t i;
+		T c;
+		T s;
+	};
+
+
+	/// \brief Eigenvalues w (ascending) and eigenvectors (columns of z)
+	///        of the symmetric row-major n x n matrix a
+	///
+	/// Householder reduction to tridiagonal form followed by the implicit
+	/// QL method with Wilkinson shifts. The rotations of the QL method are
+	/// recorded, so every row of z is calculated independently by
+	/// applying all reflectors and rotations to a unit vector. a is
+	/// overwritten.
+	template < typename T >
+	void tridiagonal_eigen(size_t n, size_t threads, T* a, T* w, T* z){
+		using std::abs;
+		using std::sqrt;
+		using std::hypot;
+
+		std::vector< T > d(n);
+		std::vector< T > e(n, T(0));
+		std::vector< T > tau(n, T(0));
+		std::vector< T > p(n);
+
+		// Reflector k zeros row and column k behind k + 1, its vector
+		// (without the leading 1) is stored in row k behind k + 1
+		for(size_t k = 0; k + 2 < n; ++k){
+			auto const ak = a + k * n;
+			auto const alpha = ak[k + 1];
+			T norm2 = T(0);
+			for(size_t j = k + 2; j < n; ++j) norm2 += ak[j] * ak[j];
+
+			if(norm2 == T(0)){
+				e[k] = alpha;
+				continue;
+			}
+
+			auto beta = sqrt(alpha * alpha + norm2);
+			if(alpha >= T(0)) beta = -beta;
+
+			auto const t = (beta - alpha) / beta;
+			auto const scale = T(1) / (alpha - beta);
+			for(size_t j = k + 2; j < n; ++j) ak[j] *= scale;
+			tau[k] = t;
+			e[k] = beta;
+
+			// p = tau * A22 * v
+			eigen_for_rows(n - k - 1, threads, [&p, a, ak, n, k, t](size_t r){
+				auto const i = k + 1 + r;
+				auto const ai = a + i * n;
+				auto sum = ai[k + 1];
+				for(size_t j = k + 2; j < n; ++j) sum += ai[j] * ak[j];
+				p[i] = t * sum;
+			});
+
+			// p = p - tau / 2 * (p^T * v) * v
+			auto pv = p[k + 1];
+			for(size_t j = k + 2; j < n; ++j) pv += p[j] * ak[j];
+			auto const h = t / 2 * pv;
+			p[k + 1] -= h;
+			for(size_t j = k + 2; j < n; ++j) p[j] -= h * ak[j];
+
+			// A22 = A22 - v * p^T - p * v^T
+			eigen_for_rows(n - k - 1, threads, [&p, a, ak, n, k](size_t r){
+				auto const i = k + 1 + r;
+				auto const ai = a + i * n;
+				auto const vi = i == k + 1 ? T(1) : ak[i];
+				auto const pi = p[i];
+				ai[k + 1] -= vi * p[k + 1] + pi;
+				for(size_t j = k + 2; j < n; ++j){
+					ai[j] -= vi * p[j] + pi * ak[j];
+				}
+			});
+		}
+
+		for(size_t i = 0; i < n; ++i) d[i] = a[i * n + i];
+		if(n >= 2) e[n - 2] = a[(n - 2) * n + n - 1];
+
+		// Implicit QL method, e[i] is element (i, i + 1)
+		auto const eps = std::numeric_limits< T >::epsilon();
+		std::vector< plane_rotation< T > > rotations;
+		T f = T(0);
+		T norm = T(0);
+		for(size_t l = 0; l < n; ++l){
+			norm = std::max(norm, abs(d[l]) + abs(e[l]));
+
+			auto m = l;
+			while(abs(e[m]) > eps * norm) ++m;
+
+			for(size_t iter = 0; m > l && abs(e[l]) > eps * norm; ++iter){
+				if(iter == eigen_max_iterations){
+					throw std::logic_error(
+						"symmetric_eigen did not converge");
+				}
+
+				// Wilkinson shift
+				auto g = d[l];
+				auto q = (d[l + 1] - g) / (2 * e[l]);
+				auto r = hypot(q, T(1));
+				if(q < T(0)) r = -r;
+				d[l] = e[l] / (q + r);
+				d[l + 1] = e[l] * (q + r);
+				auto const dl1 = d[l + 1];
+				auto h = g - d[l];
+				for(size_t i = l + 2; i < n; ++i) d[i] -= h;
+				f += h;
+
+				q = d[m];
+				T c = T(1);
+				T c2 = T(1);
+				T c3 = T(1);
+				T s = T(0);
+				T s2 = T(0);
+				auto const el1 = e[l + 1];
+				for(size_t i = m; i-- > l;){
+					c3 = c2;
+					c2 = c;
+					s2 = s;
+					g = c * e[i];
+					h = c * q;
+					r = hypot(q, e[i]);
+					e[i + 1] = s * r;
+					s = e[i] / r;
+					c = q / r;
+					q = c * d[i] - s * g;
+					d[i + 1] = h + s * (c * g + s * d[i]);
+					rotations.push_back({i, c, s});
+				}
+
+				q = -s * s2 * c3 * el1 * e[l] / dl1;
+				e[l] = s * q;
+				d[l] = c * q;
+			}
+
+			d[l] += f;
+			e[l] = T(0);
+		}
+
+		std::vector< size_t > order(n);
+		std::iota(order.begin(), order.end(), size_t(0));
+		std::stable_sort(order.begin(), order.end(),
+			[&d](size_t i, size_t j){ return d[i] < d[j]; });
+
+		for(size_t i = 0; i < n; ++i) w[i] = d[order[i]];
+
+		// Row r of Q * G_0 * G_1 * ... with Q = H_0 * H_1 * ...
+		eigen_for_rows(n, threads, [&](size_t r){
+			std::vector< T > x(n, T(0));
+			x[r] = T(1);
+
+			for(size_t k = 0; k + 2 < n; ++k){
+				if(tau[k] == T(0)) continue;
+
+				auto const ak = a + k * n;
+				auto sum = x[k + 1];
+				for(size_t j = k + 2; j < n; ++j) sum += x[j] * ak[j];
+				sum *= tau[k];
+				x[k + 1] -= sum;
+				for(size_t j = k + 2; j < n; ++j) x[j] -= sum * ak[j];
+			}
+
+			for(auto const& g: rotations){
+				auto const h = x[g.i + 1];
+				x[g.i + 1] = g.s * x[g.i] + g.c * h;
+				x[g.i] = g.c * x[g.i] - g.s * h;
+			}
+
+			auto const zr = z + r * n;
+			for(size_t i = 0; i < n; ++i) zr[i] = x[order[i]];
+		});
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Eigenvalues (ascending) and eigenvectors (columns) of a
+	///        symmetric matrix
+	///
+	/// The matrix must be symmetric, this is not checked. Compile time
+	/// matrices up to 4 x 4 use the unrolled Jacobi method, all others a
+	/// tridiagonal reduction and the implicit QL method. Matrices with at
+	/// least detail::eigen_parallel_rows rows are processed on
+	/// options.threads threads.
+	template < typename M, col_t C, row_t R >
+	auto symmetric_eigen(
+		matrix< M, C, R > const& m,
+		symmetric_eigen_options const& options = symmetric_eigen_options()
+	){
+		using value_type = value_type_t< M >;
+		constexpr auto d = C != 0_C ? dim_t(C) : dim_t(R);
+
+		auto a = detail::make_square_factors< value_type, d >(
+			m, "symmetric_eigen");
+		auto const size = a.cols().as_dim();
+		auto values = make_vector_v< value_type >(size.as_row());
+		auto vectors = make_matrix_v< value_type >(size);
+
+		if constexpr(
+			constexpr auto n = detail::closed_form_size< C, R >; n > 0
+		){
+			detail::jacobi_eigen_unrolled< n >(
+				a.data(), values.data(), vectors.data());
+		}else{
+			detail::tridiagonal_eigen(size_t(size), options.threads,
+				a.data(), values.data(), vectors.data());
+		}
+
+		return std::make_pair(std::move(values), std::move(vectors));
+	}
+
+
+}
+
+
+#endif
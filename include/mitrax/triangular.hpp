@@ -0,0 +1,302 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#ifndef _mitrax__triangular__hpp_INCLUDED_
+#define _mitrax__triangular__hpp_INCLUDED_
+
+#include "convert.hpp"
+#include "layout.hpp"
+#include "utility.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+
+namespace mitrax{
+
+
+	/// \brief Part of the matrix which is read
+	enum class triangle{ lower, upper };
+
+	/// \brief Use the triangular matrix as it is or transposed
+	enum class operation{ none, transpose };
+
+	/// \brief Read the diagonal or assume it to be 1
+	enum class diag{ non_unit, unit };
+
+
+}
+
+
+namespace mitrax::detail{
+
+
+	/// \brief Rows of the right hand side processed together
+	constexpr size_t triangular_block_size = 64;
+
+	/// \brief Columns of the right hand side processed together
+	constexpr size_t triangular_strip_size = 256;
+
+
+	/// \brief Solve L * X = B in place for lower triangular L
+	///
+	/// e(i, k) is element (k, i) of L, x(i) points to row i of X with p
+	/// elements. Blocks of rows of X are solved and then subtracted from
+	/// all following rows, the inner loops run over contiguous rows of X.
+	/// With left_looking a row of X is calculated by dot products of
+	/// already solved rows, which is preferable for a single right hand
+	/// side if e(i, k) is contiguous in k.
+	template < typename E, typename X >
+	constexpr void trsm_lower(
+		bool unit, bool left_looking,
+		size_t n, size_t p, E const& e, X const& x
+	){
+		if(left_looking){
+			for(size_t i = 0; i < n; ++i){
+				auto const xi = x(i);
+				for(size_t k = 0; k < i; ++k){
+					auto const l = e(i, k);
+					auto const xk = x(k);
+					for(size_t j = 0; j < p; ++j) xi[j] -= l * xk[j];
+				}
+
+				if(!unit){
+					auto const d = e(i, i);
+					for(size_t j = 0; j < p; ++j) xi[j] /= d;
+				}
+			}
+			return;
+		}
+
+		for(size_t kb = 0; kb < n; kb += triangular_block_size){
+			auto const ke = std::min(kb + triangular_block_size, n);
+
+			// Diagonal block
+			for(size_t i = kb; i < ke; ++i){
+				auto const xi = x(i);
+				if(!unit){
+					auto const d = e(i, i);
+					for(size_t j = 0; j < p; ++j) xi[j] /= d;
+				}
+
+				for(size_t r = i + 1; r < ke; ++r){
+					auto const l = e(r, i);
+					auto const xr = x(r);
+					for(size_t j = 0; j < p; ++j) xr[j] -= l * xi[j];
+				}
+			}
+
+			// Rows below the block
+			for(size_t r = ke; r < n; ++r){
+				auto const xr = x(r);
+				for(size_t k = kb; k < ke; ++k){
+					auto const l = e(r, k);
+					auto const xk = x(k);
+					for(size_t j = 0; j < p; ++j) xr[j] -= l * xk[j];
+				}
+			}
+		}
+	}
+
+	/// \brief Calculate X = L * X in place for lower triangular L
+	///
+	/// e and x as in trsm_lower.
+	template < typename E, typename X >
+	constexpr void trmm_lower(
+		bool unit, size_t n, size_t p, E const& e, X const& x
+	){
+		for(size_t i = n; i-- > 0;){
+			auto const xi = x(i);
+			if(!unit){
+				auto const d = e(i, i);
+				for(size_t j = 0; j < p; ++j) xi[j] *= d;
+			}
+
+			for(size_t k = 0; k < i; ++k){
+				auto const l = e(i, k);
+				auto const xk = x(k);
+				for(size_t j = 0; j < p; ++j) xi[j] += l * xk[j];
+			}
+		}
+	}
+
+
+	/// \brief Call f(unit, e, x) with the effective lower triangular
+	///        element access of op(A)
+	///
+	/// a(i) points to row i of A. An effective upper triangle is mapped
+	/// to a lower one by reversing the order of rows and columns.
+	template < typename A, typename X, typename F >
+	constexpr void triangular_dispatch(
+		triangle t, operation o, diag d, size_t n,
+		A const& a, X const& x, F const& f
+	){
+		auto const unit = d == diag::unit;
+		auto const at = [&a](size_t i, size_t k){ return a(i)[k]; };
+		auto const at_t = [&a](size_t i, size_t k){ return a(k)[i]; };
+		auto const rev = [n](auto const& e){
+			return [n, &e](size_t i, size_t k){
+				return e(n - 1 - i, n - 1 - k);
+			};
+		};
+		auto const x_rev = [n, &x](size_t i){ return x(n - 1 - i); };
+
+		if(t == triangle::lower){
+			if(o == operation::none){
+				f(unit, true, at, x);
+			}else{
+				f(unit, false, rev(at_t), x_rev);
+			}
+		}else{
+			if(o == operation::none){
+				f(unit, true, rev(at), x_rev);
+			}else{
+				f(unit, false, at_t, x);
+			}
+		}
+	}
+
+
+	/// \brief Solve op(A) * X = B in place, X has p columns
+	///
+	/// a(i) and x(i) point to row i of A and X.
+	template < typename A, typename X >
+	constexpr void trsm(
+		triangle t, operation o, diag d, size_t n, size_t p,
+		A const& a, X const& x
+	){
+		for(size_t j0 = 0; j0 < p; j0 += triangular_strip_size){
+			auto const w = std::min(triangular_strip_size, p - j0);
+			auto const strip = [&x, j0](size_t i){ return x(i) + j0; };
+			triangular_dispatch(t, o, d, n, a, strip,
+				[n, w](bool unit, bool row_contiguous, auto const& e,
+					auto const& xs
+				){
+					trsm_lower(unit, row_contiguous && w == 1,
+						n, w, e, xs);
+				});
+		}
+	}
+
+	/// \brief Calculate X = op(A) * X in place, X has p columns
+	///
+	/// a(i) and x(i) point to row i of A and X.
+	template < typename A, typename X >
+	constexpr void trmm(
+		triangle t, operation o, diag d, size_t n, size_t p,
+		A const& a, X const& x
+	){
+		for(size_t j0 = 0; j0 < p; j0 += triangular_strip_size){
+			auto const w = std::min(triangular_strip_size, p - j0);
+			auto const strip = [&x, j0](size_t i){ return x(i) + j0; };
+			triangular_dispatch(t, o, d, n, a, strip,
+				[n, w](bool unit, bool, auto const& e, auto const& xs){
+					trmm_lower(unit, n, w, e, xs);
+				});
+		}
+	}
+
+
+	/// \brief Row access of a matrix with row-major data
+	template < typename T >
+	struct row_pointer{
+		T* data;
+		size_t stride;
+
+		constexpr T* operator()(size_t i)const{
+			return data + i * stride;
+		}
+	};
+
+	template < typename T >
+	row_pointer(T*, size_t) -> row_pointer< T >;
+
+
+	/// \brief Apply the kernel f(a, x, n, p) to a row-major copy of b
+	template < typename MA, col_t CA, row_t RA,
+		typename MB, col_t CB, row_t RB, typename F >
+	constexpr auto triangular_apply(
+		matrix< MA, CA, RA > const& a,
+		matrix< MB, CB, RB > const& b,
+		char const* name, F const& f
+	){
+		using value_type = std::common_type_t<
+			value_type_t< MA >, value_type_t< MB > >;
+
+		auto const n = size_t(a.rows());
+		if(size_t(a.cols()) != n || size_t(b.rows()) != n){
+			throw std::logic_error(
+				std::string(name) + ": incompatible dimensions");
+		}
+
+		auto x = convert< value_type >(b);
+		auto const p = size_t(b.cols());
+		auto const xr = row_pointer{x.data(), p};
+
+		if constexpr(has_row_major_data_v< MA >){
+			f(row_pointer{a.data(), n}, xr, n, p);
+		}else{
+			auto const ac = convert< value_type_t< MA > >(a);
+			f(row_pointer{ac.data(), n}, xr, n, p);
+		}
+
+		return x;
+	}
+
+
+}
+
+
+namespace mitrax{
+
+
+	/// \brief Solve op(A) * X = B with triangular A for all columns of B
+	///
+	/// Only the triangle t of A is read, with diag::unit not even its
+	/// diagonal. Works for vectors (TRSV) and matrices (TRSM).
+	template < typename MA, col_t CA, row_t RA,
+		typename MB, col_t CB, row_t RB >
+	constexpr auto triangular_solve(
+		matrix< MA, CA, RA > const& a,
+		matrix< MB, CB, RB > const& b,
+		triangle t,
+		operation o = operation::none,
+		diag d = diag::non_unit
+	){
+		return detail::triangular_apply(a, b, "triangular_solve",
+			[t, o, d](auto const& ar, auto const& xr, size_t n, size_t p){
+				detail::trsm(t, o, d, n, p, ar, xr);
+			});
+	}
+
+	/// \brief Calculate op(A) * B with triangular A (TRMM)
+	///
+	/// Only the triangle t of A is read, with diag::unit not even its
+	/// diagonal.
+	template < typename MA, col_t CA, row_t RA,
+		typename MB, col_t CB, row_t RB >
+	constexpr auto triangular_multiply(
+		matrix< MA, CA, RA > const& a,
+		matrix< MB, CB, RB > const& b,
+		triangle t,
+		operation o = operation::none,
+		diag d = diag::non_unit
+	){
+		return detail::triangular_apply(a, b, "triangular_multiply",
+			[t, o, d](auto const& ar, auto const& xr, size_t n, size_t p){
+				detail::trmm(t, o, d, n, p, ar, xr);
+			});
+	}
+
+
+}
+
+
+#endif
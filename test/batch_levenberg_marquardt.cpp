@@ -0,0 +1,171 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax batch_levenberg_marquardt
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/batch_levenberg_marquardt.hpp>
+
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+namespace{
+
+
+	/// \brief y = a * exp(b * x)
+	auto const exponential_fit = [](
+		auto const& p,
+		std::tuple< double, double > const& v
+	){
+		using std::exp;
+		return p[0_d] * exp(p[1_d] * std::get< 0 >(v)) - std::get< 1 >(v);
+	};
+
+	using points = std::vector< std::tuple< double, double > >;
+
+	double true_a(size_t i){
+		return 1 + 0.01 * double(i);
+	}
+
+	double true_b(size_t i){
+		return -0.5 + 0.003 * double(i);
+	}
+
+	/// \brief Noise free data of count problems
+	std::vector< points > exponential_data(size_t count){
+		std::vector< points > data(count);
+		for(size_t i = 0; i < count; ++i){
+			for(size_t k = 0; k < 20; ++k){
+				auto const x = 0.1 * double(k);
+				data[i].emplace_back(x, true_a(i) * std::exp(true_b(i) * x));
+			}
+		}
+		return data;
+	}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_batch_levenberg_marquardt)
+
+
+BOOST_AUTO_TEST_CASE(test_exponential){
+	constexpr size_t count = 100;
+	auto const data = exponential_data(count);
+	matrix_batch< double, 1_C, 2_R > start(count);
+	for(size_t i = 0; i < count; ++i){
+		start.set(i, make_vector< double >(2_RS, {1, 0}));
+	}
+
+	auto const result = batch_levenberg_marquardt(
+		execution::seq, exponential_fit, start, data);
+
+	BOOST_TEST(result.parameters.size() == count);
+	for(size_t i = 0; i < count; ++i){
+		auto const p = result.parameters[i];
+		BOOST_TEST((result.status[i] == fit_status::converged));
+		BOOST_TEST(result.iterations[i] > 0);
+		BOOST_TEST(std::abs(p[0_d] - true_a(i)) < 1e-6);
+		BOOST_TEST(std::abs(p[1_d] - true_b(i)) < 1e-6);
+	}
+
+	// The same as the single problem algorithm
+	auto start7 = start[7];
+	auto const single = levenberg_marquardt_algorithm(execution::seq,
+		exponential_fit, start7, 1e-10, 1., 0.3, 0.9, data[7]);
+	BOOST_TEST(std::abs(single[0_d] - result.parameters[7][0_d]) < 1e-6);
+	BOOST_TEST(std::abs(single[1_d] - result.parameters[7][1_d]) < 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_and_automatic_differentiation){
+	constexpr size_t count = 77;
+	auto const data = exponential_data(count);
+	matrix_batch< double, 1_C, 2_R > start(count);
+	for(size_t i = 0; i < count; ++i){
+		start.set(i, make_vector< double >(2_RS, {1, 0}));
+	}
+
+	auto const seq = batch_levenberg_marquardt(
+		execution::seq, exponential_fit, start, data);
+	auto const par = batch_levenberg_marquardt(
+		execution::parallel_policy{4}, exponential_fit, start, data);
+	auto const ad = batch_levenberg_marquardt(execution::par,
+		auto_differentiate(exponential_fit), start, data);
+
+	for(size_t i = 0; i < count; ++i){
+		BOOST_TEST(seq.parameters[i][0_d] == par.parameters[i][0_d]);
+		BOOST_TEST(seq.parameters[i][1_d] == par.parameters[i][1_d]);
+		BOOST_TEST(seq.iterations[i] == par.iterations[i]);
+		BOOST_TEST((ad.status[i] == fit_status::converged));
+		BOOST_TEST(std::abs(ad.parameters[i][0_d] - true_a(i)) < 1e-6);
+		BOOST_TEST(std::abs(ad.parameters[i][1_d] - true_b(i)) < 1e-6);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_status){
+	// Problem 1 has no data, so no step reduces its cost
+	std::vector< points > data(3);
+	data[0] = {{0., 1.}, {1., 2.}};
+	data[2] = {{0., 2.}, {1., 1.}, {2., 0.5}, {3., 0.25}};
+
+	auto const line = [](auto const& p, std::tuple< double, double > v){
+		return p[0_d] + p[1_d] * std::get< 0 >(v) - std::get< 1 >(v);
+	};
+
+	matrix_batch< double, 1_C, 2_R > start(3);
+
+	batch_levenberg_marquardt_options options;
+	options.max_iterations = 1;
+	options.mu = 0.01;
+	auto const result = batch_levenberg_marquardt(
+		execution::seq, line, start, data, options);
+
+	BOOST_TEST((result.status[0] == fit_status::max_iterations));
+	BOOST_TEST((result.status[1] == fit_status::failed));
+	BOOST_TEST((result.status[2] == fit_status::max_iterations));
+	BOOST_TEST(result.iterations[0] == 1);
+	BOOST_TEST(result.iterations[1] == 1);
+	BOOST_TEST(result.iterations[2] == 1);
+
+	BOOST_CHECK_THROW(batch_levenberg_marquardt(execution::seq, line,
+		matrix_batch< double, 1_C, 2_R >(2), data), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_singular){
+	// p[1] has no influence, J^T * J is singular
+	auto const line = [](auto const& p, std::tuple< double, double > v){
+		return p[0_d] * std::get< 0 >(v) + 0 * p[1_d] - std::get< 1 >(v);
+	};
+	points const data{{1., 2.}, {2., 4.}, {3., 6.}};
+
+	matrix_batch< double, 1_C, 2_R > start(3);
+	batch_levenberg_marquardt_options options;
+	options.mu = 0;
+	auto const result = batch_levenberg_marquardt(execution::seq, line,
+		start, std::vector< points >(3, data), options);
+
+	auto const single = levenberg_marquardt_algorithm(execution::seq, line,
+		start[0], 1e-10, 0., 0.3, 0.9, data);
+
+	BOOST_TEST(std::abs(single[0_d] - 2) < 1e-6);
+	for(size_t i = 0; i < 3; ++i){
+		BOOST_TEST((result.status[i] == fit_status::converged));
+		BOOST_TEST(std::abs(result.parameters[i][0_d] - 2) < 1e-6);
+		BOOST_TEST(result.parameters[i][1_d] == 0);
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,138 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax cholesky_decomposition
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/cholesky_decomposition.hpp>
+#include <mitrax/operator.hpp>
+
+#include <cmath>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+template <
+	typename M1, col_t C1, row_t R1,
+	typename M2, col_t C2, row_t R2
+> bool near(
+	matrix< M1, C1, R1 > const& m1,
+	matrix< M2, C2, R2 > const& m2,
+	double threshold
+){
+	auto const size = get_dims(m1, m2);
+	for(auto r = 0_r; r < size.rows(); ++r){
+		for(auto c = 0_c; c < size.cols(); ++c){
+			if(!(std::abs(m1(c, r) - m2(c, r)) < threshold)) return false;
+		}
+	}
+	return true;
+}
+
+constexpr auto spd3 = make_matrix< double >(3_DS, {
+	{ 4,  12, -16},
+	{12,  37, -43},
+	{-16, -43, 98}
+});
+
+
+BOOST_AUTO_TEST_SUITE(suite_cholesky_decomposition)
+
+
+BOOST_AUTO_TEST_CASE(test_cholesky_decomposition_3x3){
+	auto const llt = cholesky_decomposition(spd3);
+
+	BOOST_TEST(type_id_runtime(llt) ==
+		(type_id< cholesky_decomposition< double, 3_D > >()));
+
+	BOOST_TEST(near(llt.lower(), make_matrix< double >(3_DS, {
+			{ 2, 0, 0},
+			{ 6, 1, 0},
+			{-8, 5, 3}
+		}), 1e-12));
+
+	BOOST_TEST(std::abs(llt.determinant() - 36) < 1e-9);
+
+	auto const b = make_vector< double >(3_RS, {1, 2, 3});
+	BOOST_TEST(near(spd3 * llt.solve(b), b, 1e-9));
+	BOOST_TEST(near(spd3 * llt.inverse(),
+		make_identity_matrix< double >(3_DS), 1e-9));
+}
+
+BOOST_AUTO_TEST_CASE(test_cholesky_decomposition_blocked){
+	// Larger than one panel, A = B^T * B + n * I
+	auto const n = dims(dim_t(70));
+	auto const b = make_matrix_fn(n, [](c_t c, r_t r){
+			return std::cos(double(size_t(c)) * 0.3 + double(size_t(r)));
+		});
+	auto const a = transpose(b) * b + make_diag_matrix_v< double >(n, 70);
+
+	auto const llt = cholesky_decomposition(a);
+	BOOST_TEST(type_id_runtime(llt) ==
+		(type_id< cholesky_decomposition< double, 0_D > >()));
+
+	auto const l = llt.lower();
+	BOOST_TEST(near(l * transpose(l), a, 1e-9));
+
+	auto const rhs = make_matrix_fn(2_CS, n.as_row(), [](c_t c, r_t r){
+			return double(size_t(c) * size_t(r));
+		});
+	BOOST_TEST(near(a * llt.solve(rhs), rhs, 1e-9));
+}
+
+BOOST_AUTO_TEST_CASE(test_cholesky_decomposition_not_positive_definite){
+	constexpr auto m = make_matrix< double >(2_DS, {
+		{1, 2},
+		{2, 1}
+	});
+
+	BOOST_CHECK_THROW(cholesky_decomposition{m}, std::logic_error);
+	BOOST_TEST(!try_cholesky_decomposition(m).has_value());
+	BOOST_TEST(!is_positive_definite(m));
+	BOOST_TEST(is_positive_definite(spd3));
+
+	auto const big = make_diag_matrix_v< double >(dims(dim_t(40)), -1);
+	BOOST_TEST(!is_positive_definite(big));
+}
+
+BOOST_AUTO_TEST_CASE(test_ldlt_decomposition){
+	// Indefinite but without need of pivoting
+	constexpr auto m = make_matrix< double >(3_DS, {
+		{4,  2, 2},
+		{2, -3, 1},
+		{2,  1, 5}
+	});
+
+	auto const ldlt = ldlt_decomposition(m);
+	BOOST_TEST(type_id_runtime(ldlt) ==
+		(type_id< ldlt_decomposition< double, 3_D > >()));
+
+	auto const l = ldlt.lower();
+	auto const d = ldlt.diagonal();
+	auto const dm = make_matrix_fn(3_DS, [&d](c_t c, r_t r){
+			return size_t(c) == size_t(r) ? d[d_t(size_t(r))] : 0.;
+		});
+	BOOST_TEST(near(l * dm * transpose(l), m, 1e-12));
+
+	auto const b = make_vector< double >(3_RS, {1, -2, 3});
+	BOOST_TEST(near(m * ldlt.solve(b), b, 1e-12));
+	BOOST_TEST(std::abs(ldlt.determinant() + 64) < 1e-9);
+
+	constexpr auto singular = make_matrix< double >(2_DS, {
+		{0, 1},
+		{1, 0}
+	});
+	BOOST_CHECK_THROW(ldlt_decomposition{singular}, std::logic_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,232 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax conjugate_gradient
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/conjugate_gradient.hpp>
+#include <mitrax/operator.hpp>
+#include <mitrax/compare.hpp>
+#include <mitrax/matrix/heap_layout.hpp>
+
+#include <cmath>
+#include <vector>
+
+
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+namespace{
+
+
+	/// \brief 5-point Laplacian of a size x size grid
+	template < typename Layout = layout::row_major >
+	auto laplacian(size_t size){
+		std::vector< sparse_triplet< double > > triplets;
+		for(size_t y = 0; y < size; ++y){
+			for(size_t x = 0; x < size; ++x){
+				auto const i = y * size + x;
+				triplets.push_back({c_t(i), r_t(i), 4.0});
+				if(x > 0) triplets.push_back({c_t(i - 1), r_t(i), -1.0});
+				if(x + 1 < size) triplets.push_back({c_t(i + 1), r_t(i), -1.0});
+				if(y > 0) triplets.push_back({c_t(i - size), r_t(i), -1.0});
+				if(y + 1 < size){
+					triplets.push_back({c_t(i + size), r_t(i), -1.0});
+				}
+			}
+		}
+
+		auto const n = size * size;
+		return make_sparse_matrix< Layout >(
+			cols(col_t(n)), rows(row_t(n)), triplets);
+	}
+
+	template < typename M, typename MX, row_t R >
+	double relative_residual(
+		M const& a, matrix< MX, 1_C, R > const& x,
+		matrix< MX, 1_C, R > const& b
+	){
+		auto const r = multiply(a, x);
+		double rr = 0;
+		double bb = 0;
+		for(size_t i = 0; i < size_t(b.rows()); ++i){
+			auto const d = b[d_t(i)] - r[d_t(i)];
+			rr += d * d;
+			bb += b[d_t(i)] * b[d_t(i)];
+		}
+		return std::sqrt(rr / bb);
+	}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_conjugate_gradient)
+
+
+BOOST_AUTO_TEST_CASE(test_preconditioners){
+	auto const a = laplacian(30);
+	auto const b = make_vector_fn(900_RD, [](size_t i){
+		return std::sin(double(i));
+	});
+
+	conjugate_gradient_options options;
+	options.tolerance = 1e-10;
+
+	auto const [x0, r0] = conjugate_gradient(a, b,
+		identity_preconditioner(), options);
+	auto const [x1, r1] = conjugate_gradient(a, b,
+		jacobi_preconditioner(a), options);
+	auto const [x2, r2] = conjugate_gradient(a, b,
+		incomplete_cholesky_preconditioner(a), options);
+
+	BOOST_TEST(r0.converged);
+	BOOST_TEST(r1.converged);
+	BOOST_TEST(r2.converged);
+	BOOST_TEST(relative_residual(a, x0, b) < 1e-9);
+	BOOST_TEST(relative_residual(a, x1, b) < 1e-9);
+	BOOST_TEST(relative_residual(a, x2, b) < 1e-9);
+	BOOST_TEST(r2.iterations < r0.iterations);
+
+	auto const csc = laplacian< layout::col_major >(30);
+	auto const [x3, r3] = conjugate_gradient(csc, b,
+		incomplete_cholesky_preconditioner(csc), options);
+	BOOST_TEST(r3.iterations == r2.iterations);
+	BOOST_TEST(relative_residual(a, x3, b) < 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(test_dense_matrix){
+	auto const a = make_matrix< double >(3_CS, 3_RS, {
+		{4, 1, 0},
+		{1, 3, 1},
+		{0, 1, 2}
+	});
+	auto const b = make_vector< double >(3_RS, {1, 2, 3});
+
+	auto const [x, result] = conjugate_gradient(a, b,
+		jacobi_preconditioner(a));
+
+	BOOST_TEST(result.converged);
+	BOOST_TEST(result.iterations <= 3);
+
+	auto const r = a * x;
+	for(auto i = 0_d; i < 3_d; ++i){
+		BOOST_TEST(std::abs(r[i] - b[i]) < 1e-9);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_vector_storage){
+	auto const a = make_matrix< double >(3_CS, 3_RS, {
+		{4, 1, 0},
+		{1, 3, 1},
+		{0, 1, 2}
+	});
+	auto const values = [](c_t, r_t r){ return 1.0 + double(size_t(r)); };
+	auto const b = make_matrix_fn(1_CS, 3_RD, values, maker::morton);
+	auto x = make_matrix_v(1_CS, 3_RD, 0.0, maker::col_major);
+
+	auto const result = conjugate_gradient_solver< double >()
+		.solve(a, b, x);
+	BOOST_TEST(result.converged);
+
+	auto const r = a * x;
+	for(auto i = 0_d; i < 3_d; ++i){
+		BOOST_TEST(std::abs(r[i] - b[i]) < 1e-9);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_operator_and_observer){
+	// Matrix free 1D Laplacian
+	constexpr size_t n = 200;
+	auto const op = [](double const* x, double* y){
+		for(size_t i = 0; i < n; ++i){
+			y[i] = 2 * x[i];
+			if(i > 0) y[i] -= x[i - 1];
+			if(i + 1 < n) y[i] -= x[i + 1];
+		}
+	};
+
+	auto const b = make_vector_v< double >(rows(row_t(n)), 1.0);
+
+	std::vector< double > norms;
+	auto const [x, result] = conjugate_gradient(op, b,
+		identity_preconditioner(), conjugate_gradient_options(),
+		[&norms](conjugate_gradient_state< double > const& s){
+			norms.push_back(s.residual_norm);
+			BOOST_TEST(s.iteration == norms.size());
+			return s.iteration < 5;
+		});
+
+	BOOST_TEST(result.iterations == 5);
+	BOOST_TEST(!result.converged);
+	BOOST_TEST(norms.size() == 5);
+	BOOST_TEST(norms.back() == result.residual_norm);
+
+	// Continue with the reached solution as start value
+	conjugate_gradient_solver< double > solver;
+	auto y = x;
+	auto const rest = solver.solve(op, b, y);
+	BOOST_TEST(rest.converged);
+	BOOST_TEST(rest.iterations <= n);
+
+	auto const max = solver.solve(op, b.data(), y.data(), n);
+	BOOST_TEST(max.converged);
+	BOOST_TEST(max.iterations <= 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_threads){
+	auto const a = laplacian(300);
+	auto const b = make_vector_fn(90000_RD, [](size_t i){
+		return std::cos(double(i));
+	});
+	jacobi_preconditioner< double > const jacobi(a);
+
+	conjugate_gradient_options options;
+	options.max_iterations = 40;
+
+	options.threads = 1;
+	conjugate_gradient_solver< double > serial(options);
+	auto x1 = make_vector_v< double >(90000_RD);
+	auto const r1 = serial.solve(a, b, x1, jacobi);
+
+	options.threads = 4;
+	conjugate_gradient_solver< double > parallel(options);
+	auto x4 = make_vector_v< double >(90000_RD);
+	auto const r4 = parallel.solve(a, b, x4, jacobi);
+
+	BOOST_TEST(r1.iterations == 40);
+	BOOST_TEST(r4.iterations == 40);
+	BOOST_TEST(r1.residual_norm == r4.residual_norm);
+	BOOST_TEST((x1 == x4));
+}
+
+BOOST_AUTO_TEST_CASE(test_errors){
+	auto const indefinite = make_matrix< double >(2_CS, 2_RS, {
+		{1, 0},
+		{0, -1}
+	});
+	auto const b = make_vector< double >(2_RS, {1, 1});
+	BOOST_CHECK_THROW(conjugate_gradient(indefinite, b), std::logic_error);
+
+	auto const a = laplacian(3);
+	BOOST_CHECK_THROW(conjugate_gradient(a, b), std::logic_error);
+
+	std::vector< sparse_triplet< double > > const no_diagonal{
+		{0_c, 0_r, 1.0}, {0_c, 1_r, 1.0}, {1_c, 0_r, 1.0}};
+	auto const m = make_sparse_matrix(2_CD, 2_RD, no_diagonal);
+	BOOST_CHECK_THROW(incomplete_cholesky_preconditioner< double >{m},
+		std::logic_error);
+
+	auto const zero = make_matrix_v< double >(2_CS, 2_RS);
+	BOOST_CHECK_THROW(jacobi_preconditioner< double >{zero},
+		std::logic_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
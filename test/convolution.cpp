@@ -10,8 +10,10 @@
 #include <boost/test/unit_test.hpp>
 
 #include <mitrax/convolution.hpp>
+#include <mitrax/compare.hpp>
 
 #include <iostream>
+#include <cmath>
 
 
 using boost::typeindex::type_id;
@@ -59,5 +61,43 @@ BOOST_AUTO_TEST_CASE(test_convolution){
 	BOOST_TEST(type_id_runtime(m) == (type_id< std_matrix< int, 3_C, 3_R > >()));
 }
 
+BOOST_AUTO_TEST_CASE(test_separable_convolution){
+	constexpr auto m = convolution(image,
+		make_vector< int >(3_RS, {1, 2, 1}),
+		make_vector< int >(3_CS, {1, 0, -1}));
+
+	static_assert(m(1_c, 1_r) == -8);
+	BOOST_TEST((m == convolution(image, sobel_x)));
+	BOOST_TEST(type_id_runtime(m) ==
+		(type_id< std_matrix< int, 3_C, 3_R > >()));
+
+	auto const big = make_matrix_fn(cols(col_t(40)), rows(row_t(30)),
+		[](c_t c, r_t r){
+			return std::sin(double(size_t(c)) + 0.3 * double(size_t(r)));
+		});
+	auto const vc = make_vector< double >(5_RS, {0.5, -1, 2, 0.25, 1});
+	auto const vr = make_vector< double >(4_CS, {1, 3, -2, 0.5});
+
+	auto const separable = convolution(big, vc, vr);
+	auto const nested = convolution(convolution(big, vr), vc);
+	auto const full = convolution(big, make_matrix_fn(4_CS, 5_RS,
+		[&vc, &vr](c_t c, r_t r){
+			return vc[d_t(size_t(r))] * vr[d_t(size_t(c))];
+		}));
+
+	BOOST_TEST(size_t(separable.cols()) == 37);
+	BOOST_TEST(size_t(separable.rows()) == 26);
+	BOOST_TEST((separable == nested));
+	for(auto r = 0_r; r < separable.rows(); ++r){
+		for(auto c = 0_c; c < separable.cols(); ++c){
+			BOOST_TEST(std::abs(separable(c, r) - full(c, r)) < 1e-12);
+		}
+	}
+
+	BOOST_CHECK_THROW(convolution(
+		make_matrix_v< double >(cols(col_t(3)), rows(row_t(8))), vc, vr),
+		std::logic_error);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
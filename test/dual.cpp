@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax dual
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/dual.hpp>
+#include <mitrax/make_matrix.hpp>
+#include <mitrax/operator.hpp>
+
+#include <cmath>
+
+
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+namespace{
+
+
+	using d2 = dual< double, 2 >;
+
+	bool equal(double a, double b){
+		return std::abs(a - b) < 1e-12;
+	}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_dual)
+
+
+BOOST_AUTO_TEST_CASE(test_arithmetic){
+	constexpr auto x = d2::variable(3, 0);
+	constexpr auto y = d2::variable(2, 1);
+
+	// f = x * y + x / y - 2 * x + 1
+	constexpr auto f = x * y + x / y - 2 * x + 1;
+	static_assert(f.value() == 3 * 2 + 3. / 2 - 2 * 3 + 1);
+	static_assert(f.gradient()[0] == 2 + 1. / 2 - 2);
+	static_assert(f.gradient()[1] == 3 - 3. / 4);
+
+	constexpr auto g = 1 / x - y;
+	BOOST_TEST(equal(g.value(), 1. / 3 - 2));
+	BOOST_TEST(equal(g.gradient()[0], -1. / 9));
+	BOOST_TEST(equal(g.gradient()[1], -1));
+
+	BOOST_TEST((x > y));
+	BOOST_TEST((x == 3.));
+	BOOST_TEST((-x < 0.));
+}
+
+BOOST_AUTO_TEST_CASE(test_functions){
+	auto const x = d2::variable(0.5, 0);
+	auto const y = d2::variable(0.25, 1);
+
+	auto const f = sqrt(x * x + y * y);
+	BOOST_TEST(equal(f.value(), std::sqrt(0.3125)));
+	BOOST_TEST(equal(f.gradient()[0], 0.5 / std::sqrt(0.3125)));
+	BOOST_TEST(equal(f.gradient()[1], 0.25 / std::sqrt(0.3125)));
+
+	auto const g = sin(x) * exp(y) + log(x) * cos(y);
+	BOOST_TEST(equal(g.gradient()[0],
+		std::cos(0.5) * std::exp(0.25) + 2 * std::cos(0.25)));
+	BOOST_TEST(equal(g.gradient()[1],
+		std::sin(0.5) * std::exp(0.25) - std::log(0.5) * std::sin(0.25)));
+
+	auto const h = atan2(y, x);
+	BOOST_TEST(equal(h.value(), std::atan2(0.25, 0.5)));
+	BOOST_TEST(equal(h.gradient()[0], -0.25 / 0.3125));
+	BOOST_TEST(equal(h.gradient()[1], 0.5 / 0.3125));
+
+	auto const p = pow(x, 3.);
+	BOOST_TEST(equal(p.gradient()[0], 3 * 0.25));
+	auto const q = pow(x, 2);
+	BOOST_TEST(equal(q.value(), 0.25));
+	BOOST_TEST(equal(q.gradient()[0], 1));
+	auto const r = pow(d2::variable(0, 0), 0.5);
+	BOOST_TEST(r.value() == 0);
+	BOOST_TEST(std::isinf(r.gradient()[0]));
+	BOOST_TEST(equal(abs(-x).gradient()[0], 1));
+	BOOST_TEST(equal(tan(x).gradient()[0], 1 + std::pow(std::tan(0.5), 2)));
+	BOOST_TEST(equal(asin(x).gradient()[0], 1 / std::sqrt(0.75)));
+	BOOST_TEST(equal(acos(x).gradient()[0], -1 / std::sqrt(0.75)));
+	BOOST_TEST(equal(atan(x).gradient()[0], 1 / 1.25));
+}
+
+BOOST_AUTO_TEST_CASE(test_matrix_value_type){
+	auto const v = make_vector_fn(2_RS, [](size_t i){
+		return d2::variable(double(i + 1), i);
+	});
+	auto const m = make_matrix< double >(2_CS, 2_RS, {
+		{1, 2},
+		{3, 4}
+	});
+
+	auto const r = make_vector_fn(2_RS, [&m, &v](size_t i){
+		d2 sum;
+		for(auto c = 0_c; c < 2_c; ++c) sum += m(c, r_t(i)) * v[d_t(c)];
+		return sum;
+	});
+
+	BOOST_TEST(r[0_d].value() == 5);
+	BOOST_TEST(r[1_d].value() == 11);
+	BOOST_TEST(r[1_d].gradient()[0] == 3);
+	BOOST_TEST(r[1_d].gradient()[1] == 4);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
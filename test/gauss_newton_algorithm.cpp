@@ -11,8 +11,12 @@
 
 #include <mitrax/gauss_newton_algorithm.hpp>
 #include <mitrax/io/matrix.hpp>
+#include <mitrax/compare.hpp>
+#include <mitrax/matrix/heap_layout.hpp>
 
 #include <iostream>
+#include <vector>
+#include <cmath>
 
 
 using boost::typeindex::type_id;
@@ -33,6 +37,443 @@ auto const id = type_id< T >();
 BOOST_AUTO_TEST_SUITE(suite_gauss_newton_algorithm)
 
 
+auto const linear_fit = [](
+		auto const& p,
+		std::tuple< double, double > const& v
+	){
+		return std::get< 1 >(v) * p[0_d] + p[1_d] - std::get< 0 >(v);
+	};
+
+boost::container::vector< std::tuple< double, double > > const
+	linear_data{
+		std::make_tuple(2., 2.),
+		std::make_tuple(3., 3.),
+		std::make_tuple(4., 4.),
+		std::make_tuple(5., 5.)
+	};
+
+
+BOOST_AUTO_TEST_CASE(test_gauss_newton_algorithm_linear){
+	constexpr auto start = make_vector_v< double >(2_RS, 1);
+
+	auto res = gauss_newton_algorithm(linear_fit, start, 1e-10, linear_data);
+
+	BOOST_TEST(rt_id(res) == (id< stack_col_vector< double, 2_R > >));
+	BOOST_TEST((
+		std::abs(res[0_d] - 1) < 1e-6 &&
+		std::abs(res[1_d]) < 1e-6
+	));
+}
+
+BOOST_AUTO_TEST_CASE(test_levenberg_marquardt_algorithm_linear){
+	constexpr auto start = make_vector_v< double >(2_RS, 1);
+
+	auto res = levenberg_marquardt_algorithm(
+		linear_fit, start, 1e-10, 1., 0.3, 0.9, linear_data);
+
+	BOOST_TEST((
+		std::abs(res[0_d] - 1) < 1e-4 &&
+		std::abs(res[1_d]) < 1e-4
+	));
+}
+
+BOOST_AUTO_TEST_CASE(test_levenberg_marquardt_algorithm_singular){
+	// p[1] does not affect the residuals, J^T * J is singular
+	auto const f = [](
+			auto const& p,
+			std::tuple< double, double > const& v
+		){
+			return std::get< 1 >(v) * p[0_d] - std::get< 0 >(v);
+		};
+	auto const start = make_vector< double >(2_RD, {2, 5});
+
+	auto const res = levenberg_marquardt_algorithm(
+		f, start, 1e-10, 0., 0.3, 0.9, linear_data);
+	BOOST_TEST(std::abs(res[0_d] - 1) < 1e-4);
+	BOOST_TEST(res[1_d] == 5);
+
+	// No step reduces the cost, the solver gives up
+	auto const step = [](
+			auto const& p,
+			std::tuple< double, double > const&
+		){
+			return p[0_d] < 1 ? 10. : p[0_d];
+		};
+	BOOST_CHECK_THROW(levenberg_marquardt_algorithm(step,
+		make_vector< double >(1_RD, {1}), 1e-10, 0., 0.3, 0.9, linear_data),
+		std::exception);
+
+	// Compile time count of parameters, normal equations by policy
+	constexpr auto fixed = make_vector< double >(2_RS, {2, 5});
+	auto const check = [&](auto const& policy){
+		auto const fit = levenberg_marquardt_algorithm(
+			policy, f, fixed, 1e-10, 0., 0.3, 0.9, linear_data);
+		BOOST_TEST(std::abs(fit[0_d] - 1) < 1e-4);
+		BOOST_TEST(fit[1_d] == 5);
+
+		BOOST_CHECK_THROW(levenberg_marquardt_algorithm(policy, step,
+			make_vector< double >(2_RS, {1, 0}), 1e-10, 0., 0.3, 0.9,
+			linear_data), std::exception);
+	};
+	check(execution::seq);
+	check(execution::par);
+}
+
+BOOST_AUTO_TEST_CASE(test_finite_difference_jacobian){
+	size_t calls = 0;
+	auto const f = [&calls](
+			auto const& p,
+			std::tuple< double, double > const& v
+		){
+			++calls;
+			return std::get< 1 >(v) * p[0_d] * p[0_d] + p[1_d] -
+				std::get< 0 >(v);
+		};
+
+	constexpr auto arg = make_vector< double >(2_RS, {3, 1});
+	auto const r = make_vector_fn(rows(row_t(linear_data.size())),
+		[&](size_t i){ return f(arg, linear_data[i]); });
+
+	calls = 0;
+	auto const d = finite_difference_jacobian(f, arg, r, linear_data, 1e-6);
+
+	BOOST_TEST(calls == 2 * linear_data.size());
+	BOOST_TEST(rt_id(d) == (id< std_matrix< double, 2_C, 0_R > >));
+	for(auto y = 0_r; y < d.rows(); ++y){
+		auto const x = std::get< 1 >(linear_data[size_t(y)]);
+		BOOST_TEST(std::abs(d(0_c, y) - 6 * x) < 1e-4);
+		BOOST_TEST(std::abs(d(1_c, y) - 1) < 1e-4);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_auto_differentiation){
+	auto const circle = [](
+			auto const& p,
+			std::tuple< double, double > const& v
+		){
+			using std::sqrt;
+			auto const x = std::get< 0 >(v) - p[0_d];
+			auto const y = std::get< 1 >(v) - p[1_d];
+			return sqrt(x * x + y * y) - p[2_d];
+		};
+
+	boost::container::vector< std::tuple< double, double > > const data{
+		std::make_tuple(3., 1.),
+		std::make_tuple(1., 3.),
+		std::make_tuple(-1., 1.),
+		std::make_tuple(1., -1.),
+		std::make_tuple(1. + std::sqrt(2.), 1. + std::sqrt(2.))
+	};
+
+	constexpr auto arg = make_vector< double >(3_RS, {0.5, 0.25, 1});
+	auto const [r, d] = forward_jacobian(circle, arg, data);
+	BOOST_TEST(rt_id(d) == (id< std_matrix< double, 3_C, 0_R > >));
+	for(auto y = 0_r; y < d.rows(); ++y){
+		auto const& v = data[size_t(y)];
+		auto const dx = std::get< 0 >(v) - 0.5;
+		auto const dy = std::get< 1 >(v) - 0.25;
+		auto const l = std::sqrt(dx * dx + dy * dy);
+		BOOST_TEST(std::abs(r[d_t(y)] - (l - 1)) < 1e-12);
+		BOOST_TEST(std::abs(d(0_c, y) + dx / l) < 1e-12);
+		BOOST_TEST(std::abs(d(1_c, y) + dy / l) < 1e-12);
+		BOOST_TEST(d(2_c, y) == -1);
+	}
+
+	auto const res = levenberg_marquardt_algorithm(auto_differentiate(circle),
+		arg, 1e-12, 1., 0.3, 0.9, data);
+	BOOST_TEST(std::abs(res[0_d] - 1) < 1e-5);
+	BOOST_TEST(std::abs(res[1_d] - 1) < 1e-5);
+	BOOST_TEST(std::abs(res[2_d] - 2) < 1e-5);
+
+	auto const lin = gauss_newton_algorithm(auto_differentiate(linear_fit),
+		make_vector_v< double >(2_RS, 1), 1e-10, linear_data);
+	BOOST_TEST(std::abs(lin[0_d] - 1) < 1e-6);
+	BOOST_TEST(std::abs(lin[1_d]) < 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(test_normal_equations){
+	auto const f = [](
+			auto const& p,
+			std::tuple< double, double > const& v
+		){
+			using std::exp;
+			return p[0_d] * exp(p[1_d] * std::get< 0 >(v)) - std::get< 1 >(v);
+		};
+
+	boost::container::vector< std::tuple< double, double > > data;
+	for(size_t i = 0; i < 5000; ++i){
+		auto const x = double(i) / 5000;
+		auto const noise = 0.01 * std::sin(double(i));
+		data.push_back(std::make_tuple(x, 2 * std::exp(-x) + noise));
+	}
+
+	constexpr auto arg = make_vector< double >(2_RS, {1.5, -0.5});
+	auto const ad = auto_differentiate(f);
+	auto const [r, d] = forward_jacobian(ad, arg, data);
+	auto const jtj = transpose(d) * d;
+	auto const jtr = transpose(d) * r;
+
+	auto const seq = accumulate_normal_equations(
+		execution::seq, ad, arg, data, 1e-7);
+	auto const par = accumulate_normal_equations(
+		execution::parallel_policy{4}, ad, arg, data, 1e-7);
+
+	BOOST_TEST(rt_id(seq.jtj) == (id< std_matrix< double, 2_C, 2_R > >));
+	BOOST_TEST((seq.jtj == par.jtj));
+	BOOST_TEST((seq.jtr == par.jtr));
+	BOOST_TEST(seq.cost == par.cost);
+	for(auto y = 0_r; y < 2_r; ++y){
+		for(auto x = 0_c; x < 2_c; ++x){
+			BOOST_TEST(std::abs(seq.jtj(x, y) - jtj(x, y)) < 1e-8);
+		}
+		BOOST_TEST(std::abs(seq.jtr[d_t(y)] - jtr[d_t(y)]) < 1e-8);
+	}
+	BOOST_TEST(std::abs(seq.cost - vector_norm_2sqr(r)) < 1e-8);
+
+	auto const fd = accumulate_normal_equations(
+		execution::par, f, arg, data, 1e-7);
+	BOOST_TEST(std::abs(fd.jtj(0_c, 0_r) - jtj(0_c, 0_r)) < 1e-3);
+	BOOST_TEST(std::abs(fd.jtr[1_d] - jtr[1_d]) < 1e-3);
+
+	auto const gn1 = gauss_newton_algorithm(
+		execution::seq, f, arg, 1e-12, data);
+	auto const gn4 = gauss_newton_algorithm(
+		execution::parallel_policy{4}, f, arg, 1e-12, data);
+	BOOST_TEST((gn1 == gn4));
+	BOOST_TEST(std::abs(gn1[0_d] - 2) < 1e-2);
+	BOOST_TEST(std::abs(gn1[1_d] + 1) < 1e-2);
+
+	auto const lm = levenberg_marquardt_algorithm(
+		execution::par, ad, arg, 1e-12, 1., 0.3, 0.9, data);
+	BOOST_TEST(std::abs(lm[0_d] - gn1[0_d]) < 1e-5);
+	BOOST_TEST(std::abs(lm[1_d] - gn1[1_d]) < 1e-5);
+}
+
+BOOST_AUTO_TEST_CASE(test_observer){
+	auto const f = [](
+			auto const& p,
+			std::tuple< double, double > const& v
+		){
+			using std::exp;
+			return p[0_d] * exp(p[1_d] * std::get< 0 >(v)) - std::get< 1 >(v);
+		};
+
+	boost::container::vector< std::tuple< double, double > > data;
+	for(size_t i = 0; i < 50; ++i){
+		auto const x = double(i) / 50;
+		data.push_back(std::make_tuple(x, 2 * std::exp(-x)));
+	}
+
+	constexpr auto start = make_vector< double >(2_RS, {1, 0});
+
+	std::vector< nonlinear_iteration< double > > gn;
+	auto const res = gauss_newton_algorithm(f, start, 1e-10, data,
+		nonlinear_options(),
+		[&gn](nonlinear_iteration< double > const& state){
+			gn.push_back(state);
+		});
+	BOOST_TEST(std::abs(res[0_d] - 2) < 1e-4);
+	BOOST_TEST(gn.size() > 1);
+	for(size_t i = 0; i < gn.size(); ++i){
+		BOOST_TEST(gn[i].iteration == i + 1);
+		BOOST_TEST(gn[i].mu == 0);
+		BOOST_TEST(gn[i].residual_time.count() >= 0);
+		BOOST_TEST((i == 0 || gn[i - 1].elapsed <= gn[i].elapsed));
+	}
+	BOOST_TEST(gn.back().cost < gn.front().cost);
+
+	nonlinear_options options;
+	options.max_iterations = 2;
+	size_t count = 0;
+	levenberg_marquardt_algorithm(f, start, 1e-10, 1., 0.3, 0.9, data,
+		options, [&count](nonlinear_iteration< double > const& state){
+			++count;
+			BOOST_TEST(state.mu > 0);
+			return true;
+		});
+	BOOST_TEST(count == 2);
+
+	count = 0;
+	gauss_newton_algorithm(execution::seq, f, start, 1e-10, data,
+		nonlinear_options(),
+		[&count](nonlinear_iteration< double > const&){
+			return ++count < 3;
+		});
+	BOOST_TEST(count == 3);
+
+	options.max_iterations = 0;
+	options.time_budget = std::chrono::nanoseconds(1);
+	count = 0;
+	levenberg_marquardt_algorithm(execution::par, f, start, 1e-10, 1., 0.3,
+		0.9, data, options, [&count](nonlinear_iteration< double > const&){
+			++count;
+		});
+	BOOST_TEST(count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_compile_time_parameters){
+	auto const f = [](
+			auto const& p,
+			std::tuple< double, double > const& v
+		){
+			using std::exp;
+			return p[0_d] * exp(p[1_d] * std::get< 0 >(v)) - std::get< 1 >(v);
+		};
+
+	boost::container::vector< std::tuple< double, double > > data;
+	for(size_t i = 0; i < 3000; ++i){
+		auto const x = double(i) / 3000;
+		data.push_back(std::make_tuple(x, 2 * std::exp(-x)));
+	}
+
+	constexpr auto start = make_vector< double >(2_RS, {1, 0});
+
+	auto const n = accumulate_normal_equations(
+		execution::seq, f, start, data, 1e-7);
+	auto const gn = gauss_newton_algorithm(f, start, 1e-10, data);
+	auto const lm = levenberg_marquardt_algorithm(auto_differentiate(f),
+		start, 1e-10, 1., 0.3, 0.9, data);
+
+	BOOST_TEST(rt_id(n.jtj) == (id< stack_matrix< double, 2_C, 2_R > >));
+	BOOST_TEST(rt_id(n.jtr) == (id< stack_col_vector< double, 2_R > >));
+	BOOST_TEST(std::abs(gn[0_d] - 2) < 1e-4);
+	BOOST_TEST(std::abs(gn[1_d] + 1) < 1e-4);
+	BOOST_TEST(std::abs(lm[0_d] - 2) < 1e-4);
+	BOOST_TEST(std::abs(lm[1_d] + 1) < 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(test_compile_time_and_runtime_parameters){
+	// y = a * exp(b * x) + c
+	auto const f = [](
+			auto const& p,
+			std::tuple< double, double > const& v
+		){
+			using std::exp;
+			return p[0_d] * exp(p[1_d] * std::get< 0 >(v)) + p[2_d]
+				- std::get< 1 >(v);
+		};
+
+	boost::container::vector< std::tuple< double, double > > data;
+	for(size_t i = 0; i < 50; ++i){
+		auto const x = double(i) / 10;
+		data.push_back(std::make_tuple(x, 2 * std::exp(-0.5 * x) + 1));
+	}
+
+	auto const ct = make_vector< double >(3_RS, {1.5, -0.4, 0.8});
+	auto const rt = make_vector< double >(3_RD, {1.5, -0.4, 0.8});
+
+	auto const gn_ct = gauss_newton_algorithm(f, ct, 1e-12, data);
+	auto const gn_rt = gauss_newton_algorithm(f, rt, 1e-12, data);
+	auto const lm_ct = levenberg_marquardt_algorithm(
+		f, ct, 1e-12, 1., 0.3, 0.9, data);
+	auto const lm_rt = levenberg_marquardt_algorithm(
+		f, rt, 1e-12, 1., 0.3, 0.9, data);
+	auto const qr_ct = qr_gauss_newton_algorithm(f, ct, 1e-12, data);
+	auto const qr_rt = qr_gauss_newton_algorithm(f, rt, 1e-12, data);
+
+	// The same strategy for both, so the same iterates
+	for(std::size_t i = 0; i < 3; ++i){
+		BOOST_TEST(gn_ct[d_t(i)] == gn_rt[d_t(i)]);
+		BOOST_TEST(lm_ct[d_t(i)] == lm_rt[d_t(i)]);
+		BOOST_TEST(qr_ct[d_t(i)] == qr_rt[d_t(i)]);
+	}
+
+	BOOST_TEST(std::abs(gn_ct[0_d] - 2) < 1e-6);
+	BOOST_TEST(std::abs(gn_ct[1_d] + 0.5) < 1e-6);
+	BOOST_TEST(std::abs(gn_ct[2_d] - 1) < 1e-6);
+	BOOST_TEST(std::abs(lm_ct[0_d] - 2) < 1e-6);
+	BOOST_TEST(std::abs(qr_ct[0_d] - 2) < 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(test_column_data){
+	auto const f = [](
+			auto const& p,
+			std::tuple< double, double > const& v
+		){
+			using std::exp;
+			return p[0_d] * exp(p[1_d] * std::get< 0 >(v)) - std::get< 1 >(v);
+		};
+
+	// Residuals of a block straight from the columns
+	auto const block = [](
+			auto const& p,
+			auto const& data,
+			size_t begin,
+			size_t end,
+			double* r
+		){
+			using std::exp;
+			auto const x = data.template column< 0 >();
+			auto const y = data.template column< 1 >();
+			for(auto i = begin; i < end; ++i){
+				r[i - begin] = p[0_d] * exp(p[1_d] * x[i]) - y[i];
+			}
+		};
+
+	auto const xs = make_vector_fn(rows(row_t(2000)), [](size_t i){
+		return double(i) / 2000;
+	});
+	auto const ys = make_vector_fn(rows(row_t(2000)), [&xs](size_t i){
+		return 2 * std::exp(-xs[d_t(i)]) + 0.01 * std::sin(double(i));
+	});
+
+	std::vector< std::tuple< double, double > > tuples;
+	for(size_t i = 0; i < 2000; ++i){
+		tuples.emplace_back(xs[d_t(i)], ys[d_t(i)]);
+	}
+
+	auto const columns = make_column_data(xs, ys);
+	BOOST_TEST(columns.size() == 2000);
+	BOOST_TEST((columns[7] == tuples[7]));
+	BOOST_TEST(columns.column< 0 >() == xs.data());
+
+	constexpr auto start = make_vector< double >(2_RS, {1, 0});
+
+	auto const n1 = accumulate_normal_equations(
+		execution::seq, f, start, tuples, 1e-7);
+	auto const n2 = accumulate_normal_equations(
+		execution::seq, f, start, columns, 1e-7);
+	auto const n3 = accumulate_normal_equations(
+		execution::par, block_evaluate(block), start, columns, 1e-7);
+	BOOST_TEST((n1.jtj == n2.jtj));
+	BOOST_TEST((n1.jtj == n3.jtj));
+	BOOST_TEST((n1.jtr == n3.jtr));
+	BOOST_TEST(n1.cost == n3.cost);
+
+	auto const gn1 = gauss_newton_algorithm(f, start, 1e-10, tuples);
+	auto const gn2 = gauss_newton_algorithm(f, start, 1e-10, columns);
+	auto const gn3 = gauss_newton_algorithm(
+		block_evaluate(block), start, 1e-10, columns);
+	BOOST_TEST((gn1 == gn2));
+	BOOST_TEST((gn1 == gn3));
+
+	// Runtime count of parameters, the Jacobian is stored
+	auto const dynamic = make_vector< double >(2_RD, {1, 0});
+	auto const lm1 = levenberg_marquardt_algorithm(
+		f, dynamic, 1e-10, 1., 0.3, 0.9, columns);
+	auto const lm2 = levenberg_marquardt_algorithm(block_evaluate(block),
+		dynamic, 1e-10, 1., 0.3, 0.9, columns);
+	BOOST_TEST((lm1 == lm2));
+	BOOST_TEST(std::abs(lm1[0_d] - gn1[0_d]) < 1e-5);
+	BOOST_TEST(std::abs(lm1[1_d] - gn1[1_d]) < 1e-5);
+
+	// Columns without contiguous row-major data are read by iterators
+	auto const column = [](auto const& v){ return [&v](c_t, r_t r){
+			return v[d_t(r)];
+		}; };
+	auto const xm = make_matrix_fn(1_CS, 2000_RD, column(xs), maker::morton);
+	auto const yc = make_matrix_fn(1_CS, 2000_RD, column(ys),
+		maker::col_major);
+	auto const layouts = make_column_data(xm, yc);
+	BOOST_TEST((layouts[7] == tuples[7]));
+	BOOST_TEST((layouts[1999] == tuples[1999]));
+	BOOST_TEST((gauss_newton_algorithm(f, start, 1e-10, layouts) == gn1));
+
+	BOOST_CHECK_THROW(make_column_data(xs, std::vector< double >(3)),
+		std::logic_error);
+}
+
+
 // BOOST_AUTO_TEST_CASE(test_gauss_newton_algorithm_linear_fit){
 // 	auto f = [](
 // 			raw_col_vector< double, 2 > const& p,
@@ -149,6 +149,27 @@ BOOST_AUTO_TEST_CASE(test_gaussian_elimination){
 	));
 }
 
+BOOST_AUTO_TEST_CASE(test_gaussian_elimination_float_precision){
+	// Small float systems are solved in double and rounded once
+	constexpr auto mf = make_matrix< float >(4_DS, {
+		{ 4, -1,  0,  2},
+		{ 1,  3, -2,  0},
+		{ 0,  1,  5, -1},
+		{ 2,  0,  1,  6}
+	});
+	constexpr auto vf = make_vector< float >(4_RS, {0.1f, 0.2f, 0.3f, 0.7f});
+
+	auto const xf = gaussian_elimination(mf, vf);
+	auto const xd = gaussian_elimination(convert< double >(mf),
+		convert< double >(vf));
+
+	BOOST_TEST(type_id_runtime(xf) ==
+		(type_id< std_col_vector< float, 4_R > >()));
+	for(auto i = 0_d; i < 4_d; ++i){
+		BOOST_TEST(xf[i] == static_cast< float >(xd[i]));
+	}
+}
+
 BOOST_AUTO_TEST_CASE(test_inverse_2x2){
 	constexpr auto m = make_matrix< float >(2_DS, {
 		{2, 5},
@@ -239,5 +260,66 @@ BOOST_AUTO_TEST_CASE(test_inverse_3x3_3){
 	));
 }
 
+BOOST_AUTO_TEST_CASE(test_inverse_4x4){
+	constexpr auto mf = make_matrix< float >(4_DS, {
+		{ 4, -1,  0,  2},
+		{ 1,  3, -2,  0},
+		{ 0,  1,  5, -1},
+		{ 2,  0,  1,  6}
+	});
+	auto const md = convert< double >(mf);
+	auto const identity = make_identity_matrix< double >(4_DS);
+
+	auto const fi = inverse(mf) * mf;
+	auto const di = inverse(md) * md;
+	auto const dd = inverse(make_matrix_fn(4_DD, [&md](c_t c, r_t r){
+		return md(c, r);
+	}));
+
+	bool result = true;
+	for(auto r = 0_r; r < 4_r; ++r){
+		for(auto c = 0_c; c < 4_c; ++c){
+			result = result &&
+				equal(fi(c, r), identity(c, r)) &&
+				equal(di(c, r), identity(c, r)) &&
+				equal(dd(c, r), inverse(md)(c, r));
+		}
+	}
+	BOOST_TEST(result);
+
+	BOOST_CHECK_THROW(inverse(make_matrix_v< float >(4_DS, 1.f)),
+		std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_determinant){
+	constexpr auto m2 = make_matrix< int >(2_DS, {
+		{2, 5},
+		{1, 3}
+	});
+	static_assert(determinant(m2) == 1);
+
+	BOOST_TEST(determinant(ref1) == 2);
+	BOOST_TEST(determinant(ref2) == 0);
+	BOOST_TEST(equal(determinant(convert< double >(ref3)), 0));
+
+	constexpr auto m4 = make_matrix< double >(4_DS, {
+		{ 4, -1,  0,  2},
+		{ 1,  3, -2,  0},
+		{ 0,  1,  5, -1},
+		{ 2,  0,  1,  6}
+	});
+	auto const d4 = determinant(m4);
+	BOOST_TEST(equal(d4, determinant(make_matrix_fn(4_DD,
+		[&m4](c_t c, r_t r){ return m4(c, r); }))));
+	BOOST_TEST(equal(d4 * 2, determinant(make_matrix_fn(5_DS,
+		[&m4](c_t c, r_t r){
+			if(size_t(c) < 4 && size_t(r) < 4) return m4(c, r);
+			return size_t(c) == size_t(r) ? 2.0 : 0.0;
+		}))));
+
+	BOOST_CHECK_THROW(determinant(make_matrix_v< double >(2_CD, 3_RD)),
+		std::logic_error);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
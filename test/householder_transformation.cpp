@@ -41,44 +41,105 @@ constexpr bool matrix_equal(T const& a, U const& b){
 BOOST_AUTO_TEST_SUITE(suite_householder_transformation)
 
 
-// BOOST_AUTO_TEST_CASE(test_householder_transformation){
-// 	constexpr auto m = make_matrix< double >(3_DS, {
-// 		{0, -4,  2},
-// 		{6, -3, -2},
-// 		{8,  1, -1}
-// 	});
-//
-// 	auto q = make_matrix< double >(3_DS);
-// 	auto r = make_matrix< double >(3_DS);
-//
-// 	std::tie(q, r) = householder_transformation(m);
-//
-// 	BOOST_TEST((
-// 		equal(q(0, 0),  0) &&
-// 		equal(q(1, 0),  0.8) &&
-// 		equal(q(2, 0),  0.6) &&
-// 		equal(q(0, 1), -0.6) &&
-// 		equal(q(1, 1),  0.48) &&
-// 		equal(q(2, 1), -0.64) &&
-// 		equal(q(0, 2), -0.8) &&
-// 		equal(q(1, 2), -0.36) &&
-// 		equal(q(2, 2),  0.48)
-// 	));
-//
-// 	BOOST_TEST((
-// 		equal(r(0, 0), -10) &&
-// 		equal(r(1, 0),   1) &&
-// 		equal(r(2, 0),   2) &&
-// 		equal(r(0, 1),   0) &&
-// 		equal(r(1, 1),  -5) &&
-// 		equal(r(2, 1),   1) &&
-// 		equal(r(0, 2),   0) &&
-// 		equal(r(1, 2),   0) &&
-// 		equal(r(2, 2),   2)
-// 	));
-//
-// 	BOOST_TEST(matrix_equal(q * r, m));
-// }
+BOOST_AUTO_TEST_CASE(test_householder_transformation_4x3){
+	constexpr auto m = make_matrix< double >(3_CS, 4_RS, {
+		{1, -1,  4},
+		{1,  4, -2},
+		{1,  4,  2},
+		{1, -1,  0}
+	});
+
+	auto const [q, r] = householder_transformation(m);
+
+	BOOST_TEST(type_id_runtime(q) ==
+		(type_id< std_square_matrix< double, 4_D > >()));
+	BOOST_TEST(type_id_runtime(r) ==
+		(type_id< std_matrix< double, 3_C, 4_R > >()));
+
+	auto const qr = q * r;
+	auto const qtq = transpose(q) * q;
+	auto const identity = make_identity_matrix< double >(4_DS);
+
+	bool result = true;
+	for(auto y = 0_r; y < 4_r; ++y){
+		for(auto x = 0_c; x < 3_c; ++x){
+			result = result && equal(qr(x, y), m(x, y));
+			if(size_t(x) < size_t(y)) result = result && r(x, y) == 0;
+		}
+		for(auto x = 0_c; x < 4_c; ++x){
+			result = result && equal(qtq(x, y), identity(x, y));
+		}
+	}
+	BOOST_TEST(result);
+}
+
+
+BOOST_AUTO_TEST_CASE(test_householder_transformation){
+	constexpr auto m = make_matrix< double >(3_DS, {
+		{0, -4,  2},
+		{6, -3, -2},
+		{8,  1, -1}
+	});
+
+	auto const [q, r] = householder_transformation(m);
+
+	BOOST_TEST(type_id_runtime(q) ==
+		type_id_runtime(make_identity_matrix< double >(3_DS)));
+	BOOST_TEST(type_id_runtime(r) == type_id_runtime(m));
+
+	BOOST_TEST((
+		equal(q(0_c, 0_r),  0) &&
+		equal(q(1_c, 0_r),  0.8) &&
+		equal(q(2_c, 0_r),  0.6) &&
+		equal(q(0_c, 1_r), -0.6) &&
+		equal(q(1_c, 1_r),  0.48) &&
+		equal(q(2_c, 1_r), -0.64) &&
+		equal(q(0_c, 2_r), -0.8) &&
+		equal(q(1_c, 2_r), -0.36) &&
+		equal(q(2_c, 2_r),  0.48)
+	));
+
+	BOOST_TEST((
+		equal(r(0_c, 0_r), -10) &&
+		equal(r(1_c, 0_r),   1) &&
+		equal(r(2_c, 0_r),   2) &&
+		equal(r(0_c, 1_r),   0) &&
+		equal(r(1_c, 1_r),  -5) &&
+		equal(r(2_c, 1_r),   1) &&
+		equal(r(0_c, 2_r),   0) &&
+		equal(r(1_c, 2_r),   0) &&
+		equal(r(2_c, 2_r),   2)
+	));
+
+	BOOST_TEST(matrix_equal(q * r, m));
+}
+
+BOOST_AUTO_TEST_CASE(test_householder_transformation_3x4){
+	// More columns than rows, R is upper trapezoidal
+	auto const m = make_matrix< double >(4_CD, 3_RD, {
+		{ 0, -4,  2, 1},
+		{ 6, -3, -2, 5},
+		{ 8,  1, -1, 3}
+	});
+
+	auto const [q, r] = householder_transformation(m);
+
+	BOOST_TEST(type_id_runtime(q) ==
+		(type_id< std_square_matrix< double, 0_D > >()));
+	BOOST_TEST(type_id_runtime(r) ==
+		(type_id< std_matrix< double, 0_C, 0_R > >()));
+
+	auto const qr = q * r;
+	bool result = true;
+	for(auto y = 0_r; y < 3_r; ++y){
+		for(auto x = 0_c; x < 4_c; ++x){
+			result = result && equal(qr(x, y), m(x, y));
+			if(size_t(x) < size_t(y)) result = result && r(x, y) == 0;
+		}
+	}
+	BOOST_TEST(result);
+	BOOST_TEST(equal(r(0_c, 0_r), -10));
+}
 
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax least_squares
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/least_squares.hpp>
+#include <mitrax/operator.hpp>
+
+#include <cmath>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+template < typename T, typename U >
+constexpr bool equal(T const& a, U const& b, double threshold = 0.00001){
+	return std::abs(a - b) < threshold;
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_least_squares)
+
+
+BOOST_AUTO_TEST_CASE(test_least_squares_line){
+	// Line fit y = 2 + 3 * x with exact data
+	constexpr auto a = make_matrix< double >(2_CS, 4_RS, {
+		{1, 0},
+		{1, 1},
+		{1, 2},
+		{1, 3}
+	});
+	constexpr auto b = make_vector< double >(4_RS, {2, 5, 8, 11});
+
+	auto const x = least_squares(a, b);
+
+	BOOST_TEST(type_id_runtime(x) ==
+		(type_id< std_col_vector< double, 2_R > >()));
+	BOOST_TEST((equal(x[0_d], 2, 1e-12) && equal(x[1_d], 3, 1e-12)));
+}
+
+BOOST_AUTO_TEST_CASE(test_least_squares_blocks){
+	// Noisy quadratic, many blocks including an odd count for the tree
+	auto const a = make_matrix_fn(3_CS, 10007_RD, [](c_t c, r_t r){
+		auto const t = double(size_t(r)) / 10007;
+		return std::pow(t, double(size_t(c)));
+	});
+	auto const b = make_matrix_fn(2_CS, 10007_RD, [](c_t c, r_t r){
+		auto const t = double(size_t(r)) / 10007;
+		auto const noise = 0.01 * std::sin(double(size_t(r)) * 12.9898);
+		return size_t(c) == 0
+			? 1 - 2 * t + 0.5 * t * t + noise
+			: 3 * t - noise;
+	});
+
+	auto const reference = least_squares(a, b,
+		least_squares_options{100000, 1});
+
+	for(auto const& options: {
+		least_squares_options{64, 1},
+		least_squares_options{1000, 3},
+		least_squares_options{1, 0}
+	}){
+		auto const x = least_squares(a, b, options);
+
+		BOOST_TEST(type_id_runtime(x) ==
+			(type_id< std_matrix< double, 2_C, 3_R > >()));
+
+		bool result = true;
+		for(auto r = 0_r; r < 3_r; ++r){
+			for(auto c = 0_c; c < 2_c; ++c){
+				result = result && equal(x(c, r), reference(c, r), 1e-10);
+			}
+		}
+		BOOST_TEST(result);
+	}
+
+	BOOST_TEST((
+		equal(reference(0_c, 0_r), 1, 0.01) &&
+		equal(reference(0_c, 1_r), -2, 0.01) &&
+		equal(reference(0_c, 2_r), 0.5, 0.01) &&
+		equal(reference(1_c, 0_r), 0, 0.01) &&
+		equal(reference(1_c, 1_r), 3, 0.01) &&
+		equal(reference(1_c, 2_r), 0, 0.01)
+	));
+}
+
+BOOST_AUTO_TEST_CASE(test_least_squares_errors){
+	auto const a = make_matrix< double >(2_CD, 3_RD, {
+		{1, 0},
+		{2, 0},
+		{3, 0}
+	});
+
+	BOOST_CHECK_THROW(least_squares(a, make_vector_v< double >(3_RD, 1.0)),
+		std::logic_error);
+	BOOST_CHECK_THROW(least_squares(a, make_vector_v< double >(2_RD, 1.0)),
+		std::logic_error);
+	BOOST_CHECK_THROW(least_squares(transpose(a),
+		make_vector_v< double >(2_RD, 1.0)), std::logic_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax lu_decomposition
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/lu_decomposition.hpp>
+#include <mitrax/operator.hpp>
+
+#include <cmath>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+template < typename T, typename U >
+constexpr bool equal(T const& a, U const& b, double threshold = 0.00001){
+	return std::abs(a - b) < threshold;
+}
+
+template <
+	typename M1, col_t C1, row_t R1,
+	typename M2, col_t C2, row_t R2
+> bool near(
+	matrix< M1, C1, R1 > const& m1,
+	matrix< M2, C2, R2 > const& m2,
+	double threshold
+){
+	auto const size = get_dims(m1, m2);
+	for(auto r = 0_r; r < size.rows(); ++r){
+		for(auto c = 0_c; c < size.cols(); ++c){
+			if(!equal(m1(c, r), m2(c, r), threshold)) return false;
+		}
+	}
+	return true;
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_lu_decomposition)
+
+
+BOOST_AUTO_TEST_CASE(test_lu_decomposition_3x3){
+	constexpr auto m = make_matrix< float >(3_DS, {
+		{ 1  , -0.2, -0.2},
+		{-0.4,  0.8, -0.1},
+		{ 0  , -0.5,  0.9}
+	});
+
+	auto const lu = lu_decomposition(m);
+
+	BOOST_TEST(type_id_runtime(lu) ==
+		(type_id< lu_decomposition< float, 3_D > >()));
+
+	auto const v = make_vector< float >(3_RS, {7, 12.5, 16.5});
+	auto const x = lu.solve(v);
+
+	BOOST_TEST((
+		x.cols() == 1_CS &&
+		x.rows() == 3_RS &&
+		equal(x[0_d], 20, 0.0001) &&
+		equal(x[1_d], 30, 0.0001) &&
+		equal(x[2_d], 35, 0.0001)
+	));
+}
+
+BOOST_AUTO_TEST_CASE(test_lu_decomposition_factors){
+	auto const m = make_matrix< double >(3_DD, {
+		{1, 2, 0},
+		{2, 4, 1},
+		{2, 1, 0}
+	});
+
+	auto const lu = lu_decomposition(m);
+	BOOST_TEST(type_id_runtime(lu) ==
+		(type_id< lu_decomposition< double, 0_D > >()));
+
+	auto const& p = lu.permutation();
+	auto const pm = make_matrix_fn(m.dims(), [&m, &p](c_t c, r_t r){
+			return m(c, r_t(p[d_t(r)]));
+		});
+
+	BOOST_TEST(near(lu.lower() * lu.upper(), pm, 1e-12));
+	BOOST_TEST(equal(lu.determinant(), 3, 1e-12));
+
+	auto const i = lu.inverse() * 3;
+	BOOST_TEST(near(i, make_matrix< double >(3_DS, {
+			{-1, 0,  2},
+			{ 2, 0, -1},
+			{-6, 3,  0}
+		}), 1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(test_lu_decomposition_multi_rhs){
+	constexpr auto m = make_matrix< double >(2_DS, {
+		{2, 5},
+		{1, 3}
+	});
+
+	auto const lu = lu_decomposition(m);
+	auto const b = make_matrix< double >(3_CS, 2_RS, {
+		{2, 5, 7},
+		{1, 3, 4}
+	});
+
+	BOOST_TEST(near(lu.solve(b), make_matrix< double >(3_CS, 2_RS, {
+			{1, 0, 1},
+			{0, 1, 1}
+		}), 1e-12));
+	BOOST_TEST(equal(lu.determinant(), 1, 1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(test_lu_decomposition_blocked){
+	// Larger than one panel, diagonally dominant with row exchanges
+	auto const n = dims(dim_t(100));
+	auto const m = make_matrix_fn(n, [](c_t c, r_t r){
+			auto const x = double(size_t(c));
+			auto const y = double(size_t(r));
+			return std::sin(x * 0.7 + y * 1.3) + (x == 99 - y ? 200 : 0);
+		});
+
+	auto const lu = lu_decomposition(m);
+
+	auto const& p = lu.permutation();
+	auto const pm = make_matrix_fn(n, [&m, &p](c_t c, r_t r){
+			return m(c, r_t(p[d_t(r)]));
+		});
+	BOOST_TEST(near(lu.lower() * lu.upper(), pm, 1e-9));
+
+	auto const b = make_matrix_fn(3_CS, n.as_row(), [](c_t c, r_t r){
+			return double(size_t(c) + size_t(r));
+		});
+	BOOST_TEST(near(m * lu.solve(b), b, 1e-9));
+
+	BOOST_TEST(near(m * lu.inverse(), make_identity_matrix< double >(n),
+		1e-9));
+}
+
+BOOST_AUTO_TEST_CASE(test_lu_decomposition_errors){
+	auto const singular = make_matrix< float >(3_DS, {
+		{1, 2, 3},
+		{4, 5, 6},
+		{0, 0, 0}
+	});
+	BOOST_CHECK_THROW(lu_decomposition{singular}, std::logic_error);
+
+	auto const rect = make_matrix_v< float >(3_CD, 2_RD);
+	BOOST_CHECK_THROW(lu_decomposition{rect}, std::logic_error);
+
+	auto const lu = lu_decomposition(make_identity_matrix< float >(2_DS));
+	BOOST_CHECK_THROW(lu.solve(make_vector_v< float >(3_RD)),
+		std::logic_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax make_cow_matrix
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/matrix/cow.hpp>
+#include <mitrax/make_matrix.hpp>
+#include <mitrax/compare.hpp>
+
+#include <thread>
+#include <vector>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+namespace{
+
+
+	constexpr auto fn = [](c_t c, r_t r){
+		return int(std::size_t(r) * 10 + std::size_t(c));
+	};
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_make_cow_matrix)
+
+
+BOOST_AUTO_TEST_CASE(test_cow_matrix_copy){
+	auto m1 = make_matrix_fn(3_CS, 2_RD, fn, maker::cow);
+
+	BOOST_TEST(type_id_runtime(m1) ==
+		(type_id< cow_matrix< int, 3_C, 0_R > >()));
+	BOOST_TEST(!m1.impl().shared());
+
+	auto m2 = m1;
+	auto const& c2 = m2;
+	BOOST_TEST((m1.impl().shared() && m2.impl().shared()));
+
+	// const access keeps sharing
+	BOOST_TEST((c2(2_c, 1_r) == 12 && m2.impl().shared()));
+	BOOST_TEST(static_cast< decltype(m1) const& >(m1).data() == c2.data());
+
+	// non-const access duplicates
+	m2(2_c, 1_r) = 0;
+	BOOST_TEST((!m1.impl().shared() && !m2.impl().shared()));
+	BOOST_TEST((m1(2_c, 1_r) == 12 && m2(2_c, 1_r) == 0));
+	BOOST_TEST(m1 != m2);
+
+	// unshared access doesn't copy
+	auto const data = m1.data();
+	m1(0_c, 0_r) = 5;
+	BOOST_TEST(m1.data() == data);
+}
+
+BOOST_AUTO_TEST_CASE(test_cow_matrix_iterate){
+	auto m1 = make_matrix_fn(2_DS, fn, maker::cow);
+	auto m2 = m1;
+
+	for(auto& v: m2) v *= 2;
+
+	BOOST_TEST((m1 == make_matrix_fn(2_DS, fn)));
+	BOOST_TEST((
+		m2(0_c, 0_r) == 0 && m2(1_c, 0_r) == 2 &&
+		m2(0_c, 1_r) == 20 && m2(1_c, 1_r) == 22
+	));
+}
+
+BOOST_AUTO_TEST_CASE(test_cow_matrix_threads){
+	auto const source = make_matrix_fn(8_CD, 8_RD, fn, maker::cow);
+
+	std::vector< cow_bitmap< int > > copies(8, source);
+	std::vector< std::thread > threads;
+	for(std::size_t i = 0; i < copies.size(); ++i){
+		threads.emplace_back([&m = copies[i], i]{
+			for(auto& v: m) v += int(i);
+		});
+	}
+	for(auto& thread: threads) thread.join();
+
+	bool equal = true;
+	for(std::size_t i = 0; i < copies.size(); ++i){
+		equal = equal && copies[i](7_c, 7_r) == 77 + int(i);
+	}
+	BOOST_TEST(equal);
+	BOOST_TEST((source(7_c, 7_r) == 77 && !source.impl().shared()));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,151 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax make_heap_layout_matrix
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/matrix/heap_layout.hpp>
+#include <mitrax/matrix/view.hpp>
+#include <mitrax/make_matrix.hpp>
+#include <mitrax/swap_matrix.hpp>
+#include <mitrax/for_each.hpp>
+#include <mitrax/compare.hpp>
+
+#include <vector>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+namespace{
+
+
+	constexpr auto fn = [](c_t c, r_t r){
+		return int(std::size_t(r) * 10 + std::size_t(c));
+	};
+
+	template < typename M >
+	std::vector< int > for_each_order(M const& m){
+		std::vector< int > result;
+		for_each([&result](int v){ result.push_back(v); }, m);
+		return result;
+	}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_make_heap_layout_matrix)
+
+
+BOOST_AUTO_TEST_CASE(test_col_major_matrix){
+	auto m = make_matrix_fn(3_CS, 2_RD, fn, maker::col_major);
+
+	BOOST_TEST(type_id_runtime(m) ==
+		(type_id< col_major_matrix< int, 3_C, 0_R > >()));
+
+	BOOST_TEST((
+		m(0_c, 0_r) == 0 && m(1_c, 0_r) == 1 && m(2_c, 0_r) == 2 &&
+		m(0_c, 1_r) == 10 && m(1_c, 1_r) == 11 && m(2_c, 1_r) == 12
+	));
+
+	auto const storage = m.impl().storage();
+	BOOST_TEST((std::vector< int >(storage, storage + 6)
+		== std::vector< int >{0, 10, 1, 11, 2, 12}));
+
+	BOOST_TEST((std::vector< int >(m.begin(), m.end())
+		== std::vector< int >{0, 1, 2, 10, 11, 12}));
+
+	BOOST_TEST((for_each_order(m)
+		== std::vector< int >{0, 10, 1, 11, 2, 12}));
+}
+
+BOOST_AUTO_TEST_CASE(test_morton_matrix){
+	auto m = make_matrix_fn(5_CD, 3_RD, fn,
+		maker::heap_layout< layout::morton< 2 > >);
+
+	BOOST_TEST(type_id_runtime(m) ==
+		(type_id< morton_matrix< int, 0_C, 0_R, 2 > >()));
+
+	// 3 x 2 blocks of 2 x 2 values
+	BOOST_TEST(m.impl().storage_size() == 24);
+
+	bool equal = true;
+	for(std::size_t y = 0; y < 3; ++y){
+		for(std::size_t x = 0; x < 5; ++x){
+			equal = equal && m(c_t(x), r_t(y)) == int(y * 10 + x);
+		}
+	}
+	BOOST_TEST(equal);
+
+	auto const storage = m.impl().storage();
+	BOOST_TEST((std::vector< int >(storage, storage + 8)
+		== std::vector< int >{0, 1, 10, 11, 2, 3, 12, 13}));
+
+	BOOST_TEST((for_each_order(m) == std::vector< int >{
+		0, 1, 10, 11, 2, 3, 12, 13, 4, 14, 20, 21, 22, 23, 24}));
+}
+
+BOOST_AUTO_TEST_CASE(test_morton_8x8_index){
+	using layout_type = layout::morton< 8 >;
+
+	BOOST_TEST(layout_type::index(0, 0, 16, 16) == 0);
+	BOOST_TEST(layout_type::index(1, 0, 16, 16) == 1);
+	BOOST_TEST(layout_type::index(0, 1, 16, 16) == 2);
+	BOOST_TEST(layout_type::index(7, 7, 16, 16) == 63);
+	BOOST_TEST(layout_type::index(8, 0, 16, 16) == 64);
+	BOOST_TEST(layout_type::index(0, 8, 16, 16) == 128);
+}
+
+BOOST_AUTO_TEST_CASE(test_heap_layout_compare){
+	auto m1 = make_matrix_fn(4_CD, 3_RD, fn, maker::col_major);
+	auto m2 = make_matrix_fn(4_CD, 3_RD, fn, maker::col_major);
+	auto m3 = make_matrix_fn(4_CD, 3_RD, fn, maker::morton);
+	auto m4 = make_matrix_fn(4_CD, 3_RD, fn);
+
+	BOOST_TEST((m1 == m2 && m1 == m3 && m3 == m4 && m4 == m1));
+
+	m2(3_c, 2_r) = 0;
+	BOOST_TEST((m1 != m2 && m2 != m3 && m2 != m4));
+}
+
+BOOST_AUTO_TEST_CASE(test_heap_layout_transform){
+	auto m = make_matrix_fn(3_CS, 3_RS, fn, maker::morton);
+	auto t = transform([](int v){ return v * 0.5; }, m);
+
+	BOOST_TEST(type_id_runtime(t) ==
+		(type_id< morton_matrix< double, 3_C, 3_R > >()));
+
+	BOOST_TEST((
+		t(0_c, 0_r) == 0 && t(2_c, 0_r) == 1 &&
+		t(0_c, 2_r) == 10 && t(2_c, 2_r) == 11
+	));
+}
+
+BOOST_AUTO_TEST_CASE(test_heap_layout_swap_cols){
+	auto m = make_matrix_fn(3_CD, 2_RD, fn, maker::col_major);
+	swap_cols(m, 0_c, 2_c);
+
+	auto const storage = m.impl().storage();
+	BOOST_TEST((std::vector< int >(storage, storage + 6)
+		== std::vector< int >{2, 12, 1, 11, 0, 10}));
+}
+
+BOOST_AUTO_TEST_CASE(test_col_wise_view_for_each){
+	int values[6] = {0, 10, 1, 11, 2, 12};
+	auto m = maker::view.by_object(3_CS, 2_RS, values, memory_order::col_wise);
+
+	BOOST_TEST((for_each_order(m)
+		== std::vector< int >{0, 10, 1, 11, 2, 12}));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
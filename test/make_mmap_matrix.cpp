@@ -0,0 +1,165 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax make_mmap_matrix
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/matrix/mmap.hpp>
+#include <mitrax/pixel.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+template < typename T >
+struct temp_file{
+	temp_file(std::vector< T > const& values, std::size_t header = 0):
+		name(std::filesystem::temp_directory_path() /
+			("mitrax_mmap_" + std::to_string(++count)))
+	{
+		std::ofstream os(name, std::ios::binary);
+		std::vector< char > head(header, 'h');
+		os.write(head.data(), head.size());
+		os.write(reinterpret_cast< char const* >(values.data()),
+			values.size() * sizeof(T));
+	}
+
+	~temp_file(){
+		std::filesystem::remove(name);
+	}
+
+	std::vector< T > read(std::size_t header = 0)const{
+		std::ifstream is(name, std::ios::binary);
+		is.seekg(header);
+		std::vector< T > values;
+		T v;
+		while(is.read(reinterpret_cast< char* >(&v), sizeof(T))){
+			values.push_back(v);
+		}
+		return values;
+	}
+
+	static inline std::size_t count = 0;
+
+	std::string name;
+};
+
+
+BOOST_AUTO_TEST_SUITE(suite_make_mmap_matrix)
+
+
+BOOST_AUTO_TEST_CASE(test_const_mmap_matrix_3x2){
+	temp_file< int > file({0, 1, 2, 10, 11, 12});
+
+	auto m = make_const_mmap_matrix< int >(3_CS, 2_RS, file.name);
+
+	BOOST_TEST(type_id_runtime(m) ==
+		(type_id< const_mmap_matrix< int, 3_C, 2_R > >()));
+
+	BOOST_TEST((
+		m.cols() == 3_CS &&
+		m.rows() == 2_RS &&
+		m(0_c, 0_r) == 0 &&
+		m(1_c, 0_r) == 1 &&
+		m(2_c, 0_r) == 2 &&
+		m(0_c, 1_r) == 10 &&
+		m(1_c, 1_r) == 11 &&
+		m(2_c, 1_r) == 12
+	));
+}
+
+BOOST_AUTO_TEST_CASE(test_const_mmap_matrix_header){
+	temp_file< short > file({1, 2, 3, 4}, 10);
+
+	auto m = make_const_mmap_matrix< short >(
+		dim_pair(2_CD, 2_RD), file.name, 10,
+		mmap_hints{true, mmap_advice::sequential});
+
+	BOOST_TEST(type_id_runtime(m) ==
+		(type_id< const_mmap_matrix< short, 0_C, 0_R > >()));
+
+	BOOST_TEST((
+		m.cols() == 2_CS &&
+		m.rows() == 2_RS &&
+		m(0_c, 0_r) == 1 &&
+		m(1_c, 0_r) == 2 &&
+		m(0_c, 1_r) == 3 &&
+		m(1_c, 1_r) == 4
+	));
+}
+
+BOOST_AUTO_TEST_CASE(test_mmap_matrix_write){
+	temp_file< float > file({1, 2, 3, 4, 5, 6, 7, 8}, 16);
+
+	{
+		auto m = make_mmap_matrix< float >(2_DS, file.name, 16);
+		for(auto& v: m) v *= 2;
+		m(1_c, 1_r) = 0;
+		m.impl().sync();
+	}
+
+	BOOST_TEST((file.read(16) == std::vector< float >{2, 4, 6, 0, 5, 6, 7, 8}));
+}
+
+BOOST_AUTO_TEST_CASE(test_mmap_matrix_pixel){
+	using pixel::rgb8u;
+	temp_file< rgb8u > file({{1, 2, 3}, {4, 5, 6}});
+
+	auto m = make_const_mmap_matrix< rgb8u >(1_CS, 2_RD, file.name);
+
+	BOOST_TEST((
+		m[0_d].r == 1 && m[0_d].g == 2 && m[0_d].b == 3 &&
+		m[1_d].r == 4 && m[1_d].g == 5 && m[1_d].b == 6
+	));
+}
+
+BOOST_AUTO_TEST_CASE(test_mmap_matrix_empty){
+	temp_file< int > file({0, 1, 2}, 4);
+
+	auto m = make_mmap_matrix< int >(dim_pair(0_CD, 3_RD), file.name);
+	auto c = make_const_mmap_matrix< int >(2_CS, 0_RD, file.name, 12);
+
+	BOOST_TEST((
+		m.cols() == 0_CD &&
+		m.rows() == 3_RS &&
+		m.begin() == m.end() &&
+		c.cols() == 2_CS &&
+		c.rows() == 0_RD &&
+		c.begin() == c.end()
+	));
+
+	m.impl().sync();
+	auto moved = std::move(m);
+	BOOST_TEST(moved.begin() == moved.end());
+
+	BOOST_CHECK_THROW(
+		make_const_mmap_matrix< int >(dim_pair(0_CD, 1_RD),
+			file.name + ".missing"), std::system_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_mmap_matrix_errors){
+	temp_file< int > file({0, 1, 2});
+
+	BOOST_CHECK_THROW(
+		make_const_mmap_matrix< int >(2_DS, file.name), std::runtime_error);
+	BOOST_CHECK_THROW(
+		make_const_mmap_matrix< int >(1_DS, file.name, 2), std::logic_error);
+	BOOST_CHECK_THROW(
+		make_const_mmap_matrix< int >(1_DS, file.name + ".missing"),
+		std::system_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,252 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax make_sparse_matrix
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/sparse.hpp>
+#include <mitrax/operator.hpp>
+#include <mitrax/compare.hpp>
+#include <mitrax/matrix/heap_layout.hpp>
+#include <mitrax/matrix/view.hpp>
+
+#include <cmath>
+#include <vector>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+namespace{
+
+
+	template < typename T, typename U >
+	bool equal(T const& a, U const& b, double threshold){
+		return std::abs(a - b) < threshold;
+	}
+
+	template <
+		typename M1, col_t C1, row_t R1,
+		typename M2, col_t C2, row_t R2
+	> bool near(
+		matrix< M1, C1, R1 > const& m1,
+		matrix< M2, C2, R2 > const& m2,
+		double threshold
+	){
+		auto const size = get_dims(m1, m2);
+		for(auto r = 0_r; r < size.rows(); ++r){
+			for(auto c = 0_c; c < size.cols(); ++c){
+				if(!equal(m1(c, r), m2(c, r), threshold)) return false;
+			}
+		}
+		return true;
+	}
+
+	template < typename M, col_t C, row_t R >
+	auto dense(matrix< M, C, R > const& m){
+		return make_matrix_fn(m.dims(), [&m](c_t c, r_t r){
+			return m(c, r);
+		});
+	}
+
+	/// \brief About one percent non zero values with duplicates
+	std::vector< sparse_triplet< double > >
+	random_triplets(size_t cols, size_t rows){
+		std::vector< sparse_triplet< double > > result;
+		size_t state = 12345;
+		auto const next = [&state]{
+			state = state * 6364136223846793005u + 1442695040888963407u;
+			return state >> 33;
+		};
+
+		for(size_t i = 0; i < cols * rows / 100; ++i){
+			auto const c = next() % cols;
+			auto const r = next() % rows;
+			auto const v = double(next() % 2001) / 1000 - 1;
+			result.push_back({c_t(c), r_t(r), v});
+		}
+		return result;
+	}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_make_sparse_matrix)
+
+
+BOOST_AUTO_TEST_CASE(test_csr_from_triplets){
+	std::vector< sparse_triplet< int > > const triplets{
+		{2_c, 1_r, 5},
+		{0_c, 0_r, 1},
+		{3_c, 2_r, 7},
+		{2_c, 1_r, 1},
+		{1_c, 0_r, 2}
+	};
+
+	auto const m = make_sparse_matrix(4_CD, 3_RD, triplets);
+
+	BOOST_TEST(type_id_runtime(m) ==
+		(type_id< csr_matrix< int, 0_C, 0_R > >()));
+
+	auto const& impl = m.impl();
+	BOOST_TEST(impl.nonzeros() == 4);
+	BOOST_TEST((impl.offsets() == std::vector< size_t >{0, 2, 3, 4}));
+	BOOST_TEST((impl.indices() == std::vector< size_t >{0, 1, 2, 3}));
+	BOOST_TEST((impl.values() == std::vector< int >{1, 2, 6, 7}));
+
+	auto const ref = make_matrix< int >(4_CS, 3_RS, {
+		{1, 2, 0, 0},
+		{0, 0, 6, 0},
+		{0, 0, 0, 7}
+	});
+	BOOST_TEST((m == ref));
+	BOOST_TEST((dense(m) == ref));
+}
+
+BOOST_AUTO_TEST_CASE(test_csc_from_triplets){
+	std::vector< sparse_triplet< int > > const triplets{
+		{2_c, 1_r, 5},
+		{0_c, 0_r, 1},
+		{3_c, 2_r, 7},
+		{2_c, 1_r, 1},
+		{1_c, 0_r, 2}
+	};
+
+	auto const m = make_sparse_matrix< layout::col_major >(
+		4_CS, 3_RS, triplets);
+
+	BOOST_TEST(type_id_runtime(m) ==
+		(type_id< csc_matrix< int, 4_C, 3_R > >()));
+
+	auto const& impl = m.impl();
+	BOOST_TEST((impl.offsets() == std::vector< size_t >{0, 1, 2, 3, 4}));
+	BOOST_TEST((impl.indices() == std::vector< size_t >{0, 0, 1, 2}));
+	BOOST_TEST((impl.values() == std::vector< int >{1, 2, 6, 7}));
+
+	auto const t = transpose(m);
+	BOOST_TEST(type_id_runtime(t) ==
+		(type_id< csr_matrix< int, 3_C, 4_R > >()));
+	BOOST_TEST((t.impl().offsets() == impl.offsets()));
+	BOOST_TEST((t == transpose(dense(m))));
+}
+
+BOOST_AUTO_TEST_CASE(test_sparse_maker){
+	auto const ref = make_matrix< float >(3_CS, 2_RS, {
+		{0, 1.5f, 0},
+		{2, 0, 0}
+	});
+
+	auto const m = make_matrix_fn(ref.dims(), [&ref](c_t c, r_t r){
+		return ref(c, r);
+	}, maker::csc);
+
+	BOOST_TEST(type_id_runtime(m) ==
+		(type_id< csc_matrix< float, 3_C, 2_R > >()));
+	BOOST_TEST(m.impl().nonzeros() == 2);
+	BOOST_TEST((m == ref));
+
+	std::vector< float > values(m.begin(), m.end());
+	BOOST_TEST((values == std::vector< float >{0, 1.5f, 0, 2, 0, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(test_sparse_products){
+	auto const triplets = random_triplets(800, 1000);
+	auto const csr = make_sparse_matrix(800_CD, 1000_RD, triplets);
+	auto const csc =
+		make_sparse_matrix< layout::col_major >(800_CD, 1000_RD, triplets);
+	auto const a = dense(csr);
+
+	auto const x = make_matrix_fn(16_CS, 800_RD, [](c_t c, r_t r){
+		return std::sin(double(size_t(c) * 800 + size_t(r)));
+	});
+	auto const xt = make_matrix_fn(16_CS, 1000_RD, [](c_t c, r_t r){
+		return std::cos(double(size_t(c) * 1000 + size_t(r)));
+	});
+	auto const v = make_vector_fn(800_RD, [](size_t i){
+		return double(i % 7) - 3;
+	});
+	auto const w = make_matrix_fn(1000_CD, 5_RS, [](c_t c, r_t r){
+		return std::sin(double(size_t(r) * 1000 + size_t(c)));
+	});
+
+	auto const ax = a * x;
+	auto const atx = transpose(a) * xt;
+	auto const av = a * v;
+	auto const wa = w * a;
+
+	BOOST_TEST(type_id_runtime(csr * x) ==
+		(type_id< std_matrix< double, 16_C, 0_R > >()));
+	BOOST_TEST(type_id_runtime(w * csr) ==
+		(type_id< std_matrix< double, 0_C, 5_R > >()));
+
+	for(size_t threads: {1, 4}){
+		sparse_options const options{threads};
+
+		BOOST_TEST(near(multiply(csr, x, options), ax, 1e-12));
+		BOOST_TEST(near(multiply(csc, x, options), ax, 1e-12));
+		BOOST_TEST(near(multiply(csr, v, options), av, 1e-12));
+		BOOST_TEST(near(multiply(csc, v, options), av, 1e-12));
+		BOOST_TEST(near(transpose_multiply(csr, xt, options), atx, 1e-12));
+		BOOST_TEST(near(transpose_multiply(csc, xt, options), atx, 1e-12));
+		BOOST_TEST(near(multiply(w, csr, options), wa, 1e-12));
+		BOOST_TEST(near(multiply(w, csc, options), wa, 1e-12));
+	}
+
+	BOOST_TEST(near(csr * v, av, 1e-12));
+	BOOST_TEST(near(w * csc, wa, 1e-12));
+	BOOST_TEST(near(transpose(csc) * xt, atx, 1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(test_sparse_dense_storage){
+	std::vector< sparse_triplet< double > > const triplets{
+		{0_c, 0_r, 1.0}, {1_c, 0_r, 2.0}, {1_c, 1_r, 3.0}};
+	auto const csr = make_sparse_matrix(2_CD, 2_RD, triplets);
+	auto const csc =
+		make_sparse_matrix< layout::col_major >(2_CD, 2_RD, triplets);
+
+	// X = {{1, 0}, {0, 1}} stored column by column
+	std::vector< double > const values{1, 0, 0, 1};
+	auto const x = maker::const_view.by_object(2_CS, 2_RS, values,
+		memory_order::col_wise);
+	auto const fn = [&x](c_t c, r_t r){ return x(c, r); };
+	auto const c = make_matrix_fn(2_CD, 2_RD, fn, maker::col_major);
+	auto const m = make_matrix_fn(2_CD, 2_RD, fn, maker::morton);
+	auto const a = dense(csr);
+
+	BOOST_TEST(near(multiply(csr, x), a, 1e-12));
+	BOOST_TEST(near(multiply(csc, x), a, 1e-12));
+	BOOST_TEST(near(multiply(csr, c), a, 1e-12));
+	BOOST_TEST(near(transpose_multiply(csc, m), transpose(a), 1e-12));
+	BOOST_TEST(near(multiply(x, csr), a, 1e-12));
+	BOOST_TEST(near(multiply(m, csc), a, 1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(test_sparse_errors){
+	std::vector< sparse_triplet< double > > const outside{{3_c, 0_r, 1.0}};
+	BOOST_CHECK_THROW(make_sparse_matrix(3_CD, 3_RD, outside),
+		std::logic_error);
+
+	BOOST_CHECK_THROW(maker::csr.by_compressed(2_CD, 2_RD,
+		{0, 1, 1}, {2}, std::vector< double >{1.0}), std::logic_error);
+	BOOST_CHECK_THROW(maker::csr.by_compressed(2_CD, 2_RD,
+		{0, 2, 2}, {1, 0}, std::vector< double >{1.0, 2.0}),
+		std::logic_error);
+
+	std::vector< sparse_triplet< double > > const inside{{2_c, 1_r, 1.0}};
+	auto const m = make_sparse_matrix(3_CD, 2_RD, inside);
+	auto const v = make_vector_v< double >(2_RD, 1.0);
+	BOOST_CHECK_THROW(multiply(m, v), std::logic_error);
+	BOOST_CHECK_THROW(multiply(v, m), std::logic_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,211 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax make_tiled_matrix
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/matrix/tiled.hpp>
+#include <mitrax/make_matrix.hpp>
+#include <mitrax/detail/parallel_for.hpp>
+
+#include <atomic>
+#include <filesystem>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+namespace{
+
+
+	// 2x2 tiles, at most two of them in memory
+	constexpr auto small_tiles = tiled_options{2, 2, 2};
+
+	template < std::size_t Cols >
+	constexpr auto fn = [](c_t c, r_t r){
+		return int(std::size_t(r) * Cols + std::size_t(c));
+	};
+
+
+	template < typename Codec >
+	void check_sequence(){
+		auto m = make_matrix_fn(5_CD, 3_RD, fn< 10 >,
+			maker::tiled_t< Codec >(small_tiles));
+
+		BOOST_TEST(type_id_runtime(m) ==
+			(type_id< tiled_matrix< int, 0_C, 0_R, Codec > >()));
+
+		bool equal = true;
+		for(std::size_t y = 0; y < 3; ++y){
+			for(std::size_t x = 0; x < 5; ++x){
+				equal = equal && m(c_t(x), r_t(y)) == int(y * 10 + x);
+			}
+		}
+		BOOST_TEST(equal);
+	}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_make_tiled_matrix)
+
+
+BOOST_AUTO_TEST_CASE(test_tiled_matrix_sequence){
+	check_sequence< tile_codec::raw >();
+	check_sequence< tile_codec::rle >();
+}
+
+BOOST_AUTO_TEST_CASE(test_tiled_matrix_write_back){
+	auto m = make_tiled_matrix< float >(3_CS, 5_RS, small_tiles);
+
+	BOOST_TEST(type_id_runtime(m) ==
+		(type_id< tiled_matrix< float, 3_C, 5_R > >()));
+
+	// Every write evicts an earlier tile
+	for(std::size_t i = 0; i < 15; ++i){
+		m(c_t(i % 3), r_t(i / 3)) = float(i);
+	}
+
+	bool equal = true;
+	for(std::size_t i = 15; i > 0; --i){
+		equal = equal && m(c_t((i - 1) % 3), r_t((i - 1) / 3)) == float(i - 1);
+	}
+	BOOST_TEST(equal);
+}
+
+BOOST_AUTO_TEST_CASE(test_tiled_matrix_iterator){
+	auto m = make_matrix_fn(4_CD, 3_RD, fn< 4 >, maker::tiled_t<>(
+		tiled_options{3, 2, 2, tile_prefetch::row_wise}));
+
+	for(auto&& v: m) v *= 2;
+
+	auto const& cm = m;
+	int sum = 0;
+	std::size_t i = 0;
+	bool equal = true;
+	for(auto v: cm){
+		equal = equal && v == int(2 * i++);
+		sum += v;
+	}
+	BOOST_TEST(equal);
+	BOOST_TEST(i == 12);
+	BOOST_TEST(sum == 132);
+}
+
+BOOST_AUTO_TEST_CASE(test_tiled_matrix_for_each_transform){
+	auto m = make_matrix_fn(5_CD, 5_RD, fn< 5 >,
+		maker::tiled_t< tile_codec::rle >(
+			tiled_options{2, 3, 2, tile_prefetch::col_wise}));
+
+	int sum = 0;
+	std::size_t count = 0;
+	for_each([&sum, &count](int v){ sum += v; ++count; }, m);
+	BOOST_TEST(sum == 300);
+	BOOST_TEST(count == 25);
+
+	auto t = transform([](int v){ return v * 0.5; }, m);
+	BOOST_TEST(type_id_runtime(t) ==
+		(type_id< tiled_matrix< double, 0_C, 0_R, tile_codec::rle > >()));
+
+	bool equal = true;
+	for(std::size_t i = 0; i < 25; ++i){
+		equal = equal && t(c_t(i % 5), r_t(i / 5)) == i * 0.5;
+	}
+	BOOST_TEST(equal);
+}
+
+BOOST_AUTO_TEST_CASE(test_tiled_matrix_directory){
+	auto const path = std::filesystem::temp_directory_path() /
+		"mitrax_tiled_matrix_directory";
+	std::filesystem::remove_all(path);
+	auto const directory = path.string();
+
+	auto options = small_tiles;
+	options.directory = directory;
+
+	{
+		auto m = make_tiled_matrix< int >(3_CD, 3_RD, options);
+		m(0_c, 0_r) = 1;
+		m(2_c, 2_r) = 9;
+		m.impl().prefetch(2_c, 0_r);
+	}
+
+	{
+		auto m = make_tiled_matrix< int >(3_CD, 3_RD, options);
+		BOOST_TEST((
+			m(0_c, 0_r) == 1 &&
+			m(1_c, 0_r) == 0 &&
+			m(2_c, 0_r) == 0 &&
+			m(2_c, 2_r) == 9
+		));
+	}
+
+	std::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_tiled_matrix_read_only){
+	auto const path = std::filesystem::temp_directory_path() /
+		"mitrax_tiled_matrix_read_only";
+	std::filesystem::remove_all(path);
+	auto const directory = path.string();
+
+	auto options = small_tiles;
+	options.directory = directory;
+
+	{
+		auto m = make_tiled_matrix< int >(6_CD, 2_RD, options);
+
+		// Reads through the non-const matrix, all tiles are evicted
+		int sum = 0;
+		for(std::size_t x = 0; x < 6; ++x) sum += m(c_t(x), 0_r);
+		BOOST_TEST(sum == 0);
+		BOOST_TEST(std::filesystem::is_empty(path));
+
+		m(5_c, 1_r) = 7;
+		m(0_c, 0_r) = m(5_c, 1_r);
+		m(0_c, 1_r) += 3;
+		BOOST_TEST((
+			m(0_c, 0_r) == 7 &&
+			m(0_c, 1_r) == 3 &&
+			m(5_c, 1_r) == 7
+		));
+	}
+
+	BOOST_TEST(std::filesystem::exists(path / "tile_0"));
+	BOOST_TEST(!std::filesystem::exists(path / "tile_1"));
+	BOOST_TEST(std::filesystem::exists(path / "tile_2"));
+
+	std::filesystem::remove_all(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_tiled_matrix_concurrent_read){
+	auto const m = make_matrix_fn(8_CD, 8_RD, fn< 8 >,
+		maker::tiled_t<>(small_tiles));
+
+	std::atomic< int > sum(0);
+	detail::parallel_for(64, 4, [&m, &sum](std::size_t i){
+		sum += m(c_t(i % 8), r_t(i / 8));
+	});
+	BOOST_TEST(sum == 2016);
+}
+
+BOOST_AUTO_TEST_CASE(test_tiled_matrix_errors){
+	BOOST_CHECK_THROW(make_tiled_matrix< int >(3_CD, 3_RD,
+		tiled_options{0, 2, 2}), std::logic_error);
+	BOOST_CHECK_THROW(make_tiled_matrix< int >(3_CD, 3_RD,
+		tiled_options{2, 2, 0}), std::logic_error);
+	BOOST_CHECK_THROW(make_tiled_matrix< int >(3_CD, 3_RD,
+		tiled_options{2, 2, 1}), std::logic_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,230 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax matrix_batch
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/batch.hpp>
+#include <mitrax/gaussian_elimination.hpp>
+#include <mitrax/compare.hpp>
+#include <mitrax/operator.hpp>
+
+#include <cfenv>
+#include <cmath>
+#include <vector>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+template < typename T, typename U >
+constexpr bool equal(T const& a, U const& b, double threshold = 0.00001){
+	return std::abs(a - b) < threshold;
+}
+
+template <
+	typename M1, col_t C1, row_t R1,
+	typename M2, col_t C2, row_t R2
+> bool near(
+	matrix< M1, C1, R1 > const& m1,
+	matrix< M2, C2, R2 > const& m2,
+	double threshold
+){
+	auto const size = get_dims(m1, m2);
+	for(auto r = 0_r; r < size.rows(); ++r){
+		for(auto c = 0_c; c < size.cols(); ++c){
+			if(!equal(m1(c, r), m2(c, r), threshold)) return false;
+		}
+	}
+	return true;
+}
+
+
+/// \brief Diagonally dominant N x N matrix number i
+template < std::size_t N >
+auto test_matrix(std::size_t i){
+	return make_matrix_fn(dims< dim_t(N) >(), [i](c_t c, r_t r){
+		auto const x = double(size_t(c)), y = double(size_t(r));
+		auto const v = std::sin(double(i) * 0.7 + x * 1.3 + y * 2.9);
+		return x == y ? v + N + 1 : v;
+	});
+}
+
+/// \brief Symmetric N x N matrix number i
+template < std::size_t N >
+auto test_symmetric_matrix(std::size_t i){
+	auto const m = test_matrix< N >(i);
+	return make_matrix_fn(dims< dim_t(N) >(), [&m](c_t c, r_t r){
+		return m(c, r) + m(c_t(size_t(r)), r_t(size_t(c)));
+	});
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_matrix_batch)
+
+
+BOOST_AUTO_TEST_CASE(test_matrix_batch_layout){
+	matrix_batch< int, 2_C, 3_R > batch(5);
+
+	BOOST_TEST(batch.size() == 5);
+	BOOST_TEST((batch.cols() == 2_CS && batch.rows() == 3_RS));
+
+	batch.set(3, make_matrix< int >(2_CS, 3_RS, {
+		{1, 2},
+		{3, 4},
+		{5, 6}
+	}));
+
+	// Element (1, 2) of all matrices is contiguous
+	BOOST_TEST(batch.component(1_c, 2_r)[3] == 6);
+	BOOST_TEST(batch.component(5)[3] == 6);
+	BOOST_TEST(batch.component(1_c, 2_r) == batch.component(1_c, 0_r) + 20);
+
+	auto const m = batch[3];
+	BOOST_TEST(type_id_runtime(m) ==
+		(type_id< std_matrix< int, 2_C, 3_R > >()));
+	BOOST_TEST((m(0_c, 0_r) == 1 && m(1_c, 1_r) == 4 && m(0_c, 2_r) == 5));
+	BOOST_TEST((batch[0](1_c, 2_r) == 0));
+}
+
+BOOST_AUTO_TEST_CASE(test_matrix_batch_multiply){
+	std::vector< std_matrix< double, 3_C, 2_R > > a;
+	std::vector< std_matrix< double, 4_C, 3_R > > b;
+	for(std::size_t i = 0; i < 37; ++i){
+		a.push_back(make_matrix_fn(3_CS, 2_RS, [i](c_t c, r_t r){
+			return double(i) + double(size_t(c)) - 2 * double(size_t(r));
+		}));
+		b.push_back(make_matrix_fn(4_CS, 3_RS, [i](c_t c, r_t r){
+			return double(i % 5) * double(size_t(c)) + double(size_t(r));
+		}));
+	}
+
+	auto const ab = make_matrix_batch(a) * make_matrix_batch(b);
+
+	BOOST_TEST(type_id_runtime(ab) ==
+		(type_id< matrix_batch< double, 4_C, 2_R > >()));
+
+	bool result = true;
+	for(std::size_t i = 0; i < 37; ++i){
+		result = result && near(ab[i], a[i] * b[i], 1e-12);
+	}
+	BOOST_TEST(result);
+
+	auto const small = matrix_batch< double, 4_C, 3_R >(2);
+	BOOST_CHECK_THROW(make_matrix_batch(a) * small, std::logic_error);
+}
+
+template < std::size_t N, typename T >
+void check_inverse_solve(double threshold){
+	std::vector< std_square_matrix< T, dim_t(N) > > m;
+	std::vector< std_col_vector< T, row_t(N) > > v;
+	for(std::size_t i = 0; i < 21; ++i){
+		m.push_back(convert< T >(test_matrix< N >(i)));
+		v.push_back(make_vector_fn(rows< row_t(N) >(), [i](size_t r){
+			return T(i) - T(r);
+		}));
+	}
+
+	auto const mb = make_matrix_batch(m);
+	auto const inv = inverse(mb);
+	auto const x = gaussian_elimination(mb, make_matrix_batch(v));
+
+	bool result = true;
+	for(std::size_t i = 0; i < 21; ++i){
+		result = result &&
+			near(inv[i], inverse(m[i]), threshold) &&
+			near(m[i] * x[i], v[i], threshold);
+	}
+	BOOST_TEST(result);
+}
+
+BOOST_AUTO_TEST_CASE(test_matrix_batch_inverse_solve){
+	check_inverse_solve< 2, double >(1e-12);
+	check_inverse_solve< 3, double >(1e-12);
+	check_inverse_solve< 4, double >(1e-12);
+	check_inverse_solve< 4, float >(1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(test_matrix_batch_padding){
+	// 3 matrices fill only a part of a lane block
+	std::vector< std_square_matrix< int, 2_D > > m(3,
+		make_identity_matrix< int >(2_DS));
+	std::vector< std_col_vector< int, 2_R > > v(3,
+		make_vector< int >(2_RS, {4, 5}));
+
+	auto const mb = make_matrix_batch(m);
+	auto const inv = inverse(mb);
+	auto const x = gaussian_elimination(mb, make_matrix_batch(v));
+
+	bool result = true;
+	for(std::size_t i = 0; i < 3; ++i){
+		result = result && inv[i] == m[i] && x[i] == v[i];
+	}
+	BOOST_TEST(result);
+
+	// The lanes behind the last matrix do not divide by 0
+	std::vector< std_square_matrix< double, 3_D > > f;
+	std::vector< std_col_vector< double, 3_R > > b;
+	for(std::size_t i = 0; i < 5; ++i){
+		f.push_back(test_matrix< 3 >(i));
+		b.push_back(make_vector< double >(3_RS, {1, 2, 3}));
+	}
+
+	std::feclearexcept(FE_ALL_EXCEPT);
+	auto const fb = make_matrix_batch(f);
+	inverse(fb);
+	gaussian_elimination(fb, make_matrix_batch(b));
+	symmetric_eigen(fb);
+	BOOST_TEST(!std::fetestexcept(FE_DIVBYZERO | FE_INVALID));
+}
+
+template < std::size_t N >
+void check_eigen(){
+	std::vector< std_square_matrix< double, dim_t(N) > > m;
+	for(std::size_t i = 0; i < 19; ++i){
+		m.push_back(test_symmetric_matrix< N >(i));
+	}
+	// Repeated eigenvalues
+	m.push_back(make_identity_matrix< double >(dims< dim_t(N) >()));
+
+	auto const [w, v] = symmetric_eigen(make_matrix_batch(m));
+
+	BOOST_TEST(type_id_runtime(w) ==
+		(type_id< matrix_batch< double, 1_C, row_t(N) > >()));
+
+	bool result = true;
+	for(std::size_t i = 0; i < m.size(); ++i){
+		auto const wi = w[i];
+		auto const vi = v[i];
+		auto const d = make_matrix_fn(dims< dim_t(N) >(),
+			[&wi](c_t c, r_t r){
+				return size_t(c) == size_t(r) ? wi[d_t(size_t(r))] : 0.0;
+			});
+
+		result = result &&
+			near(m[i] * vi, vi * d, 1e-10) &&
+			near(transpose(vi) * vi,
+				make_identity_matrix< double >(dims< dim_t(N) >()), 1e-10);
+		for(std::size_t k = 1; k < N; ++k){
+			result = result && wi[d_t(k - 1)] <= wi[d_t(k)];
+		}
+	}
+	BOOST_TEST(result);
+}
+
+BOOST_AUTO_TEST_CASE(test_matrix_batch_symmetric_eigen){
+	check_eigen< 2 >();
+	check_eigen< 3 >();
+	check_eigen< 4 >();
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,170 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax mixed_precision
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/mixed_precision.hpp>
+#include <mitrax/operator.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+namespace{
+
+
+	template <
+		typename M1, col_t C1, row_t R1,
+		typename M2, col_t C2, row_t R2
+	> double max_difference(
+		matrix< M1, C1, R1 > const& m1,
+		matrix< M2, C2, R2 > const& m2
+	){
+		auto const size = get_dims(m1, m2);
+		double result = 0;
+		for(auto r = 0_r; r < size.rows(); ++r){
+			for(auto c = 0_c; c < size.cols(); ++c){
+				result = std::max(result,
+					std::abs(double(m1(c, r)) - double(m2(c, r))));
+			}
+		}
+		return result;
+	}
+
+	/// \brief Matrix with a condition number of about 10^4
+	auto ill_conditioned(size_t n){
+		return make_matrix_fn(dims(dim_t(n)), [n](c_t c, r_t r){
+			auto const i = size_t(r);
+			auto const j = size_t(c);
+			auto const v = std::sin(double(i * n + j + 1));
+			return i == j ? v + std::pow(10.0, -4.0 * double(i) / double(n))
+				: v / double(n);
+		});
+	}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_mixed_precision)
+
+
+BOOST_AUTO_TEST_CASE(test_refinement){
+	constexpr size_t n = 150;
+	auto const a = ill_conditioned(n);
+	auto const x = make_matrix_fn(2_CS, rows(row_t(n)), [](c_t c, r_t r){
+		return std::cos(double(size_t(c) * 1000 + size_t(r)));
+	});
+	auto const b = a * x;
+
+	auto const lu = mixed_precision_lu_decomposition(a);
+	BOOST_TEST(type_id_runtime(lu) ==
+		(type_id< mixed_precision_lu_decomposition< double, 0_D > >()));
+	BOOST_TEST(lu.mixed());
+
+	auto const refined = lu.solve(b);
+	auto const single = lu_decomposition< float, 0_D >(a).solve(b);
+	auto const full = lu_decomposition(a).solve(b);
+
+	auto const e_refined = max_difference(refined, x);
+	auto const e_single = max_difference(single, x);
+	auto const e_full = max_difference(full, x);
+
+	BOOST_TEST(e_refined < 1e-3 * e_single);
+	BOOST_TEST(e_refined < 10 * e_full + 1e-13);
+
+	{
+		mixed_precision_options options;
+		options.fallback = false;
+		auto const y = mixed_precision_solve(a, b, options);
+		BOOST_TEST(max_difference(y, refined) == 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_compile_time){
+	constexpr auto a = make_matrix< double >(3_DS, {
+		{ 1  , -0.2, -0.2},
+		{-0.4,  0.8, -0.1},
+		{ 0  , -0.5,  0.9}
+	});
+	constexpr auto b = make_vector< double >(3_RS, {1, 2, 3});
+
+	auto const x = mixed_precision_solve(a, b);
+	BOOST_TEST(type_id_runtime(x) ==
+		(type_id< std_col_vector< double, 3_R > >()));
+	BOOST_TEST(max_difference(a * x, b) < 1e-15);
+}
+
+BOOST_AUTO_TEST_CASE(test_fallback){
+	// Hilbert matrix, condition number about 10^13
+	auto const a = make_matrix_fn(10_DS, [](c_t c, r_t r){
+		return 1.0 / double(size_t(c) + size_t(r) + 1);
+	});
+	auto const b = make_vector_v< double >(10_RS, 1.0);
+
+	auto const x = mixed_precision_solve(a, b);
+	auto const full = lu_decomposition(a).solve(b);
+	BOOST_TEST(max_difference(x, full) == 0);
+
+	// The full precision factorisation is reused by later solves
+	mixed_precision_lu_decomposition const lu(a);
+	auto const c = make_vector_fn(10_RS, [](size_t i){
+		return double(i) - 4;
+	});
+	BOOST_TEST(max_difference(lu.solve(b), full) == 0);
+	BOOST_TEST(max_difference(lu.solve(c),
+		lu_decomposition(a).solve(c)) == 0);
+
+	mixed_precision_options options;
+	options.fallback = false;
+	BOOST_CHECK_THROW(mixed_precision_solve(a, b, options),
+		std::logic_error);
+
+	auto const singular = make_matrix_v< double >(5_DS);
+	BOOST_CHECK_THROW(mixed_precision_solve(singular,
+		make_vector_v< double >(5_RS)), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent_fallback){
+	auto const a = make_matrix_fn(10_DS, [](c_t c, r_t r){
+		return 1.0 / double(size_t(c) + size_t(r) + 1);
+	});
+	auto const b = make_vector_v< double >(10_RS, 1.0);
+	auto const full = lu_decomposition(a).solve(b);
+
+	// All threads need the full precision factorisation at once
+	mixed_precision_lu_decomposition const lu(a);
+	std::atomic< int > started(0);
+	std::atomic< int > equal(0);
+	std::vector< std::thread > threads;
+	for(int i = 0; i < 4; ++i){
+		threads.emplace_back([&]{
+			for(++started; started < 4;) std::this_thread::yield();
+			if(max_difference(lu.solve(b), full) == 0) ++equal;
+		});
+	}
+	for(auto& thread: threads) thread.join();
+	BOOST_TEST(equal == 4);
+
+	// Copies share the factorisation
+	auto const copy = lu;
+	BOOST_TEST(max_difference(copy.solve(b), full) == 0);
+}
+
+
+
+BOOST_AUTO_TEST_SUITE_END()
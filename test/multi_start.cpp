@@ -0,0 +1,153 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax multi_start
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/multi_start.hpp>
+#include <mitrax/compare.hpp>
+
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+namespace{
+
+
+	/// \brief y = a * sin(b * x), b has many local minima
+	auto const sine_fit = [](
+		auto const& p,
+		std::tuple< double, double > const& v
+	){
+		using std::sin;
+		return p[0_d] * sin(p[1_d] * std::get< 0 >(v)) - std::get< 1 >(v);
+	};
+
+	std::vector< std::tuple< double, double > > sine_data(){
+		std::vector< std::tuple< double, double > > data;
+		for(size_t i = 0; i < 200; ++i){
+			auto const x = 0.05 * double(i);
+			data.emplace_back(x, 2 * std::sin(3 * x));
+		}
+		return data;
+	}
+
+	auto sine_starts(){
+		std::vector< stack_col_vector< double, 2_R > > starts;
+		for(size_t i = 0; i < 12; ++i){
+			starts.push_back(make_vector< double >(2_RS,
+				{1, 0.5 + 0.5 * double(i)}));
+		}
+		return starts;
+	}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_multi_start)
+
+
+BOOST_AUTO_TEST_CASE(test_best_result){
+	auto const data = sine_data();
+	auto const starts = sine_starts();
+
+	auto const seq = multi_start_levenberg_marquardt(execution::seq,
+		sine_fit, starts, 1e-10, 1., 0.3, 0.9, data);
+	auto const par = multi_start_levenberg_marquardt(
+		execution::parallel_policy{4}, sine_fit, starts, 1e-10, 1., 0.3,
+		0.9, data);
+
+	BOOST_TEST(seq.runs.size() == starts.size());
+	BOOST_TEST(std::abs(std::abs(seq.parameters[0_d]) - 2) < 1e-6);
+	BOOST_TEST(std::abs(std::abs(seq.parameters[1_d]) - 3) < 1e-6);
+	BOOST_TEST(seq.cost < 1e-12);
+
+	// Not every start finds the global minimum
+	size_t local = 0;
+	for(size_t i = 0; i < starts.size(); ++i){
+		auto const& run = seq.runs[i];
+		BOOST_TEST(((run.status == multi_start_status::finished) ||
+			(run.status == multi_start_status::failed)));
+		if(run.status != multi_start_status::finished) continue;
+		BOOST_TEST(run.iterations > 0);
+		BOOST_TEST(run.cost >= seq.cost);
+		if(run.cost > 1) ++local;
+
+		BOOST_TEST((par.runs[i].status == run.status));
+		BOOST_TEST(par.runs[i].iterations == run.iterations);
+		BOOST_TEST(par.runs[i].cost == run.cost);
+	}
+	BOOST_TEST(local > 0);
+	BOOST_TEST(par.best == seq.best);
+	BOOST_TEST((par.parameters == seq.parameters));
+}
+
+BOOST_AUTO_TEST_CASE(test_target_cost){
+	auto const data = sine_data();
+	auto starts = sine_starts();
+	starts.insert(starts.begin(), make_vector< double >(2_RS, {2.1, 2.9}));
+
+	multi_start_options options;
+	options.target_cost = 1e-12;
+	auto const result = multi_start_levenberg_marquardt(execution::seq,
+		sine_fit, starts, 1e-10, 1., 0.3, 0.9, data, options);
+
+	BOOST_TEST(result.best == 0);
+	BOOST_TEST(result.cost <= 1e-12);
+	BOOST_TEST((result.runs[0].status == multi_start_status::finished));
+	for(size_t i = 1; i < starts.size(); ++i){
+		BOOST_TEST((result.runs[i].status == multi_start_status::skipped));
+		BOOST_TEST(result.runs[i].iterations == 0);
+	}
+
+	// The second run stops only by cancellation
+	std::vector< double > const values{0, 1};
+	auto const cancelled = multi_start(execution::parallel_policy{2},
+		values,
+		[](double start, nonlinear_options const&, auto&& observer){
+			nonlinear_iteration< double > state{};
+			if(start == 0) return start;
+			while(observer(state)) ++state.iteration;
+			return start;
+		},
+		[](double x){ return x; }, options);
+	BOOST_TEST(cancelled.best == 0);
+	BOOST_TEST((cancelled.runs[1].status == multi_start_status::cancelled ||
+		cancelled.runs[1].status == multi_start_status::skipped));
+}
+
+BOOST_AUTO_TEST_CASE(test_failed_runs){
+	std::vector< double > const starts{1, -1, 2};
+
+	auto const result = multi_start(execution::par, starts,
+		[](double start, nonlinear_options const&, auto&&){
+			if(start < 0) throw std::runtime_error("diverged");
+			return start;
+		},
+		[](double x){ return (x - 2) * (x - 2); });
+
+	BOOST_TEST(result.best == 2);
+	BOOST_TEST(result.parameters == 2);
+	BOOST_TEST((result.runs[1].status == multi_start_status::failed));
+
+	BOOST_CHECK_THROW(multi_start(execution::seq, std::vector< double >{-1},
+		[](double, nonlinear_options const&, auto&&)->double{
+			throw std::runtime_error("diverged");
+		},
+		[](double x){ return x; }), std::logic_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
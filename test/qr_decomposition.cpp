@@ -0,0 +1,159 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax qr_decomposition
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/qr_decomposition.hpp>
+#include <mitrax/operator.hpp>
+
+#include <cmath>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+template < typename T, typename U >
+constexpr bool equal(T const& a, U const& b, double threshold = 0.00001){
+	return std::abs(a - b) < threshold;
+}
+
+template <
+	typename M1, col_t C1, row_t R1,
+	typename M2, col_t C2, row_t R2
+> bool near(
+	matrix< M1, C1, R1 > const& m1,
+	matrix< M2, C2, R2 > const& m2,
+	double threshold
+){
+	auto const size = get_dims(m1, m2);
+	for(auto r = 0_r; r < size.rows(); ++r){
+		for(auto c = 0_c; c < size.cols(); ++c){
+			if(!equal(m1(c, r), m2(c, r), threshold)) return false;
+		}
+	}
+	return true;
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_qr_decomposition)
+
+
+BOOST_AUTO_TEST_CASE(test_qr_decomposition_3x3){
+	constexpr auto m = make_matrix< double >(3_DS, {
+		{12, -51,   4},
+		{ 6, 167, -68},
+		{-4,  24, -41}
+	});
+
+	auto const qr = qr_decomposition(m);
+
+	BOOST_TEST(type_id_runtime(qr) ==
+		(type_id< qr_decomposition< double, 3_C, 3_R > >()));
+
+	auto const q = qr.q();
+	auto const r = qr.r();
+
+	BOOST_TEST(type_id_runtime(q) ==
+		(type_id< std_square_matrix< double, 3_D > >()));
+	BOOST_TEST(type_id_runtime(r) ==
+		(type_id< std_square_matrix< double, 3_D > >()));
+
+	BOOST_TEST((
+		equal(std::abs(r(0_c, 0_r)), 14) &&
+		equal(std::abs(r(1_c, 1_r)), 175) &&
+		equal(std::abs(r(2_c, 2_r)), 35) &&
+		r(0_c, 1_r) == 0 && r(0_c, 2_r) == 0 && r(1_c, 2_r) == 0
+	));
+
+	BOOST_TEST(near(q * r, m, 1e-10));
+	BOOST_TEST(near(transpose(q) * q, make_identity_matrix< double >(3_DS),
+		1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(test_qr_decomposition_least_squares){
+	// Line fit y = 2 + 3 * x with exact data
+	auto const a = make_matrix< double >(2_CD, 4_RD, {
+		{1, 0},
+		{1, 1},
+		{1, 2},
+		{1, 3}
+	});
+	auto const b = make_vector< double >(4_RD, {2, 5, 8, 11});
+
+	auto const qr = qr_decomposition(a);
+
+	BOOST_TEST(type_id_runtime(qr) ==
+		(type_id< qr_decomposition< double, 0_C, 0_R > >()));
+
+	auto const x = qr.solve(b);
+
+	BOOST_TEST((
+		x.cols() == 1_CS &&
+		x.rows() == 2_RD &&
+		equal(x[0_d], 2, 1e-12) &&
+		equal(x[1_d], 3, 1e-12)
+	));
+
+	// Residual of inconsistent data is orthogonal to the columns
+	auto const c = make_vector< double >(4_RD, {1, 0, 2, 1});
+	auto const y = qr.solve(c);
+	auto const residual = a * y - c;
+	auto const projection = transpose(a) * residual;
+	BOOST_TEST((
+		equal(projection[0_d], 0, 1e-12) &&
+		equal(projection[1_d], 0, 1e-12)
+	));
+}
+
+BOOST_AUTO_TEST_CASE(test_qr_decomposition_blocked){
+	// Several WY blocks, the last one partial
+	auto const a = make_matrix_fn(75_CD, 90_RD, [](c_t c, r_t r){
+		auto const x = double(size_t(c)), y = double(size_t(r));
+		return std::sin(x * 1.3 + y * 0.7) + (x == y ? 4.0 : 0.0);
+	});
+
+	auto const qr = qr_decomposition(a);
+
+	// Q^T * A == R without forming Q
+	BOOST_TEST(near(qr.apply_qt(a), qr.r(), 1e-10));
+
+	// Q * Q^T == I
+	auto const b = make_matrix_fn(3_CD, 90_RD, [](c_t c, r_t r){
+		return double(size_t(c) + 1) / double(size_t(r) + 1);
+	});
+	BOOST_TEST(near(qr.apply_q(qr.apply_qt(b)), b, 1e-12));
+
+	// Consistent system
+	auto const x = make_vector_fn(75_RD, [](size_t i){
+		return double(i % 7) - 3;
+	});
+	BOOST_TEST(near(qr.solve(a * x), x, 1e-9));
+}
+
+BOOST_AUTO_TEST_CASE(test_qr_decomposition_errors){
+	auto const wide = make_matrix_v< double >(3_CD, 2_RD, 1.0);
+	BOOST_CHECK_THROW(qr_decomposition{wide}, std::logic_error);
+
+	auto const m = make_matrix< double >(2_CD, 3_RD, {
+		{1, 0},
+		{2, 0},
+		{3, 0}
+	});
+	auto const qr = qr_decomposition(m);
+	BOOST_CHECK_THROW(qr.solve(make_vector_v< double >(3_RD, 1.0)),
+		std::logic_error);
+	BOOST_CHECK_THROW(qr.apply_qt(make_vector_v< double >(2_RD, 1.0)),
+		std::logic_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,191 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax structured_levenberg_marquardt
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/structured_levenberg_marquardt.hpp>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+
+using namespace mitrax;
+
+
+namespace{
+
+
+	constexpr std::size_t view_count = 4;
+	constexpr std::size_t point_count = 30;
+
+	constexpr double true_focal = 1.5;
+
+	/// \brief Rotation angle and translation of view v, view 0 is fixed
+	std::vector< double > true_view(std::size_t v){
+		auto const t = double(v);
+		return {0.1 * t, 0.5 * t, -0.2 * t};
+	}
+
+	std::vector< double > true_point(std::size_t i){
+		auto const t = double(i);
+		return {std::sin(t), std::cos(2 * t)};
+	}
+
+	/// \brief focal * R(view) * point + translation(view)
+	std::array< double, 2 > project(
+		double focal, double const* view, double const* point
+	){
+		auto const c = std::cos(view[0]);
+		auto const s = std::sin(view[0]);
+		return {
+			focal * (c * point[0] - s * point[1]) + view[1],
+			focal * (s * point[0] + c * point[1]) + view[2]};
+	}
+
+	/// \brief 2D bundle adjustment with a shared focal length, view poses
+	///        and points, the start values are disturbed
+	structured_problem< double > make_problem(bool eliminate){
+		structured_problem< double > problem;
+
+		auto const focal = problem.add_parameter_block({1.2});
+
+		std::vector< std::size_t > views;
+		for(std::size_t v = 1; v < view_count; ++v){
+			auto start = true_view(v);
+			start[0] += 0.05;
+			start[1] -= 0.1;
+			views.push_back(problem.add_parameter_block(start));
+		}
+
+		for(std::size_t i = 0; i < point_count; ++i){
+			auto start = true_point(i);
+			start[0] += 0.1 * std::cos(double(i));
+			start[1] -= 0.1;
+			auto const point = problem.add_parameter_block(start, eliminate);
+
+			// View 0 observes the points directly
+			auto const p = true_point(i);
+			problem.add_residual_block(2, {point},
+				[p](double const* const* x, double* r){
+					r[0] = x[0][0] - p[0];
+					r[1] = x[0][1] - p[1];
+				});
+
+			for(std::size_t v = 1; v < view_count; ++v){
+				auto const pose = true_view(v);
+				auto const o = project(true_focal, pose.data(), p.data());
+				problem.add_residual_block(2, {focal, views[v - 1], point},
+					[o](double const* const* x, double* r){
+						auto const q = project(x[0][0], x[1], x[2]);
+						r[0] = q[0] - o[0];
+						r[1] = q[1] - o[1];
+					});
+			}
+		}
+
+		return problem;
+	}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_structured_levenberg_marquardt)
+
+
+BOOST_AUTO_TEST_CASE(test_schur_complement){
+	auto schur = make_problem(true);
+	auto dense = make_problem(false);
+	BOOST_TEST(schur.block_count() == 1 + (view_count - 1) + point_count);
+	BOOST_TEST(schur.residual_count() == 2 * view_count * point_count);
+
+	std::size_t iterations = 0;
+	auto const state = structured_levenberg_marquardt(schur, 1e-12, 1.,
+		0.3, 0.9, nonlinear_options(),
+		[&iterations](nonlinear_iteration< double > const& s){
+			++iterations;
+			BOOST_TEST(s.iteration == iterations);
+		});
+	auto const dense_state = structured_levenberg_marquardt(
+		dense, 1e-12, 1., 0.3, 0.9);
+
+	BOOST_TEST(state.iteration == iterations);
+	BOOST_TEST(state.step_norm < 1e-6);
+
+	BOOST_TEST(std::abs(schur.parameters(0)[0] - true_focal) < 1e-8);
+	for(std::size_t v = 1; v < view_count; ++v){
+		auto const expected = true_view(v);
+		for(std::size_t k = 0; k < 3; ++k){
+			BOOST_TEST(std::abs(schur.parameters(v)[k] - expected[k]) < 1e-8);
+		}
+	}
+
+	for(std::size_t b = 0; b < schur.block_count(); ++b){
+		for(std::size_t k = 0; k < schur.block_size(b); ++k){
+			BOOST_TEST(std::abs(
+				schur.parameters(b)[k] - dense.parameters(b)[k]) < 1e-8);
+		}
+	}
+	BOOST_TEST(dense_state.step_norm < 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(test_options){
+	auto problem = make_problem(true);
+
+	nonlinear_options options;
+	options.max_iterations = 2;
+	auto const state = structured_levenberg_marquardt(
+		problem, 1e-12, 1., 0.3, 0.9, options);
+	BOOST_TEST(state.iteration == 2);
+	BOOST_TEST(state.mu > 0);
+	BOOST_TEST(state.cost > 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_singular){
+	// The eliminated block b has no residuals, so V = 0
+	structured_problem< double > problem;
+	auto const a = problem.add_parameter_block({3});
+	auto const b = problem.add_parameter_block({2}, true);
+	problem.add_residual_block(1, {a}, [](double const* const* x, double* r){
+			r[0] = x[0][0] - 1;
+		});
+
+	auto const state = structured_levenberg_marquardt(
+		problem, 1e-12, 0., 0.3, 0.9);
+	BOOST_TEST(state.step_norm < 1e-6);
+	BOOST_TEST(std::abs(problem.parameters(a)[0] - 1) < 1e-8);
+	BOOST_TEST(problem.parameters(b)[0] == 2);
+
+	// No step reduces the cost, the solver gives up
+	structured_problem< double > step;
+	auto const c = step.add_parameter_block({1});
+	step.add_residual_block(1, {c}, [](double const* const* x, double* r){
+			r[0] = x[0][0] < 1 ? 10 : x[0][0];
+		});
+	BOOST_CHECK_THROW(structured_levenberg_marquardt(
+		step, 1e-12, 0., 0.3, 0.9), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(test_errors){
+	structured_problem< double > problem;
+	auto const a = problem.add_parameter_block({1}, true);
+	auto const b = problem.add_parameter_block({1, 2}, true);
+	auto const f = [](double const* const*, double*){};
+
+	BOOST_CHECK_THROW(problem.add_parameter_block({}), std::logic_error);
+	BOOST_CHECK_THROW(problem.add_residual_block(1, {a, b}, f),
+		std::logic_error);
+	BOOST_CHECK_THROW(problem.add_residual_block(1, {a, 2}, f),
+		std::logic_error);
+	BOOST_CHECK_THROW(problem.parameters(2), std::out_of_range);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,183 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax symmetric_eigen
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/symmetric_eigen.hpp>
+#include <mitrax/operator.hpp>
+#include <mitrax/compare.hpp>
+
+#include <cmath>
+#include <mutex>
+#include <set>
+#include <thread>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+template < typename T, typename U >
+constexpr bool equal(T const& a, U const& b, double threshold = 0.00001){
+	return std::abs(a - b) < threshold;
+}
+
+template <
+	typename M1, col_t C1, row_t R1,
+	typename M2, col_t C2, row_t R2
+> bool near(
+	matrix< M1, C1, R1 > const& m1,
+	matrix< M2, C2, R2 > const& m2,
+	double threshold
+){
+	auto const size = get_dims(m1, m2);
+	for(auto r = 0_r; r < size.rows(); ++r){
+		for(auto c = 0_c; c < size.cols(); ++c){
+			if(!equal(m1(c, r), m2(c, r), threshold)) return false;
+		}
+	}
+	return true;
+}
+
+/// \brief A * V == V * diag(w), V^T * V == I and w ascending
+template <
+	typename MA, col_t CA, row_t RA,
+	typename MW, col_t CW, row_t RW,
+	typename MV, col_t CV, row_t RV
+> bool is_eigen_decomposition(
+	matrix< MA, CA, RA > const& a,
+	matrix< MW, CW, RW > const& w,
+	matrix< MV, CV, RV > const& v,
+	double threshold
+){
+	using value_type = value_type_t< MA >;
+	auto const av = a * v;
+	auto const vw = make_matrix_fn(v.dims(), [&v, &w](c_t c, r_t r){
+		return v(c, r) * w[d_t(size_t(c))];
+	});
+	auto const identity = make_identity_matrix< value_type >(
+		v.cols().as_dim());
+
+	bool ascending = true;
+	for(size_t i = 1; i < size_t(w.rows()); ++i){
+		ascending = ascending && w[d_t(i - 1)] <= w[d_t(i)];
+	}
+
+	return ascending && near(av, vw, threshold) &&
+		near(transpose(v) * v, identity, threshold);
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_symmetric_eigen)
+
+
+BOOST_AUTO_TEST_CASE(test_symmetric_eigen_3x3){
+	constexpr auto m = make_matrix< double >(3_DS, {
+		{2, 1, 0},
+		{1, 2, 0},
+		{0, 0, 5}
+	});
+
+	auto const [w, v] = symmetric_eigen(m);
+
+	BOOST_TEST(type_id_runtime(w) ==
+		(type_id< std_col_vector< double, 3_R > >()));
+	BOOST_TEST(type_id_runtime(v) ==
+		(type_id< std_square_matrix< double, 3_D > >()));
+
+	BOOST_TEST((
+		equal(w[0_d], 1, 1e-12) &&
+		equal(w[1_d], 3, 1e-12) &&
+		equal(w[2_d], 5, 1e-12)
+	));
+	BOOST_TEST(is_eigen_decomposition(m, w, v, 1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(test_symmetric_eigen_3x3_float){
+	constexpr auto m = make_matrix< float >(3_DS, {
+		{ 4, -2,  1},
+		{-2,  3, -1},
+		{ 1, -1,  6}
+	});
+
+	auto const [w, v] = symmetric_eigen(m);
+
+	BOOST_TEST(type_id_runtime(w) ==
+		(type_id< std_col_vector< float, 3_R > >()));
+	BOOST_TEST(is_eigen_decomposition(m, w, v, 1e-5));
+}
+
+BOOST_AUTO_TEST_CASE(test_symmetric_eigen_runtime){
+	// Runtime dimension uses the tridiagonal QL method
+	auto const m = make_matrix< double >(3_DD, {
+		{2, 1, 0},
+		{1, 2, 0},
+		{0, 0, 5}
+	});
+
+	auto const [w, v] = symmetric_eigen(m);
+
+	BOOST_TEST(type_id_runtime(w) ==
+		(type_id< std_col_vector< double, 0_R > >()));
+	BOOST_TEST((
+		equal(w[0_d], 1, 1e-12) &&
+		equal(w[1_d], 3, 1e-12) &&
+		equal(w[2_d], 5, 1e-12)
+	));
+	BOOST_TEST(is_eigen_decomposition(m, w, v, 1e-12));
+
+	// Repeated eigenvalues and a diagonal matrix
+	auto const diag = make_matrix_fn(7_DD, [](c_t c, r_t r){
+		return size_t(c) == size_t(r) ? double(size_t(c) % 3) : 0.0;
+	});
+	auto const [dw, dv] = symmetric_eigen(diag);
+	BOOST_TEST(is_eigen_decomposition(diag, dw, dv, 1e-12));
+
+	auto const tiny = make_matrix_v< double >(1_DD, 4.0);
+	auto const [tw, tv] = symmetric_eigen(tiny);
+	BOOST_TEST((tw[0_d] == 4 && tv(0_c, 0_r) == 1));
+}
+
+BOOST_AUTO_TEST_CASE(test_symmetric_eigen_parallel){
+	auto const m = make_matrix_fn(200_DD, [](c_t c, r_t r){
+		auto const i = double(std::min(size_t(c), size_t(r)));
+		auto const j = double(std::max(size_t(c), size_t(r)));
+		return std::sin(i * 12.9898 + j * 78.233) + (i == j ? 2.0 : 0.0);
+	});
+
+	auto const [w, v] = symmetric_eigen(m, symmetric_eigen_options{1});
+	BOOST_TEST(is_eigen_decomposition(m, w, v, 1e-10));
+
+	// Every element is calculated in the same order on any thread
+	auto const [pw, pv] = symmetric_eigen(m, symmetric_eigen_options{4});
+	BOOST_TEST((pw == w));
+	BOOST_TEST((pv == v));
+
+	// The 2 * n parallel rounds of the reduction reuse the pool threads
+	std::mutex mutex;
+	std::set< std::thread::id > ids;
+	for(size_t round = 0; round < 400; ++round){
+		detail::parallel_for(4, 4, [&](size_t){
+			std::lock_guard< std::mutex > lock(mutex);
+			ids.insert(std::this_thread::get_id());
+		});
+	}
+	BOOST_TEST(ids.size() <= 4);
+	BOOST_TEST(detail::thread_pool::instance().size() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_symmetric_eigen_errors){
+	auto const wide = make_matrix_v< double >(3_CD, 2_RD, 1.0);
+	BOOST_CHECK_THROW(symmetric_eigen(wide), std::logic_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
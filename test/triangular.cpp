@@ -0,0 +1,169 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2015-2018 Benjamin Buch
+//
+// https://github.com/bebuch/mitrax
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+//-----------------------------------------------------------------------------
+#define BOOST_TEST_MODULE mitrax triangular
+#include <boost/test/unit_test.hpp>
+
+#include <mitrax/triangular.hpp>
+#include <mitrax/gaussian_elimination.hpp>
+#include <mitrax/operator.hpp>
+#include <mitrax/matrix/heap_layout.hpp>
+#include <mitrax/matrix/view.hpp>
+
+#include <cmath>
+#include <vector>
+
+
+using boost::typeindex::type_id;
+using boost::typeindex::type_id_runtime;
+using namespace mitrax;
+using namespace mitrax::literals;
+
+
+template < typename T, typename U >
+constexpr bool equal(T const& a, U const& b, double threshold = 0.00001){
+	return std::abs(a - b) < threshold;
+}
+
+template <
+	typename M1, col_t C1, row_t R1,
+	typename M2, col_t C2, row_t R2
+> bool near(
+	matrix< M1, C1, R1 > const& m1,
+	matrix< M2, C2, R2 > const& m2,
+	double threshold
+){
+	auto const size = get_dims(m1, m2);
+	for(auto r = 0_r; r < size.rows(); ++r){
+		for(auto c = 0_c; c < size.cols(); ++c){
+			if(!equal(m1(c, r), m2(c, r), threshold)) return false;
+		}
+	}
+	return true;
+}
+
+
+/// \brief Triangle t of m with 1 on the diagonal for diag::unit and 0
+///        elsewhere
+template < typename M, col_t C, row_t R >
+auto triangle_of(matrix< M, C, R > const& m, triangle t, diag d){
+	return make_matrix_fn(m.dims(), [&m, t, d](c_t c, r_t r){
+		auto const x = size_t(c), y = size_t(r);
+		if(x == y) return d == diag::unit ? 1.0 : m(c, r);
+		return (t == triangle::lower) == (x < y) ? m(c, r) : 0.0;
+	});
+}
+
+
+BOOST_AUTO_TEST_SUITE(suite_triangular)
+
+
+BOOST_AUTO_TEST_CASE(test_triangular_solve_3x3){
+	constexpr auto a = make_matrix< double >(3_DS, {
+		{2, 9, 9},
+		{1, 4, 9},
+		{3, 2, 5}
+	});
+	constexpr auto b = make_vector< double >(3_RS, {2, 9, 17});
+
+	auto const x = triangular_solve(a, b, triangle::lower);
+
+	BOOST_TEST(type_id_runtime(x) ==
+		(type_id< std_col_vector< double, 3_R > >()));
+	BOOST_TEST((
+		equal(x[0_d], 1) &&
+		equal(x[1_d], 2) &&
+		equal(x[2_d], 2)
+	));
+
+	auto const y = triangular_solve(a, b, triangle::upper,
+		operation::transpose, diag::unit);
+	BOOST_TEST((
+		equal(y[0_d], 2) &&
+		equal(y[1_d], -9) &&
+		equal(y[2_d], 80)
+	));
+}
+
+BOOST_AUTO_TEST_CASE(test_triangular_solve_multiply){
+	// Larger than a block, diagonally dominant
+	auto const a = make_matrix_fn(dims(dim_t(150)), [](c_t c, r_t r){
+		auto const x = double(size_t(c)), y = double(size_t(r));
+		return x == y ? 4 + std::cos(x) : std::sin(x * 0.37 + y * 1.1) / 8;
+	});
+
+	for(auto p: {size_t(1), size_t(3), size_t(300)}){
+		auto const b = make_matrix_fn(cols(col_t(p)), rows(row_t(150)),
+			[](c_t c, r_t r){
+				return std::cos(double(size_t(c)) + 0.5 * double(size_t(r)));
+			});
+
+		for(auto t: {triangle::lower, triangle::upper}){
+			for(auto o: {operation::none, operation::transpose}){
+				for(auto d: {diag::non_unit, diag::unit}){
+					auto const ta = triangle_of(a, t, d);
+					auto const op = o == operation::none
+						? ta : transpose(ta);
+
+					auto const x = triangular_solve(a, b, t, o, d);
+					BOOST_TEST(near(op * x, b, 1e-10));
+
+					auto const y = triangular_multiply(a, b, t, o, d);
+					BOOST_TEST(near(y, op * b, 1e-10));
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_triangular_storage){
+	// A = {{2, 1}, {0, 4}} stored column by column
+	std::vector< double > values{2, 0, 1, 4};
+	auto const a = maker::const_view.by_object(2_CS, 2_RS, values,
+		memory_order::col_wise);
+	auto const b = make_vector< double >(2_RS, {3, 4});
+
+	auto const x = triangular_solve(a, b, triangle::upper);
+	BOOST_TEST((equal(x[0_d], 1) && equal(x[1_d], 1)));
+
+	auto copy = values;
+	auto const y = gaussian_elimination(maker::view.by_object(2_CS, 2_RS,
+		copy, memory_order::col_wise), b);
+	BOOST_TEST((equal(y[0_d], 1) && equal(y[1_d], 1)));
+
+	auto const fn = [](c_t c, r_t r){
+		auto const x = size_t(c), y = size_t(r);
+		return x == y ? 4.0 : x > y ? 1.0 : 0.0;
+	};
+	auto const c = make_matrix_fn(3_DD, fn, maker::col_major);
+	auto const m = make_matrix_fn(3_DD, fn, maker::morton);
+	auto const v = make_vector< double >(3_RS, {6, 5, 4});
+
+	auto const z = triangular_solve(c, v, triangle::upper);
+	BOOST_TEST((equal(z[0_d], 1) && equal(z[1_d], 1) && equal(z[2_d], 1)));
+	BOOST_TEST(near(triangular_multiply(m, z, triangle::upper), v, 1e-12));
+
+	auto const w = gaussian_elimination(c, v);
+	BOOST_TEST((equal(w[0_d], 1) && equal(w[1_d], 1) && equal(w[2_d], 1)));
+	BOOST_TEST(near(gaussian_elimination(m, v), w, 1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(test_triangular_errors){
+	auto const a = make_matrix_v< double >(2_CD, 3_RD, 1.0);
+	auto const b = make_vector_v< double >(3_RD, 1.0);
+	BOOST_CHECK_THROW(triangular_solve(a, b, triangle::lower),
+		std::logic_error);
+
+	auto const c = make_matrix_v< double >(3_DD, 1.0);
+	auto const v = make_vector_v< double >(2_RD, 1.0);
+	BOOST_CHECK_THROW(triangular_multiply(c, v, triangle::upper),
+		std::logic_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()